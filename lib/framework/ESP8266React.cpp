@@ -116,4 +116,5 @@ void ESP8266React::loop() {
 #if FT_ENABLED(FT_MQTT)
     _mqttSettingsService.loop();
 #endif
+    FSPersistenceBase::loopAll(); // pending settings writes
 }
@@ -4,22 +4,97 @@
 #include <StatefulService.h>
 #include <FS.h>
 
+#include <vector>
+
+// how long to wait after a change before writing the file, so a burst of updates is a single write
+#ifndef FS_PERSISTENCE_WRITE_DELAY
+#define FS_PERSISTENCE_WRITE_DELAY 2000
+#endif
+
+// FNV-1a hash of whatever is printed to it, so a file is only rewritten when its content changes
+class FSPersistenceHash : public Print {
+  public:
+    size_t write(uint8_t c) override {
+        _hash = (_hash ^ c) * 16777619u;
+        return 1;
+    }
+
+    size_t write(const uint8_t * buffer, size_t size) override {
+        for (size_t i = 0; i < size; i++) {
+            write(buffer[i]);
+        }
+        return size;
+    }
+
+    uint32_t hash() const {
+        return _hash;
+    }
+
+  private:
+    uint32_t _hash = 2166136261u;
+};
+
+// all FSPersistence instances, so pending writes can be done from the loop and before a restart
+class FSPersistenceBase {
+  public:
+    static void loopAll() {
+        for (FSPersistenceBase * persistence : instances()) {
+            persistence->loop();
+        }
+    }
+
+    static void flushAll() {
+        for (FSPersistenceBase * persistence : instances()) {
+            persistence->flush();
+        }
+    }
+
+    virtual void loop()  = 0;
+    virtual void flush() = 0;
+
+  protected:
+    FSPersistenceBase() {
+        instances().push_back(this);
+    }
+
+    virtual ~FSPersistenceBase() {
+        auto & list = instances();
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            if (*it == this) {
+                list.erase(it);
+                break;
+            }
+        }
+    }
+
+  private:
+    static std::vector<FSPersistenceBase *> & instances() {
+        static std::vector<FSPersistenceBase *> list;
+        return list;
+    }
+};
+
 template <class T>
-class FSPersistence {
+class FSPersistence : public FSPersistenceBase {
   public:
     FSPersistence(JsonStateReader<T>   stateReader,
                   JsonStateUpdater<T>  stateUpdater,
                   StatefulService<T> * statefulService,
                   FS *                 fs,
                   const char *         filePath,
-                  size_t               bufferSize = DEFAULT_BUFFER_SIZE)
+                  size_t               bufferSize = DEFAULT_BUFFER_SIZE,
+                  uint32_t             writeDelay = FS_PERSISTENCE_WRITE_DELAY)
         : _stateReader(stateReader)
         , _stateUpdater(stateUpdater)
         , _statefulService(statefulService)
         , _fs(fs)
         , _filePath(filePath)
         , _bufferSize(bufferSize)
-        , _updateHandlerId(0) {
+        , _updateHandlerId(0)
+        , _writeDelay(writeDelay)
+        , _dirty(false)
+        , _dirtySince(0)
+        , _fileHash(0) {
         enableUpdateHandler();
     }
 
@@ -42,6 +117,10 @@ class FSPersistence {
 
                 _statefulService->updateWithoutPropagation(jsonObject, _stateUpdater);
                 settingsFile.close();
+
+                FSPersistenceHash hash;
+                serializeJson(jsonDocument, hash);
+                _fileHash = hash.hash();
                 return;
             }
             settingsFile.close();
@@ -53,11 +132,20 @@ class FSPersistence {
     }
 
     bool writeToFS() {
+        _dirty = false;
+
         // create and populate a new json object
         DynamicJsonDocument jsonDocument = DynamicJsonDocument(_bufferSize);
         JsonObject          jsonObject   = jsonDocument.to<JsonObject>();
         _statefulService->read(jsonObject, _stateReader);
 
+        // skip the write if the file already has this content
+        FSPersistenceHash hash;
+        serializeJson(jsonDocument, hash);
+        if (_fileHash && (hash.hash() == _fileHash)) {
+            return true;
+        }
+
         // serialize it to filesystem
         File settingsFile = _fs->open(_filePath, "w");
 
@@ -73,12 +161,31 @@ class FSPersistence {
         Serial.println();
 #endif
 
-        // serialize the data to the file
+        // serialize the data to the file, compact
         serializeJson(jsonDocument, settingsFile);
         settingsFile.close();
+        _fileHash = hash.hash();
         return true;
     }
 
+    // write a pending change once it's been quiet for the write delay
+    void loop() override {
+        if (_dirty && ((uint32_t)(millis() - _dirtySince) >= _writeDelay)) {
+            writeToFS();
+        }
+    }
+
+    // write a pending change now, e.g. before a restart
+    void flush() override {
+        if (_dirty) {
+            writeToFS();
+        }
+    }
+
+    void setWriteDelay(uint32_t writeDelay) {
+        _writeDelay = writeDelay;
+    }
+
     void disableUpdateHandler() {
         if (_updateHandlerId) {
             _statefulService->removeUpdateHandler(_updateHandlerId);
@@ -88,7 +195,7 @@ class FSPersistence {
 
     void enableUpdateHandler() {
         if (!_updateHandlerId) {
-            _updateHandlerId = _statefulService->addUpdateHandler([&](const String & originId) { writeToFS(); });
+            _updateHandlerId = _statefulService->addUpdateHandler([&](const String & originId) { markDirty(); });
         }
     }
 
@@ -100,6 +207,19 @@ class FSPersistence {
     const char *         _filePath;
     size_t               _bufferSize;
     update_handler_id_t  _updateHandlerId;
+    uint32_t             _writeDelay; // ms, 0 writes on every update
+    bool                 _dirty;      // there is a change not written yet
+    uint32_t             _dirtySince; // millis() of the last change
+    uint32_t             _fileHash;   // hash of the content of the file, 0 if unknown
+
+    void markDirty() {
+        if (_writeDelay == 0) {
+            writeToFS();
+            return;
+        }
+        _dirty      = true;
+        _dirtySince = millis();
+    }
 
   protected:
     // We assume the updater supplies sensible defaults if an empty object
@@ -1,4 +1,5 @@
 #include <RestartService.h>
+#include <FSPersistence.h>
 
 RestartService::RestartService(AsyncWebServer * server, SecurityManager * securityManager) {
     server->on(RESTART_SERVICE_PATH,
@@ -7,6 +8,7 @@ RestartService::RestartService(AsyncWebServer * server, SecurityManager * securi
 }
 
 void RestartService::restart(AsyncWebServerRequest * request) {
+    FSPersistenceBase::flushAll();
     request->onDisconnect(RestartService::restartNow);
     request->send(200);
 }
@@ -65,14 +65,19 @@ void Shell::maximum_log_messages(size_t count) {
     }
 }
 
+void Shell::output_ready(std::function<bool()> function) {
+    output_ready_ = std::move(function);
+}
+
 void Shell::output_logs() {
-    if (!log_messages_.empty()) {
+    if (!log_messages_.empty() && (!output_ready_ || output_ready_())) {
         if (mode_ != Mode::DELAY) {
             erase_current_line();
             prompt_displayed_ = false;
         }
 
-        while (!log_messages_.empty()) {
+        // the rest stay queued while the output is full
+        while (!log_messages_.empty() && (!output_ready_ || output_ready_())) {
             auto message = std::move(log_messages_.front());
             log_messages_.pop_front();
 
@@ -242,6 +242,19 @@ class Shell : public std::enable_shared_from_this<Shell>, public uuid::log::Hand
 	 * @since 0.7.0
 	 */
     void idle_timeout(unsigned long timeout);
+    /**
+	 * Set a check for room in the output.
+	 *
+	 * Queued log messages are only output while the check says there
+	 * is room for another one. They wait in the queue until there is,
+	 * instead of the output waiting for a slow connection.
+	 *
+	 * @param[in] function Function that returns true if there is room
+	 *                     for a log message, or nullptr (the default)
+	 *                     if there always is.
+	 * @since 0.7.4
+	 */
+    void output_ready(std::function<bool()> function);
 
     /**
 	 * Get the context at the top of the stack.
@@ -915,6 +928,7 @@ class Shell : public std::enable_shared_from_this<Shell>, public uuid::log::Hand
     bool prompt_displayed_ = false; /*!< Indicates that a command prompt has been displayed, so that the output of invoke_command() is correct. @since 0.1.0 */
     uint64_t idle_time_    = 0;     /*!< Time the shell became idle. @since 0.7.0 */
     uint64_t idle_timeout_ = 0;     /*!< Idle timeout (in milliseconds). @since 0.7.0 */
+    std::function<bool()> output_ready_; /*!< Check for room in the output for log messages. @since 0.7.4 */
 };
 
 /**
@@ -24,13 +24,20 @@
 #include <string>
 #include <vector>
 
+#ifndef UUID_TELNET_HAVE_WIFICLIENT_AVAILABLE_FOR_WRITE
+#if defined(ARDUINO_ARCH_ESP8266)
+#define UUID_TELNET_HAVE_WIFICLIENT_AVAILABLE_FOR_WRITE 1
+#else
+#define UUID_TELNET_HAVE_WIFICLIENT_AVAILABLE_FOR_WRITE 0
+#endif
+#endif
+
 namespace uuid {
 
 namespace telnet {
 
 TelnetStream::TelnetStream(WiFiClient &client)
 		: client_(client) {
-	output_buffer_.reserve(BUFFER_SIZE);
 }
 
 void TelnetStream::start() {
@@ -232,53 +239,68 @@ int TelnetStream::peek() {
 }
 
 size_t TelnetStream::write(uint8_t data) {
-	if (previous_out_ == CR && data != LF) {
-		previous_out_ = data;
+	return write(&data, 1);
+}
 
-		if (raw_write({NUL, data}) != 2) {
-			return 0;
-		}
-	} else {
-		previous_out_ = data;
-	}
+size_t TelnetStream::write(const uint8_t *buffer, size_t size) {
+	size_t offset = 0;
 
-	if (data == IAC) {
-		if (raw_write({IAC, IAC}) != 2) {
-			return 0;
-		}
-	} else {
-		if (raw_write(data) != 1) {
-			return 0;
+	while (offset < size) {
+		// Output the characters that don't need escaping in one block
+		unsigned char previous = previous_out_;
+		size_t block = 0;
+
+		while (offset + block < size) {
+			unsigned char c = buffer[offset + block];
+
+			if (c == IAC || (previous == CR && c != LF)) {
+				break;
+			}
+
+			previous = c;
+			block++;
 		}
-	}
 
-	return 1;
-}
+		if (block > 0) {
+			if (raw_write(buffer + offset, block) != block) {
+				return offset;
+			}
 
-size_t TelnetStream::write(const uint8_t *buffer, size_t size) {
-	std::vector<unsigned char> data;
-	data.reserve(size);
+			previous_out_ = previous;
+			offset += block;
+			continue;
+		}
 
-	while (size-- > 0) {
-		unsigned char c = *buffer++;
+		// Escape the next one
+		unsigned char c = buffer[offset];
+		unsigned char escaped[3];
+		size_t len = 0;
 
 		if (previous_out_ == CR && c != LF) {
-			data.push_back((unsigned char)NUL);
+			escaped[len++] = NUL;
 		}
 
 		if (c == IAC) {
-			data.push_back((unsigned char)IAC);
+			escaped[len++] = IAC;
+		}
+
+		escaped[len++] = c;
+
+		if (raw_write(escaped, len) != len) {
+			return offset;
 		}
 
 		previous_out_ = c;
-		data.push_back(c);
+		offset++;
 	}
 
-	size_t len = raw_write(data);
-	if (len < size) {
-		len = 0;
-	}
-	return len;
+	return size;
+}
+
+bool TelnetStream::output_ready() {
+	buffer_flush();
+
+	return output_length_ <= BUFFER_SIZE / 2;
 }
 
 void TelnetStream::flush() {
@@ -296,25 +318,40 @@ int TelnetStream::raw_read() {
 	return client_.read();
 }
 
-void TelnetStream::buffer_flush() {
-	if (!output_buffer_.empty()) {
-		size_t len = client_.write(reinterpret_cast<const unsigned char*>(output_buffer_.data()), output_buffer_.size());
-		if (len != output_buffer_.size()) {
+void TelnetStream::buffer_flush(bool wait) {
+	while (output_length_ > 0) {
+		// Up to the end of the ring
+		size_t block = std::min(output_length_, BUFFER_SIZE - output_start_);
+
+#if UUID_TELNET_HAVE_WIFICLIENT_AVAILABLE_FOR_WRITE
+		if (!wait) {
+			// The rest stays in the buffer until the socket has room for it
+			block = std::min(block, (size_t)client_.availableForWrite());
+			if (block == 0) {
+				return;
+			}
+		}
+#else
+		(void)wait;
+#endif
+
+		size_t len = client_.write(reinterpret_cast<const unsigned char*>(&output_buffer_[output_start_]), block);
+		if (len != block) {
 			client_.stop();
+			output_start_ = 0;
+			output_length_ = 0;
+			return;
 		}
-		output_buffer_.clear();
-		output_buffer_.shrink_to_fit();
+
+		output_start_ = (output_start_ + len) % BUFFER_SIZE;
+		output_length_ -= len;
 	}
+
+	output_start_ = 0;
 }
 
 size_t TelnetStream::raw_write(unsigned char data) {
-	output_buffer_.push_back(data);
-
-	if (output_buffer_.size() >= BUFFER_SIZE) {
-		buffer_flush();
-	}
-
-	return 1;
+	return raw_write(&data, 1);
 }
 
 size_t TelnetStream::raw_write(const std::vector<unsigned char> &data) {
@@ -323,31 +360,26 @@ size_t TelnetStream::raw_write(const std::vector<unsigned char> &data) {
 
 size_t TelnetStream::raw_write(const uint8_t *buffer, size_t size) {
 	size_t offset = 0;
-	size_t remaining = size;
-
-	if (!output_buffer_.empty()) {
-		// Fill the rest of the buffer
-		size_t block = std::min(remaining, BUFFER_SIZE - output_buffer_.size());
-
-		output_buffer_.insert(output_buffer_.end(), buffer, buffer + block);
-		offset += block;
-		remaining -= block;
 
-		if (output_buffer_.size() >= BUFFER_SIZE) {
+	while (offset < size) {
+		if (output_length_ == BUFFER_SIZE) {
+			// Send a full segment, wait for the client if the socket has no room
 			buffer_flush();
+			if (output_length_ == BUFFER_SIZE) {
+				buffer_flush(true);
+			}
+			if (!client_.connected()) {
+				return offset;
+			}
 		}
-	}
 
-	if (remaining >= BUFFER_SIZE) {
-		// Output directly if it won't fit in the buffer
-		size_t len = client_.write(buffer + offset, remaining);
-		if (len != remaining) {
-			client_.stop();
-			return offset + len;
-		}
-	} else if (remaining > 0) {
-		// Put the rest in the buffer
-		output_buffer_.insert(output_buffer_.end(), buffer + offset, buffer + offset + remaining);
+		// Copy up to the end of the ring or the oldest data
+		size_t end = (output_start_ + output_length_) % BUFFER_SIZE;
+		size_t block = std::min(size - offset, std::min(BUFFER_SIZE - output_length_, BUFFER_SIZE - end));
+
+		memcpy(&output_buffer_[end], buffer + offset, block);
+		output_length_ += block;
+		offset += block;
 	}
 
 	return size;
@@ -199,6 +199,8 @@ TelnetService::Connection::Connection(shell_factory_function & shell_factory, Wi
     if (client_.connected()) {
         std::shared_ptr<uuid::console::Shell> shell = shell_factory(stream_, addr_, port_);
         shell->idle_timeout(idle_timeout);
+        // log messages wait in the shell's queue while the client is slow
+        shell->output_ready([this] { return stream_.output_ready(); });
         shell->start();
         shell_ = shell;
     } else {
@@ -49,6 +49,10 @@ namespace telnet {
  * Stream wrapper that performs telnet protocol handling, option
  * negotiation and output buffering.
  *
+ * The output is buffered in a fixed size ring that is sent as the
+ * socket has room for it, so that a slow client doesn't hold up the
+ * loop. Use output_ready() to hold back output until there is room.
+ *
  * @since 0.1.0
  */
 class TelnetStream: public ::Stream {
@@ -94,7 +98,8 @@ public:
 	/**
 	 * Write one byte to the output stream.
 	 *
-	 * Disconnect the client if the socket buffer is full.
+	 * Wait for the client if the output buffer is full and disconnect
+	 * it if that times out.
 	 *
 	 * @param[in] data Data to be output.
 	 * @return The number of bytes that were output.
@@ -104,7 +109,8 @@ public:
 	/**
 	 * Write an array of bytes to the output stream.
 	 *
-	 * Disconnect the client if the socket buffer is full.
+	 * Wait for the client if the output buffer is full and disconnect
+	 * it if that times out.
 	 *
 	 * @param[in] buffer Buffer to be output.
 	 * @param[in] size Length of the buffer.
@@ -112,6 +118,14 @@ public:
 	 * @since 0.1.0
 	 */
 	size_t write(const uint8_t *buffer, size_t size) override;
+	/**
+	 * Check for room in the output buffer, after sending what the
+	 * socket has room for.
+	 *
+	 * @return True if at least half of the output buffer is free.
+	 * @since 0.1.1
+	 */
+	bool output_ready();
 	/**
 	 * Does nothing.
 	 *
@@ -154,7 +168,7 @@ private:
 	static constexpr const unsigned char OPT_ECHO = 1; /*!< Remote Echo (RFC 857). @since 0.1.0 */
 	static constexpr const unsigned char OPT_SGA = 3; /*!< Suppress Go Ahead (RFC 858). @since 0.1.0 */
 
-	static constexpr const size_t BUFFER_SIZE = 536; /*!< Output buffer size. @since 0.1.0 */
+	static constexpr const size_t BUFFER_SIZE = 536; /*!< Output buffer size, a TCP segment. @since 0.1.0 */
 
 	TelnetStream(const TelnetStream&) = delete;
 	TelnetStream& operator=(const TelnetStream&) = delete;
@@ -176,15 +190,17 @@ private:
 	/**
 	 * Flush output stream buffer.
 	 *
-	 * Disconnect the client if the socket buffer is full.
+	 * Only send what the socket has room for, unless told to wait.
+	 * Disconnect the client if a write times out.
 	 *
+	 * @param[in] wait Send all of it, waiting for the client.
 	 * @since 0.1.0
 	 */
-	void buffer_flush();
+	void buffer_flush(bool wait = false);
 	/**
 	 * Write one byte directly to the output stream.
 	 *
-	 * Disconnect the client if the socket buffer is full.
+	 * Wait for the client if the output buffer is full.
 	 *
 	 * @param[in] data Data to be output.
 	 * @return The number of bytes that were output.
@@ -194,7 +210,7 @@ private:
 	/**
 	 * Write a vector of bytes directly to the output stream.
 	 *
-	 * Disconnect the client if the socket buffer is full.
+	 * Wait for the client if the output buffer is full.
 	 *
 	 * @param[in] data Data to be output.
 	 * @return The number of bytes that were output.
@@ -204,7 +220,7 @@ private:
 	/**
 	 * Write an array of bytes directly to the output stream.
 	 *
-	 * Disconnect the client if the socket buffer is full.
+	 * Wait for the client if the output buffer is full.
 	 *
 	 * @param[in] buffer Buffer to be output.
 	 * @param[in] size Length of the buffer.
@@ -219,7 +235,9 @@ private:
 	unsigned char previous_in_ = 0; /*!< Previous character that was received. Used to detect CR NUL. @since 0.1.0 */
 	unsigned char previous_out_ = 0; /*!< Previous character that was sent. Used to insert NUL after CR without LF. @since 0.1.0 */
 	int peek_ = -1; /*!< Previously read data cached by peek(). @since 0.1.0 */
-	std::vector<char> output_buffer_; /*!< Buffer data to be output until a read function is called. @since 0.1.0 */
+	char output_buffer_[BUFFER_SIZE]; /*!< Ring of data to be output, until the socket has room for it. @since 0.1.0 */
+	size_t output_start_ = 0; /*!< Position of the oldest data in the output buffer. @since 0.1.1 */
+	size_t output_length_ = 0; /*!< Length of the data in the output buffer. @since 0.1.1 */
 };
 
 /**
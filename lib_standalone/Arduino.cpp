@@ -17,10 +17,13 @@
 
 #include <Arduino.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
 
 #include <string>
 
+#include "emsuart_standalone.h"
+
 NativeConsole Serial;
 
 /* millis() on C++ native could be
@@ -41,6 +44,12 @@ int main(int argc __attribute__((unused)), char * argv[] __attribute__((unused))
     memset(__output_level, 0, sizeof(__output_level));
 
     setup();
+
+    // on a real bus, in real time
+    if (getenv("EMSESP_UART")) {
+        return emsesp::EMSuart::run(loop);
+    }
+
     loop(); // run once
 
     static unsigned long __cycles = 0;
@@ -56,6 +65,15 @@ unsigned long millis() {
     return __millis;
 }
 
+unsigned long micros() {
+    return __millis * 1000;
+}
+
+// moves the clock on, for simulations that run faster than real time
+void set_millis(unsigned long millis) {
+    __millis = millis;
+}
+
 void delay(unsigned long millis) {
     // __millis += millis;
 }
@@ -196,6 +196,8 @@ class NativeConsole : public Stream {
 extern NativeConsole Serial;
 
 unsigned long millis();
+unsigned long micros();
+void          set_millis(unsigned long millis);
 
 void delay(unsigned long millis);
 
@@ -68,6 +68,8 @@ class AsyncJsonResponse {
         return 0;
     }
 
+    void addHeader(const String & name, const String & value){};
+
     size_t getSize() {
         return _jsonBuffer.size();
     }
@@ -7,6 +7,7 @@
 #include <AsyncMqttClient.h>
 #include <ESPAsyncWebServer.h>
 #include <FS.h>
+#include <FSPersistence.h>
 #include <SecurityManager.h>
 #include <SecuritySettingsService.h>
 #include <StatefulService.h>
@@ -77,7 +78,9 @@ class ESP8266React {
         , _securitySettingsService(server, fs){};
 
     void begin(){};
-    void loop(){};
+    void loop() {
+        FSPersistenceBase::loopAll();
+    };
 
     SecurityManager * getSecurityManager() {
         return &_securitySettingsService;
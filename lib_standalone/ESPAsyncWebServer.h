@@ -3,7 +3,10 @@
 
 #include "Arduino.h"
 
+#include <algorithm>
 #include <functional>
+#include <string>
+#include <vector>
 #include <AsyncTCP.h>
 #include <ArduinoJson.h>
 
@@ -11,6 +14,7 @@ class AsyncWebServer;
 class AsyncWebServerRequest;
 class AsyncWebServerResponse;
 class AsyncJsonResponse;
+class AsyncResponseStream;
 
 class AsyncWebParameter {
   private:
@@ -45,6 +49,24 @@ class AsyncWebParameter {
     }
 };
 
+class AsyncWebHeader {
+  private:
+    String _name;
+    String _value;
+
+  public:
+    AsyncWebHeader(const String & name, const String & value)
+        : _name(name)
+        , _value(value) {
+    }
+    const String & name() const {
+        return _name;
+    }
+    const String & value() const {
+        return _value;
+    }
+};
+
 typedef enum {
     HTTP_GET     = 0b00000001,
     HTTP_POST    = 0b00000010,
@@ -59,6 +81,8 @@ typedef enum {
 typedef uint8_t                   WebRequestMethodComposite;
 typedef std::function<void(void)> ArDisconnectHandler;
 
+typedef std::function<size_t(uint8_t *, size_t, size_t)> AwsResponseFiller;
+
 class AsyncWebServerRequest {
     friend class AsyncWebServer;
     friend class AsyncCallbackWebHandler;
@@ -84,6 +108,14 @@ class AsyncWebServerRequest {
 
     void addInterestingHeader(const String & name){};
 
+    bool hasHeader(const String & name) const {
+        return false;
+    }
+
+    AsyncWebHeader * getHeader(const String & name) const {
+        return nullptr;
+    }
+
     void send(AsyncWebServerResponse * response){};
     void send(AsyncJsonResponse * response){};
     void send(int code, const String & contentType = String(), const String & content = String()){};
@@ -125,6 +157,14 @@ class AsyncWebServerRequest {
         return nullptr;
     }
 
+    AsyncResponseStream * beginResponseStream(const String & contentType, size_t bufferSize = 1460) {
+        return nullptr;
+    }
+
+    AsyncWebServerResponse * beginChunkedResponse(const String & contentType, AwsResponseFiller callback) {
+        return nullptr;
+    }
+
     size_t headers() const; // get header count
     size_t params() const;  // get arguments count
 };
@@ -172,6 +212,19 @@ class AsyncWebServerResponse {
   public:
     AsyncWebServerResponse();
     virtual ~AsyncWebServerResponse();
+
+    void addHeader(const String & name, const String & value){};
+    void setContentType(const String & type){};
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+  public:
+    size_t write(uint8_t c) {
+        return 1;
+    }
+    size_t write(const uint8_t * buffer, size_t size) {
+        return size;
+    }
 };
 
 typedef std::function<void(AsyncWebServerRequest * request)> ArRequestHandlerFunction;
@@ -198,5 +251,114 @@ class AsyncWebServer {
     void on(const char * uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest){};
 };
 
+typedef enum { WS_CONTINUATION, WS_TEXT, WS_BINARY, WS_DISCONNECT = 0x08, WS_PING, WS_PONG } AwsFrameType;
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+
+typedef struct {
+    uint8_t  message_opcode;
+    uint32_t num;
+    uint8_t  final;
+    uint8_t  masked;
+    uint8_t  opcode;
+    uint64_t len;
+    uint8_t  mask[4];
+    uint64_t index;
+} AwsFrameInfo;
+
+class AsyncWebSocket;
+
+class AsyncWebSocketClient {
+  public:
+    AsyncWebSocketClient(uint32_t id = 0)
+        : _id(id){};
+
+    uint32_t id() {
+        return _id;
+    }
+    void text(const char * message, size_t len) {
+        sent.emplace_back(message, len);
+    };
+    void binary(const char * message, size_t len) {
+        sent.emplace_back(message, len);
+    };
+
+    std::vector<std::string> sent; // what went to the client, for the tests
+
+  private:
+    uint32_t _id;
+};
+
+typedef std::function<void(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t * data, size_t len)> AwsEventHandler;
+
+class AsyncWebSocket : public AsyncWebHandler {
+  public:
+    AsyncWebSocket(const String & url)
+        : _url(url.c_str()) {
+        sockets().push_back(this);
+    };
+    ~AsyncWebSocket() {
+        sockets().erase(std::remove(sockets().begin(), sockets().end(), this), sockets().end());
+    };
+
+    void setFilter(ArRequestFilterFunction fn){};
+    void onEvent(AwsEventHandler handler) {
+        _handler = handler;
+    };
+    void cleanupClients(uint16_t maxClients = 8){};
+    void text(uint32_t id, const char * message, size_t len) {
+        if (AsyncWebSocketClient * c = client(id)) {
+            c->text(message, len);
+        }
+    };
+    void binary(uint32_t id, const char * message, size_t len) {
+        if (AsyncWebSocketClient * c = client(id)) {
+            c->binary(message, len);
+        }
+    };
+
+    AsyncWebSocketClient * client(uint32_t id) {
+        for (auto c : _clients) {
+            if (c->id() == id) {
+                return c;
+            }
+        }
+        return nullptr;
+    }
+
+    size_t count() const {
+        return _clients.size();
+    }
+
+    // for the tests, the events the web server would raise. Clients are only added, a disconnected one stays known
+    static AsyncWebSocket * find(const char * url) {
+        for (auto socket : sockets()) {
+            if (socket->_url == url) {
+                return socket;
+            }
+        }
+        return nullptr;
+    }
+    void connect(AsyncWebSocketClient * client) {
+        _clients.push_back(client);
+        _handler(this, client, WS_EVT_CONNECT, nullptr, nullptr, 0);
+    }
+    void message(AsyncWebSocketClient * client, const char * text) {
+        AwsFrameInfo info = {WS_TEXT, 0, 1, 0, WS_TEXT, strlen(text), {0}, 0};
+        _handler(this, client, WS_EVT_DATA, &info, (uint8_t *)text, strlen(text));
+    }
+    void disconnect(AsyncWebSocketClient * client) {
+        _handler(this, client, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+    }
+
+  private:
+    static std::vector<AsyncWebSocket *> & sockets() {
+        static std::vector<AsyncWebSocket *> sockets;
+        return sockets;
+    }
+
+    std::string                         _url;
+    AwsEventHandler                     _handler;
+    std::vector<AsyncWebSocketClient *> _clients;
+};
 
 #endif
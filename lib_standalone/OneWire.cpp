@@ -0,0 +1,114 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "OneWire.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+uint32_t OneWire::searches_ = 0;
+uint32_t OneWire::selects_  = 0;
+
+std::vector<OneWire::Device> & OneWire::devices() {
+    static std::vector<Device> devices;
+    return devices;
+}
+
+OneWire::Device & OneWire::add(const uint8_t family, const uint32_t serial, const int16_t raw) {
+    Device device = {{family, (uint8_t)serial, (uint8_t)(serial >> 8), (uint8_t)(serial >> 16), (uint8_t)(serial >> 24), 0, 0, 0}, raw, true};
+    device.rom[7] = crc8(device.rom, 7);
+    devices().push_back(device);
+    return devices().back();
+}
+
+// the presence pulse, if there's anyone on the bus
+uint8_t OneWire::reset() {
+    selected_ = SELECTED_NONE;
+    for (const auto & device : devices()) {
+        if (device.present) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void OneWire::select(const uint8_t rom[8]) {
+    selects_++;
+    selected_ = SELECTED_NONE;
+    for (uint8_t i = 0; i < devices().size(); i++) {
+        if (devices()[i].present && (memcmp(devices()[i].rom, rom, 8) == 0)) {
+            selected_ = i;
+        }
+    }
+}
+
+void OneWire::skip() {
+    selected_ = SELECTED_ALL;
+}
+
+// a read of the scratchpad of a DS18B20 at 12 bits, a convert has nothing to do
+void OneWire::write(uint8_t v, uint8_t power) {
+    memset(scratchpad_, 0xFF, sizeof(scratchpad_)); // nobody answers
+    if ((v == 0xBE) && (selected_ >= 0)) {
+        const Device & device = devices()[selected_];
+        uint8_t        data[] = {(uint8_t)device.raw, (uint8_t)(device.raw >> 8), 0x4B, 0x46, 0x7F, 0xFF, 0x01, 0x10};
+        memcpy(scratchpad_, data, sizeof(data));
+        scratchpad_[8] = crc8(scratchpad_, 8);
+    }
+}
+
+void OneWire::read_bytes(uint8_t * buf, uint16_t count) {
+    memcpy(buf, scratchpad_, std::min(count, (uint16_t)sizeof(scratchpad_)));
+}
+
+void OneWire::reset_search() {
+    searches_++;
+    search_ = 0;
+}
+
+// the devices that are present, in the order they were added
+bool OneWire::search(uint8_t * newAddr, bool search_mode) {
+    while (search_ < devices().size()) {
+        const Device & device = devices()[search_++];
+        if (device.present) {
+            memcpy(newAddr, device.rom, 8);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Compute a Dallas Semiconductor 8 bit CRC directly
+uint8_t OneWire::crc8(const uint8_t * addr, uint8_t len) {
+    uint8_t crc = 0;
+
+    while (len--) {
+        uint8_t inbyte = *addr++;
+        for (uint8_t i = 8; i; i--) {
+            uint8_t mix = (crc ^ inbyte) & 0x01;
+            crc >>= 1;
+            if (mix)
+                crc ^= 0x8C;
+            inbyte >>= 1;
+        }
+    }
+    return crc;
+}
+
+#pragma GCC diagnostic pop
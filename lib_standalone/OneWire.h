@@ -0,0 +1,81 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OneWire_h
+#define OneWire_h
+
+#include <Arduino.h>
+
+#include <vector>
+
+// a simulated 1-Wire bus for the standalone build, with the calls of the OneWire library that are used.
+// The tests put sensors on it, a sensor answers a search and a MATCH ROM (select) while it's present
+class OneWire {
+  public:
+    struct Device {
+        uint8_t rom[8];
+        int16_t raw; // the temperature in 1/16 degrees, as it is in the scratchpad
+        bool    present;
+    };
+
+    void begin(uint8_t) {
+    }
+
+    uint8_t reset();
+    void    select(const uint8_t rom[8]);
+    void    skip();
+    void    write(uint8_t v, uint8_t power = 0);
+    void    read_bytes(uint8_t * buf, uint16_t count);
+    void    reset_search();
+    bool    search(uint8_t * newAddr, bool search_mode = true);
+
+    uint8_t read_bit() {
+        return 1; // the conversion is done
+    }
+
+    void depower() {
+    }
+
+    static uint8_t crc8(const uint8_t * addr, uint8_t len);
+
+    // adds a sensor with the family code and serial, the ROM gets its CRC
+    static Device &              add(const uint8_t family, const uint32_t serial, const int16_t raw);
+    static std::vector<Device> & devices();
+
+    // the searches and selects so far
+    static uint32_t searches() {
+        return searches_;
+    }
+    static uint32_t selects() {
+        return selects_;
+    }
+
+  private:
+    static constexpr int8_t SELECTED_NONE = -1;
+    static constexpr int8_t SELECTED_ALL  = -2;
+
+    int8_t  selected_ = SELECTED_NONE;
+    uint8_t search_   = 0; // the next device a search finds
+    uint8_t scratchpad_[9];
+
+    static uint32_t searches_;
+    static uint32_t selects_;
+};
+
+#endif
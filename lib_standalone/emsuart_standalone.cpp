@@ -18,28 +18,493 @@
 
 #include "emsuart_standalone.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include "emsesp.h"
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
 namespace emsesp {
 
+uuid::log::Logger EMSuart::logger_{F_(uart), uuid::log::Facility::DAEMON};
+
+EMSuart::tx_handler_t EMSuart::tx_handler_ = nullptr;
+int                   EMSuart::fd_         = -1;
+int                   EMSuart::pty_fd_     = -1;
+int                   EMSuart::epoll_fd_   = -1;
+EMSuart::Kind         EMSuart::kind_       = EMSuart::Kind::NONE;
+bool                  EMSuart::brk_zero_   = false;
+std::string           EMSuart::device_;
+struct addrinfo *     EMSuart::addresses_ = nullptr;
+uint32_t              EMSuart::last_open_ = 0;
+bool                  EMSuart::pipeline_  = false;
+std::thread           EMSuart::bus_thread_;
+int                   EMSuart::wake_fd_ = -1;
+std::atomic<bool>     EMSuart::bus_lost_{false};
+std::atomic<bool>     EMSuart::bus_stop_{false};
+std::atomic<bool>     EMSuart::stopped_{false};
+std::atomic<bool>     EMSuart::rx_restart_{false};
+std::mutex            EMSuart::tx_mutex_;
+uint8_t               EMSuart::rx_buf_[EMS_MAXBUFFERSIZE];
+uint8_t               EMSuart::rx_length_    = 0;
+uint8_t               EMSuart::rx_mark_      = 0;
+bool                  EMSuart::rx_error_     = false;
+uint64_t              EMSuart::rx_time_      = 0;
+bool                  EMSuart::rx_delivered_ = false;
+
+static volatile sig_atomic_t interrupted_ = 0;
+
+static uint64_t now_us() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 /*
  * init UART0 driver
+ * opens the device in EMSESP_UART, if there is one
  */
 void EMSuart::start(uint8_t tx_mode, uint8_t rx_gpio, uint8_t tx_gpio) {
+    if (fd_ < 0) {
+        open_device();
+    }
+    restart();
 }
 
 /*
  * stop UART0 driver
  * This is called prior to an OTA upload and also before a save to SPIFFS to prevent conflicts
+ * the device stays open, what comes in is dropped until the restart
  */
 void EMSuart::stop() {
+    stopped_ = true;
 }
 
 /*
  * re-start UART0 driver
+ * the telegram that was coming in is dropped, it's likely not complete
  */
 void EMSuart::restart() {
+    rx_restart_ = true;
+    stopped_    = false;
+}
+
+bool EMSuart::open_device() {
+    const char * name = getenv("EMSESP_UART");
+    if ((name == nullptr) || (*name == '\0')) {
+        kind_ = Kind::NONE;
+        return false;
+    }
+
+    last_open_ = millis();
+    device_    = name;
+    int fd     = -1;
+
+    if (device_ == "pty") {
+        // a new pty, its name is logged for the simulator or a bridge like socat
+        kind_ = Kind::PTY;
+        fd    = posix_openpt(O_RDWR | O_NOCTTY);
+        if ((fd >= 0) && ((grantpt(fd) < 0) || (unlockpt(fd) < 0))) {
+            close(fd);
+            fd = -1;
+        }
+        if (fd >= 0) {
+            device_ = ptsname(fd);
+            pty_fd_ = open(device_.c_str(), O_RDWR | O_NOCTTY);
+        }
+    } else if (device_.compare(0, 4, "tcp:") == 0) {
+        // a TCP serial bridge, tcp:host:port
+        kind_                 = Kind::TCP;
+        brk_zero_             = (getenv("EMSESP_BRK_ZERO") != nullptr);
+        size_t      separator = device_.rfind(':');
+        std::string host      = device_.substr(4, separator - 4);
+        std::string port      = device_.substr(separator + 1);
+
+        if (addresses_ == nullptr) {
+            struct addrinfo hints = {};
+            hints.ai_family       = AF_UNSPEC;
+            hints.ai_socktype     = SOCK_STREAM;
+            if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses_) != 0) {
+                addresses_ = nullptr; // tried again on the next attempt
+                errno      = EHOSTUNREACH;
+            }
+        }
+        for (struct addrinfo * address = addresses_; (address != nullptr) && (fd < 0); address = address->ai_next) {
+            fd = connect_tcp(address);
+        }
+        if (fd >= 0) {
+            int nodelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        }
+    } else {
+        // a serial device, 9600 8N1. A <BRK> is read as 0xFF 0x00 0x00, a 0xFF as 0xFF 0xFF
+        kind_ = Kind::SERIAL_DEVICE;
+        fd    = open(name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        struct termios tio;
+        if ((fd >= 0) && (tcgetattr(fd, &tio) < 0)) {
+            close(fd);
+            fd = -1;
+        }
+        if (fd >= 0) {
+            cfmakeraw(&tio);
+            cfsetispeed(&tio, B9600);
+            cfsetospeed(&tio, B9600);
+            tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+            tio.c_cflag |= CLOCAL | CREAD;
+            tio.c_iflag &= ~(IGNBRK | BRKINT | IGNPAR);
+            tio.c_iflag |= PARMRK;
+            tio.c_cc[VMIN]  = 0;
+            tio.c_cc[VTIME] = 0;
+            tcsetattr(fd, TCSANOW, &tio);
+            tcflush(fd, TCIOFLUSH);
+        }
+    }
+
+    if (fd < 0) {
+        LOG_ERROR(F("Can't open %s: %s"), name, strerror(errno));
+        return false;
+    }
+
+    if (kind_ != Kind::SERIAL_DEVICE) {
+        struct termios tio;
+        if (tcgetattr(fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fd_        = fd;
+    rx_length_ = 0;
+    rx_mark_   = 0;
+    rx_error_  = false;
+
+    if (pipeline_) {
+        start_bus();
+    } else if (epoll_fd_ >= 0) {
+        struct epoll_event event = {};
+        event.events             = EPOLLIN;
+        event.data.fd            = fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd_, &event);
+    }
+
+    LOG_INFO(F("EMS bus on %s"), device_.c_str());
+    return true;
+}
+
+// the loop waits no longer than CONNECT_WAIT for it, a bridge that's down or not there doesn't hold it up
+int EMSuart::connect_tcp(const struct addrinfo * address) {
+    int fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (fd < 0) {
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    int error = 0;
+    if (connect(fd, address->ai_addr, address->ai_addrlen) < 0) {
+        error = errno;
+        if (error == EINPROGRESS) {
+            struct pollfd out  = {fd, POLLOUT, 0};
+            socklen_t     size = sizeof(error);
+            error              = ETIMEDOUT;
+            if (poll(&out, 1, CONNECT_WAIT) > 0) {
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size);
+            }
+        }
+    }
+    if (error != 0) {
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+void EMSuart::close_device() {
+    stop_bus();
+    if (fd_ >= 0) {
+        close(fd_); // also takes it out of the epoll set
+        fd_ = -1;
+    }
+    if (pty_fd_ >= 0) {
+        close(pty_fd_);
+        pty_fd_ = -1;
+    }
+    rx_length_ = 0;
+    last_open_ = millis();
+}
+
+bool EMSuart::write_all(const uint8_t * data, const uint8_t length) {
+    uint8_t written = 0;
+    while (written < length) {
+        ssize_t ret = write(fd_, data + written, length - written);
+        if (ret > 0) {
+            written += ret;
+        } else if ((ret < 0) && (errno == EAGAIN)) {
+            struct pollfd out = {fd_, POLLOUT, 0};
+            if (poll(&out, 1, 100) <= 0) {
+                return false;
+            }
+        } else if ((ret < 0) && (errno != EINTR)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void EMSuart::receive() {
+    if (fd_ < 0) {
+        if ((kind_ != Kind::NONE) && (millis() - last_open_ >= RECONNECT)) {
+            open_device();
+        }
+        return;
+    }
+
+    // the bus thread only reads, the device is closed here so it's logged and reopened from the loop
+    if (pipeline_ ? bus_lost_.load() : !read_bus()) {
+        LOG_ERROR(F("Lost the EMS bus on %s"), device_.c_str());
+        close_device();
+    }
+}
+
+// returns false when the connection is lost
+bool EMSuart::read_bus() {
+    if (rx_restart_.exchange(false)) {
+        rx_error_ = (rx_length_ > 0);
+    }
+
+    uint8_t buffer[64];
+    while (true) {
+        ssize_t length = read(fd_, buffer, sizeof(buffer));
+        if (length > 0) {
+            rx_time_ = now_us();
+            for (ssize_t i = 0; i < length; i++) {
+                rx_byte(buffer[i]);
+            }
+            continue;
+        }
+        if ((length < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (((length == 0) && (kind_ == Kind::TCP)) || ((length < 0) && (errno != EAGAIN))) {
+            return false;
+        }
+        break;
+    }
+
+    // nothing more for a while, the telegram is complete
+    if ((rx_length_ || rx_error_) && (now_us() - rx_time_ >= RX_GAP * 1000)) {
+        rx_end();
+    }
+    return true;
+}
+
+// the bus thread, it waits for the bus alone so the end of a telegram is seen within the gap
+void EMSuart::bus_loop() {
+    int epoll_fd = epoll_create1(0);
+
+    struct epoll_event event = {};
+    event.events             = EPOLLIN;
+    event.data.fd            = fd_;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd_, &event);
+
+    while (!bus_stop_) {
+        int timeout = LOOP_INTERVAL * 10; // to see the stop
+        if (rx_length_ || rx_error_) {
+            uint64_t idle = now_us() - rx_time_;
+            timeout       = (idle >= RX_GAP * 1000) ? 0 : (RX_GAP * 1000 - idle + 999) / 1000;
+        }
+        epoll_wait(epoll_fd, &event, 1, timeout);
+
+        if (!read_bus()) {
+            bus_lost_ = true;
+        }
+        if ((bus_lost_ || rx_delivered_) && (wake_fd_ >= 0)) {
+            eventfd_write(wake_fd_, 1);
+        }
+        rx_delivered_ = false;
+        if (bus_lost_) {
+            break;
+        }
+    }
+
+    close(epoll_fd);
+}
+
+void EMSuart::start_bus() {
+    if ((fd_ < 0) || bus_thread_.joinable()) {
+        return;
+    }
+    bus_stop_   = false;
+    bus_lost_   = false;
+    bus_thread_ = std::thread(bus_loop);
+}
+
+void EMSuart::stop_bus() {
+    if (bus_thread_.joinable()) {
+        bus_stop_ = true;
+        bus_thread_.join();
+    }
+    bus_lost_ = false;
+}
+
+void EMSuart::pipeline(const bool enable) {
+    if (enable == pipeline_) {
+        return;
+    }
+    if (enable) {
+        if ((epoll_fd_ >= 0) && (fd_ >= 0)) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd_, nullptr);
+        }
+        pipeline_ = true;
+        start_bus();
+    } else {
+        stop_bus();
+        pipeline_ = false;
+        if ((epoll_fd_ >= 0) && (fd_ >= 0)) {
+            struct epoll_event event = {};
+            event.events             = EPOLLIN;
+            event.data.fd            = fd_;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd_, &event);
+        }
+    }
+}
+
+void EMSuart::rx_byte(const uint8_t data) {
+    if (kind_ == Kind::SERIAL_DEVICE) {
+        if (rx_mark_ == 2) {
+            // 0xFF 0x00 0x00 is a <BRK>, anything else had a framing error
+            rx_mark_ = 0;
+            if (data) {
+                rx_error_ = true;
+            } else {
+                rx_end();
+            }
+            return;
+        }
+        if (rx_mark_ == 1) {
+            rx_mark_ = (data == 0xFF) ? 0 : 2;
+            if (rx_mark_) {
+                return;
+            }
+        } else if (data == 0xFF) {
+            rx_mark_ = 1;
+            return;
+        }
+    } else if (brk_zero_ && (rx_length_ == 0) && (data == 0)) {
+        return; // the bridge passes the <BRK> on as a 0, skip it if it's late
+    }
+
+    if (rx_length_ < EMS_MAXBUFFERSIZE) {
+        rx_buf_[rx_length_++] = data;
+    } else {
+        rx_error_ = true; // we have a overflow
+    }
+}
+
+void EMSuart::rx_end() {
+    // a telegram can end with a CRC of 0, so unless the bridge is known to send a 0 for the <BRK>
+    // the 0 is only dropped if the frame is wrong with it and right without it
+    uint8_t length = rx_length_;
+    if ((kind_ == Kind::TCP) && length && (rx_buf_[length - 1] == 0)) {
+        if (brk_zero_ || (!valid_frame(rx_buf_, length) && valid_frame(rx_buf_, length - 1))) {
+            length--; // the <BRK>
+        }
+    }
+
+    // a poll or a poll ack is a single byte, a telegram at least 4
+    if (!rx_error_ && !stopped_ && ((length == 1) || (length > 3))) {
+        EMSESP::incoming_frame(rx_buf_, length);
+        rx_delivered_ = true;
+    }
+
+    rx_length_ = 0;
+    rx_error_  = false;
+}
+
+// a poll or a poll ack, or a telegram with the right CRC
+bool EMSuart::valid_frame(const uint8_t * data, const uint8_t length) {
+    return (length == 1) || ((length > 3) && (EMSbus::calculate_crc(data, length - 1) == data[length - 1]));
+}
+
+int EMSuart::run(void (*loop)()) {
+    struct sigaction action = {};
+    action.sa_handler       = [](int) { interrupted_ = 1; };
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    epoll_fd_ = epoll_create1(0);
+    if (epoll_fd_ < 0) {
+        return 1;
+    }
+
+    struct epoll_event event = {};
+    event.events             = EPOLLIN;
+    if (fd_ >= 0) {
+        event.data.fd = fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd_, &event);
+    }
+
+    // the bus thread wakes us when it has a telegram
+    wake_fd_ = eventfd(0, EFD_NONBLOCK);
+    if (wake_fd_ >= 0) {
+        event.data.fd = wake_fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+    }
+    pipeline(getenv("EMSESP_PIPELINE") != nullptr);
+
+    // the console, it mustn't block the loop
+    fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+    event.data.fd = STDIN_FILENO;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, STDIN_FILENO, &event);
+
+    // most of the loop checks its timers on every pass, so it's woken by the bus, the console and a tick.
+    // While a telegram is coming in, the wait ends when it would be complete
+    uint64_t start = now_us();
+    while (!interrupted_) {
+        int timeout = LOOP_INTERVAL;
+        if (!pipeline_ && (rx_length_ || rx_error_)) {
+            uint64_t idle = now_us() - rx_time_;
+            timeout       = (idle >= RX_GAP * 1000) ? 0 : (RX_GAP * 1000 - idle + 999) / 1000;
+        }
+
+        struct epoll_event events[3];
+        int                count = epoll_wait(epoll_fd_, events, 3, timeout);
+        for (int i = 0; i < count; i++) {
+            if ((events[i].data.fd == STDIN_FILENO) && !(events[i].events & EPOLLIN)) {
+                epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, STDIN_FILENO, nullptr); // closed, or it would wake us all the time
+            } else if (events[i].data.fd == wake_fd_) {
+                eventfd_t wakes;
+                eventfd_read(wake_fd_, &wakes);
+            }
+        }
+
+        set_millis((now_us() - start) / 1000);
+        receive();
+        loop();
+    }
+
+    pipeline(false);
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+    return 0;
 }
 
 /*
@@ -47,6 +512,11 @@ void EMSuart::restart() {
  * It's a bit dirty. there is no special wait logic per tx_mode type, fifo flushes or error checking
  */
 void EMSuart::send_poll(uint8_t data) {
+    if (tx_handler_) {
+        tx_handler_(&data, 1);
+    } else if (fd_ >= 0) {
+        transmit(&data, 1);
+    }
 }
 
 /*
@@ -59,6 +529,27 @@ uint16_t EMSuart::transmit(uint8_t * buf, uint8_t len) {
         return EMS_TX_STATUS_OK; // nothing to send
     }
 
+    if (tx_handler_) {
+        tx_handler_(buf, len);
+        return EMS_TX_STATUS_OK;
+    }
+
+    if (fd_ >= 0) {
+        // the bus thread answers polls and hands the bus back, the loop can still send when it answers a poll itself
+        std::lock_guard<std::mutex> lock(tx_mutex_);
+        if ((len >= EMS_MAXBUFFERSIZE) || !write_all(buf, len)) {
+            return EMS_TX_STATUS_ERR;
+        }
+        // a bridge or a pty end the telegram with the gap
+        if (kind_ == Kind::SERIAL_DEVICE) {
+            tcdrain(fd_);
+            ioctl(fd_, TIOCSBRK);
+            usleep(TX_BREAK);
+            ioctl(fd_, TIOCCBRK);
+        }
+        return EMS_TX_STATUS_OK;
+    }
+
     // Code for when running EMS-ESP standalone without a connected ESP8266 microcontroller
     // For debugging offline
     Serial.print("UART SENDING: ");
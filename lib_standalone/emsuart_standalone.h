@@ -21,24 +21,109 @@
 
 #include <Arduino.h>
 
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <netdb.h>
+
+#include <uuid/log.h>
+
 namespace emsesp {
 
+#define EMS_MAXBUFFERSIZE 33 // max size of the buffer. EMS packets are max 32 bytes, plus extra for BRK
+
 #define EMS_TX_STATUS_ERR 0
 #define EMS_TX_STATUS_OK 1
 
+// On Linux the bus can be a serial device with an EMS interface on it, a TCP serial bridge or a pty,
+// set with EMSESP_UART: "/dev/ttyUSB0", "tcp:192.168.1.20:7000" or "pty" for a new one to connect a simulator to.
+// A telegram ends with a <BRK>, a serial device reports it in the data. A bridge or a pty don't pass it on,
+// there a telegram ends when nothing has come in for RX_GAP ms. Some bridges send a 0 for the <BRK>, set
+// EMSESP_BRK_ZERO for those. Without it a 0 at the end is only taken as a <BRK> if the CRC says so.
+// Without EMSESP_UART it's the same as before, what would be sent is printed or goes to the tx handler.
+// With EMSESP_PIPELINE set as well the bus is read on its own thread, so a telegram is framed on time however long
+// a pass of the loop takes. A poll for us is answered on that thread too, with what the loop has put in the Tx slot,
+// so our telegrams and poll acks don't wait for the loop either, and so is the poll that hands the bus back after an answer. The other frames go to the loop through the Rx queue
+// and wake it, decoding and publishing them and getting the slot ready stay with the loop.
 class EMSuart {
   public:
     EMSuart()  = default;
     ~EMSuart() = default;
 
+    static constexpr uint8_t  RX_GAP        = 3;    // ms, two bytes at 9600 baud and a bit
+    static constexpr uint32_t LOOP_INTERVAL = 10;   // ms, the longest wait for the bus before a pass of the loop
+    static constexpr uint32_t RECONNECT     = 5000; // ms, between attempts to open the device
+    static constexpr uint16_t TX_BREAK      = 1200; // us, the <BRK> after a telegram, 11 bits at 9600 baud
+    static constexpr int      CONNECT_WAIT  = 100;  // ms, the longest the loop waits for a bridge to take the connection
+
     static void     start(uint8_t tx_mode, uint8_t rx_gpio, uint8_t tx_gpio);
     static void     stop();
     static void     restart();
     static void     send_poll(uint8_t data);
     static uint16_t transmit(uint8_t * buf, uint8_t len);
 
+    // takes what we put on the Tx line instead of printing it, e.g. the bus simulator
+    typedef void (*tx_handler_t)(const uint8_t * data, const uint8_t length);
+    static void tx_handler(tx_handler_t handler) {
+        tx_handler_ = handler;
+    }
+
+    // reads what's come in and passes on the telegrams it completes, doesn't wait
+    static void receive();
+
+    // runs loop in real time when there's an EMSESP_UART, woken by the bus and the console. Returns when it's interrupted
+    static int run(void (*loop)());
+
+    // reads the bus on its own thread or in receive()
+    static void pipeline(const bool enable);
+
+    static const char * device() {
+        return device_.c_str();
+    }
+
   private:
+    static uuid::log::Logger logger_;
+
+    enum Kind : uint8_t { NONE, SERIAL_DEVICE, TCP, PTY };
+
     static char * hextoa(char * result, const uint8_t value);
+    static bool   open_device();
+    static int    connect_tcp(const struct addrinfo * address);
+    static void   close_device();
+    static bool   write_all(const uint8_t * data, const uint8_t length);
+    static bool   read_bus();
+    static void   bus_loop();
+    static void   start_bus();
+    static void   stop_bus();
+    static void   rx_byte(const uint8_t data);
+    static void   rx_end();
+    static bool   valid_frame(const uint8_t * data, const uint8_t length);
+
+    static tx_handler_t      tx_handler_;
+    static int               fd_;
+    static int               pty_fd_; // our own hold on the pty, so it doesn't hang up when the other end closes
+    static int               epoll_fd_;
+    static Kind              kind_;
+    static bool              brk_zero_; // the bridge sends a 0 for a <BRK>
+    static std::string       device_;    // or the name of the pty to connect to
+    static struct addrinfo * addresses_; // of the bridge, looked up once so a reconnect doesn't wait for the name server
+    static uint32_t          last_open_;
+    static bool              pipeline_;
+    static std::thread       bus_thread_;
+    static int               wake_fd_;  // an eventfd, the bus thread wakes the loop with it
+    static std::atomic<bool> bus_lost_; // set by the bus thread, the loop closes the device
+    static std::atomic<bool> bus_stop_;
+    static std::atomic<bool> stopped_;
+    static std::atomic<bool> rx_restart_; // the telegram that's coming in is dropped
+    static std::mutex        tx_mutex_;   // a telegram and its <BRK> go out whole, from either thread
+    static uint8_t           rx_buf_[EMS_MAXBUFFERSIZE];
+    static uint8_t           rx_length_;
+    static uint8_t           rx_mark_;  // bytes into a 0xFF 0x00 marker from the serial driver
+    static bool              rx_error_; // a framing error or an overflow, the telegram is dropped
+    static uint64_t          rx_time_;  // us, when the last byte came in
+    static bool              rx_delivered_;
 };
 
 } // namespace emsesp
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+
+"""Converts an EMS-ESP bus capture, downloaded from /rest/busCapture, to text or a replay file
+
+text:   one frame per line, with the time in seconds, the direction and the bytes
+replay: the received frames only, one per line with the ms since the previous one and the bytes
+        including the CRC, the same as 'watch raw' shows them
+"""
+
+import argparse
+import struct
+import sys
+
+HEADER = struct.Struct("<4sBBBxII")
+RECORD = struct.Struct("<IBB")
+
+
+def read_capture(data):
+    magic, version, bus_id, flags, records, dropped = HEADER.unpack_from(data, 0)
+    if magic != b"EMSC":
+        raise ValueError("not an EMS-ESP bus capture")
+    if version != 1:
+        raise ValueError("unknown capture version %d" % version)
+
+    frames = []
+    pos = HEADER.size
+    while pos + RECORD.size <= len(data):
+        timestamp, direction, length = RECORD.unpack_from(data, pos)
+        pos += RECORD.size
+        frames.append((timestamp, "Tx" if direction else "Rx", data[pos:pos + length]))
+        pos += length
+
+    if len(frames) != records:
+        print("warning: header says %d frames, found %d" % (records, len(frames)), file=sys.stderr)
+    return bus_id, dropped, frames
+
+
+def hex_bytes(frame):
+    return " ".join("%02X" % b for b in frame)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="the downloaded capture file")
+    parser.add_argument("-r", "--replay", action="store_true", help="write a replay file instead of text")
+    parser.add_argument("-o", "--output", help="output file, default is stdout")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        bus_id, dropped, frames = read_capture(f.read())
+
+    out = open(args.output, "w") if args.output else sys.stdout
+
+    if args.replay:
+        last = None
+        for timestamp, direction, frame in frames:
+            if direction != "Rx":
+                continue
+            # micros() wraps after about 71 minutes
+            delay = 0 if last is None else ((timestamp - last) & 0xFFFFFFFF) // 1000
+            last = timestamp
+            out.write("%d %s\n" % (delay, hex_bytes(frame)))
+    else:
+        out.write("# bus id 0x%02X, %d frames, %d dropped before the first\n" % (bus_id, len(frames), dropped))
+        start = frames[0][0] if frames else 0
+        for timestamp, direction, frame in frames:
+            elapsed = (timestamp - start) & 0xFFFFFFFF
+            out.write("%6d.%06d %s %s\n" % (elapsed // 1000000, elapsed % 1000000, direction, hex_bytes(frame)))
+
+    if out is not sys.stdout:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
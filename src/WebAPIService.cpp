@@ -24,8 +24,15 @@
 
 namespace emsesp {
 
-WebAPIService::WebAPIService(AsyncWebServer * server) {
+WebAPIService::WebAPIService(AsyncWebServer * server)
+    : _batchHandler(EMSESP_API_SERVICE_PATH,
+                    std::bind(&WebAPIService::webAPIBatch, this, std::placeholders::_1, std::placeholders::_2),
+                    EMSESP_MAX_JSON_SIZE_MEDIUM_DYN) {
     server->on(EMSESP_API_SERVICE_PATH, HTTP_GET, std::bind(&WebAPIService::webAPIService, this, std::placeholders::_1));
+
+    _batchHandler.setMethod(HTTP_POST);
+    _batchHandler.setMaxContentLength(EMSESP_MAX_JSON_SIZE_MEDIUM_DYN);
+    server->addHandler(&_batchHandler);
 }
 
 // http://ems-esp/api?device=boiler&cmd=wwtemp&data=20&id=1
@@ -52,7 +59,8 @@ void WebAPIService::webAPIService(AsyncWebServerRequest * request) {
     String cmd = request->getParam(F_(cmd))->value();
 
     // look up command in our list
-    if (Command::find_command(device_type, cmd.c_str()) == nullptr) {
+    Command::CmdFunction * cf = Command::find_command(device_type, cmd.c_str());
+    if (cf == nullptr) {
         request->send(400, "text/plain", F("Invalid cmd"));
         return;
     }
@@ -71,9 +79,28 @@ void WebAPIService::webAPIService(AsyncWebServerRequest * request) {
         id = "-1";
     }
 
-    DynamicJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
-    JsonObject          json = doc.to<JsonObject>();
-    bool                ok   = false;
+    // commands that only return the device values (like info) are tagged with the value version
+    // so a client can ask with If-None-Match or since=<version> to get only what's new
+    uint32_t version = 0;
+    if (data.isEmpty() && (cf->cmdfunction_json_ != nullptr)) {
+        version = EMSESP::value_version(device_type);
+    }
+
+    char etag[14];
+    snprintf_P(etag, sizeof(etag), PSTR("\"%lu\""), (unsigned long)version);
+    if (version && request->hasHeader("If-None-Match") && (request->getHeader("If-None-Match")->value() == etag)) {
+        request->send(304);
+        return;
+    }
+
+    uint32_t since = 0;
+    if (version && request->hasParam(F_(since))) {
+        since = strtoul(request->getParam(F_(since))->value().c_str(), nullptr, 10);
+    }
+
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+    JsonObject         json = doc.to<JsonObject>();
+    bool               ok   = false;
 
     // execute the command
     if (data.isEmpty()) {
@@ -101,22 +128,192 @@ void WebAPIService::webAPIService(AsyncWebServerRequest * request) {
                ok ? PSTR("OK") : PSTR("Invalid"));
     EMSESP::logger().debug(debug.c_str());
     if (json.size()) {
-        doc.shrinkToFit();
         std::string buffer2;
         serializeJson(doc, buffer2);
         EMSESP::logger().debug("json (max 255 chars): %s", buffer2.c_str());
     }
 #endif
 
+    if (ok && since) {
+        remove_unchanged(device_type, json, since, version, 0);
+    }
+
     // if we have returned data in JSON format, send this to the WEB
-    if (json.size()) {
-        doc.shrinkToFit();
-        std::string buffer;
-        serializeJsonPretty(doc, buffer);
-        request->send(200, "text/plain", buffer.c_str());
+    if (json.size() || since) {
+        uint8_t               encoding = payload_encoding(request);
+        AsyncResponseStream * response = request->beginResponseStream(Helpers::payload_mimetype(encoding));
+        if (version) {
+            response->addHeader("ETag", etag);
+            response->addHeader("Vary", "Accept");
+        }
+        Helpers::serialize_payload(doc, *response, encoding);
+        response->setContentType(Helpers::payload_mimetype(encoding)); // it can have fallen back to json
+        request->send(response);
     } else {
         request->send(200, "text/plain", ok ? F("OK") : F("Invalid"));
     }
 }
 
+// the client can ask for MessagePack or compact json with the Accept header, otherwise use what's set
+uint8_t WebAPIService::payload_encoding(AsyncWebServerRequest * request) {
+    if (request->hasHeader("Accept")) {
+        const char * accept = request->getHeader("Accept")->value().c_str();
+        if (strstr(accept, "msgpack") != nullptr) {
+            return PAYLOAD_MSGPACK;
+        }
+        if (strstr(accept, "application/json") != nullptr) {
+            return PAYLOAD_JSON;
+        }
+    }
+
+    uint8_t encoding;
+    EMSESP::webSettingsService.read([&](WebSettings & settings) { encoding = settings.api_encoding; });
+    return encoding;
+}
+
+// removes the values that haven't changed since the given value version
+// each value is remembered by a hash of its name and of its value, with the version it was first seen with
+void WebAPIService::remove_unchanged(const uint8_t device_type, JsonObject & json, const uint32_t since, const uint32_t version, const uint32_t seed) {
+    std::vector<const char *> unchanged;
+
+    for (JsonPair kv : json) {
+        uint32_t key = Helpers::hash(kv.key().c_str(), seed);
+
+        // nested objects, like the heating circuits
+        if (kv.value().is<JsonObject>()) {
+            JsonObject nested = kv.value().as<JsonObject>();
+            remove_unchanged(device_type, nested, since, version, key);
+            if (nested.size() == 0) {
+                unchanged.push_back(kv.key().c_str());
+            }
+            continue;
+        }
+
+        char buffer[50];
+        serializeJson(kv.value(), buffer);
+        uint32_t value = Helpers::hash(buffer);
+
+        ValueStamp * stamp = nullptr;
+        for (auto & value_stamp : value_stamps_) {
+            if ((value_stamp.device_type_ == device_type) && (value_stamp.key_ == key)) {
+                stamp = &value_stamp;
+                break;
+            }
+        }
+
+        if (stamp == nullptr) {
+            value_stamps_.push_back({device_type, key, value, version});
+            stamp = &value_stamps_.back();
+        } else if (stamp->value_ != value) {
+            stamp->value_   = value;
+            stamp->version_ = version;
+        }
+
+        if (stamp->version_ <= since) {
+            unchanged.push_back(kv.key().c_str());
+        }
+    }
+
+    for (const char * key : unchanged) {
+        json.remove(key);
+    }
+}
+
+// POST to http://ems-esp/api with a list of commands, e.g.
+// [{"device":"thermostat","cmd":"temp","data":21,"id":1},{"device":"thermostat","cmd":"mode","data":"auto","id":1}]
+// returns a list with the result of each command, in the same order. The EMS writes are queued together once all commands have run.
+void WebAPIService::webAPIBatch(AsyncWebServerRequest * request, JsonVariant & json) {
+    if (!json.is<JsonArray>() || (json.size() == 0) || (json.size() > EMSESP_API_MAX_BATCH)) {
+        request->send(400, "text/plain", F("Invalid syntax"));
+        return;
+    }
+
+    bool api_enabled;
+    EMSESP::webSettingsService.read([&](WebSettings & settings) { api_enabled = settings.api_enabled; });
+
+    // we only allow commands with parameters if the API is enabled
+    JsonArray commands = json.as<JsonArray>();
+    if (!api_enabled) {
+        for (JsonObject command : commands) {
+            if (command.containsKey("data")) {
+                request->send(401, "text/plain", F("Unauthorized"));
+                return;
+            }
+        }
+    }
+
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+    JsonArray          results = doc.to<JsonArray>();
+
+    EMSESP::txservice_.start_group();
+
+    for (JsonVariant command : commands) {
+        JsonObject   result = results.createNestedObject(); // same order as the commands
+        const char * device = command["device"];
+        const char * cmd    = command["cmd"];
+
+        if ((device == nullptr) || (cmd == nullptr)) {
+            result["ok"]    = false;
+            result["error"] = "Invalid syntax";
+            continue;
+        }
+
+        uint8_t device_type = EMSdevice::device_name_2_device_type(device);
+        if (device_type == EMSdevice::DeviceType::UNKNOWN) {
+            result["ok"]    = false;
+            result["error"] = "Invalid device";
+            continue;
+        }
+
+        if (Command::find_command(device_type, cmd) == nullptr) {
+            result["ok"]    = false;
+            result["error"] = "Invalid cmd";
+            continue;
+        }
+
+        // data and id may be given as numbers or strings
+        std::string data;
+        if (command["data"].is<const char *>()) {
+            data = command["data"].as<const char *>();
+        } else if (!command["data"].isNull()) {
+            serializeJson(command["data"], data);
+        }
+
+        int8_t id = -1;
+        if (command["id"].is<const char *>()) {
+            id = Helpers::atoint(command["id"]);
+        } else if (!command["id"].isNull()) {
+            id = command["id"];
+        }
+
+        const char * value = data.empty() ? nullptr : data.c_str();
+#ifndef EMSESP_STANDALONE
+        // any json the command returns is added to its result
+        JsonObject output = result.createNestedObject("data");
+        result["ok"]      = Command::call(device_type, cmd, value, id, output);
+        if (output.size() == 0) {
+            result.remove("data");
+        }
+#else
+        result["ok"] = Command::call(device_type, cmd, value, id);
+#endif
+    }
+
+    // none of the writes went when there's no room on the Tx queue for all of them
+    if (!EMSESP::txservice_.end_group()) {
+        for (JsonObject result : results) {
+            if (result["ok"]) {
+                result["ok"]    = false;
+                result["error"] = "Tx queue full";
+            }
+        }
+    }
+
+    uint8_t               encoding = payload_encoding(request);
+    AsyncResponseStream * response = request->beginResponseStream(Helpers::payload_mimetype(encoding));
+    Helpers::serialize_payload(doc, *response, encoding);
+    response->setContentType(Helpers::payload_mimetype(encoding));
+    request->send(response);
+}
+
 } // namespace emsesp
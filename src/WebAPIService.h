@@ -23,7 +23,10 @@
 #include <AsyncJson.h>
 #include <ESPAsyncWebServer.h>
 
+#include <vector>
+
 #define EMSESP_API_SERVICE_PATH "/api"
+#define EMSESP_API_MAX_BATCH 20 // max number of commands in a single POST
 
 namespace emsesp {
 
@@ -32,7 +35,20 @@ class WebAPIService {
     WebAPIService(AsyncWebServer * server);
 
   private:
-    void webAPIService(AsyncWebServerRequest * request);
+    void    webAPIService(AsyncWebServerRequest * request);
+    void    webAPIBatch(AsyncWebServerRequest * request, JsonVariant & json);
+    uint8_t payload_encoding(AsyncWebServerRequest * request);
+    void    remove_unchanged(const uint8_t device_type, JsonObject & json, const uint32_t since, const uint32_t version, const uint32_t seed);
+
+    AsyncCallbackJsonWebHandler _batchHandler;
+
+    struct ValueStamp {
+        uint8_t  device_type_;
+        uint32_t key_;     // hash of the name, including the name of the object it's nested in
+        uint32_t value_;   // hash of the value
+        uint32_t version_; // value version when the value was first seen like this
+    };
+    std::vector<ValueStamp> value_stamps_;
 };
 
 } // namespace emsesp
@@ -0,0 +1,48 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WebCaptureService.h"
+#include "emsesp.h"
+
+namespace emsesp {
+
+WebCaptureService::WebCaptureService(AsyncWebServer * server, SecurityManager * securityManager) {
+    server->on(EMSESP_CAPTURE_SERVICE_PATH,
+               HTTP_GET,
+               securityManager->wrapRequest(std::bind(&WebCaptureService::capture, this, std::placeholders::_1), AuthenticationPredicates::IS_AUTHENTICATED));
+}
+
+// http://ems-esp/rest/busCapture, the bus capture in its binary format, see buscapture.h
+// a running capture is stopped and the response holds on to its ring, so the console can start or clear
+// a capture while the chunks are still being sent from the web task
+void WebCaptureService::capture(AsyncWebServerRequest * request) {
+    auto ring = EMSESP::buscapture_.download();
+    if (!ring) {
+        request->send(404);
+        return;
+    }
+
+    AsyncWebServerResponse * response =
+        request->beginChunkedResponse("application/octet-stream", [ring](uint8_t * buffer, size_t max_len, size_t index) -> size_t {
+            return ring->read(buffer, max_len, index);
+        });
+    response->addHeader("Content-Disposition", "attachment; filename=\"emsesp_capture.bin\"");
+    request->send(response);
+}
+
+} // namespace emsesp
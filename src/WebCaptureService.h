@@ -0,0 +1,39 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WebCaptureService_h
+#define WebCaptureService_h
+
+#include <ESPAsyncWebServer.h>
+#include <SecurityManager.h>
+
+#define EMSESP_CAPTURE_SERVICE_PATH "/rest/busCapture"
+
+namespace emsesp {
+
+class WebCaptureService {
+  public:
+    WebCaptureService(AsyncWebServer * server, SecurityManager * securityManager);
+
+  private:
+    void capture(AsyncWebServerRequest * request);
+};
+
+} // namespace emsesp
+
+#endif
@@ -25,7 +25,8 @@ using namespace std::placeholders; // for `_1` etc
 
 WebDevicesService::WebDevicesService(AsyncWebServer * server, SecurityManager * securityManager)
     : _device_dataHandler(DEVICE_DATA_SERVICE_PATH,
-                          securityManager->wrapCallback(std::bind(&WebDevicesService::device_data, this, _1, _2), AuthenticationPredicates::IS_AUTHENTICATED)) {
+                          securityManager->wrapCallback(std::bind(&WebDevicesService::device_data, this, _1, _2), AuthenticationPredicates::IS_AUTHENTICATED))
+    , _webSocket(DEVICE_DATA_SOCKET_PATH) {
     server->on(EMSESP_DEVICES_SERVICE_PATH,
                HTTP_GET,
                securityManager->wrapRequest(std::bind(&WebDevicesService::all_devices, this, _1), AuthenticationPredicates::IS_AUTHENTICATED));
@@ -37,6 +38,11 @@ WebDevicesService::WebDevicesService(AsyncWebServer * server, SecurityManager *
     _device_dataHandler.setMethod(HTTP_POST);
     _device_dataHandler.setMaxContentLength(256);
     server->addHandler(&_device_dataHandler);
+
+    // live device values, pushed to the web as they change
+    _webSocket.setFilter(securityManager->filterRequest(AuthenticationPredicates::IS_AUTHENTICATED));
+    _webSocket.onEvent(std::bind(&WebDevicesService::onWSEvent, this, _1, _2, _3, _4, _5, _6));
+    server->addHandler(&_webSocket);
 }
 
 void WebDevicesService::scan_devices(AsyncWebServerRequest * request) {
@@ -69,7 +75,7 @@ void WebDevicesService::all_devices(AsyncWebServerRequest * request) {
             JsonObject obj = sensors.createNestedObject();
             obj["no"]      = i++;
             obj["id"]      = sensor.to_string();
-            obj["temp"]    = (float)sensor.temperature_c / 10;
+            obj["temp"]    = FixedPoint(sensor.temperature_c, 10).json();
         }
     }
 
@@ -79,11 +85,28 @@ void WebDevicesService::all_devices(AsyncWebServerRequest * request) {
 
 void WebDevicesService::device_data(AsyncWebServerRequest * request, JsonVariant & json) {
     if (json.is<JsonObject>()) {
-        AsyncJsonResponse * response = new AsyncJsonResponse(false, EMSESP_MAX_JSON_SIZE_MAX_DYN);
-#ifndef EMSESP_STANDALONE
         uint8_t id = json["id"]; // get id from selected table row
+
+        // the value version tells if the client already has the latest values
+        uint32_t version = 0;
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            if (emsdevice && (emsdevice->unique_id() == id)) {
+                version = emsdevice->value_version();
+                break;
+            }
+        }
+        char etag[14];
+        snprintf_P(etag, sizeof(etag), PSTR("\"%lu\""), (unsigned long)version);
+        if (version && request->hasHeader("If-None-Match") && (request->getHeader("If-None-Match")->value() == etag)) {
+            request->send(304);
+            return;
+        }
+
+        AsyncJsonResponse * response = new AsyncJsonResponse(false, EMSESP_MAX_JSON_SIZE_MAX_DYN);
         EMSESP::device_info_web(id, (JsonObject &)response->getRoot());
-#endif
+        if (version) {
+            response->addHeader("ETag", etag);
+        }
         response->setLength();
         request->send(response);
     } else {
@@ -92,4 +115,199 @@ void WebDevicesService::device_data(AsyncWebServerRequest * request, JsonVariant
     }
 }
 
-} // namespace emsesp
\ No newline at end of file
+// a client sends {"id":n} to watch device with unique_id n, it gets a full snapshot back followed by changes only
+// this runs in the web server's task, the subscription itself is changed by the loop
+void WebDevicesService::onWSEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t * data, size_t len) {
+    uint8_t  request[REQUEST_SIZE];
+    uint32_t client_id = client->id();
+    memcpy(request, &client_id, sizeof(client_id));
+
+    if (type == WS_EVT_DISCONNECT) {
+        requests_.push(request, sizeof(client_id));
+        return;
+    }
+
+    if (type != WS_EVT_DATA) {
+        return;
+    }
+
+    // only handle small, single frame text messages
+    AwsFrameInfo * info = (AwsFrameInfo *)arg;
+    if (!info->final || info->index || info->len != len || info->opcode != WS_TEXT) {
+        return;
+    }
+
+    PooledJsonDocument   doc(EMSESP_MAX_JSON_SIZE_SMALL);
+    DeserializationError error = deserializeJson(doc, (const char *)data, len);
+    if (error || !doc.containsKey("id")) {
+        return;
+    }
+
+    request[sizeof(client_id)] = doc["id"];
+    requests_.push(request, REQUEST_SIZE);
+}
+
+// called from process_telegram when a device's values have changed
+void WebDevicesService::device_values_changed(const uint8_t unique_id) {
+    for (auto & device : watched_) {
+        if (device.unique_id_ == unique_id) {
+            device.pending_ = true;
+            return;
+        }
+    }
+}
+
+// push any pending changes to the web clients, not more than once a second per device
+void WebDevicesService::loop() {
+    while (FrameQueue<8, REQUEST_SIZE>::Frame * request = requests_.front()) {
+        uint32_t client_id;
+        memcpy(&client_id, request->data, sizeof(client_id));
+        if (request->length == REQUEST_SIZE) {
+            subscribe(client_id, request->data[sizeof(client_id)]);
+        } else {
+            unsubscribe(client_id);
+        }
+        requests_.pop();
+    }
+
+    uint32_t now = uuid::get_uptime();
+    for (auto & device : watched_) {
+        if (device.pending_ && (now - device.last_push_ >= SOCKET_PUSH_INTERVAL)) {
+            transmit_values(device.unique_id_);
+        }
+    }
+
+    _webSocket.cleanupClients();
+}
+
+void WebDevicesService::subscribe(const uint32_t client_id, const uint8_t unique_id) {
+    unsubscribe(client_id); // a client watches only one device at a time
+    AsyncWebSocketClient * client = _webSocket.client(client_id);
+    if (client == nullptr) {
+        return; // it's gone already
+    }
+    subscribers_.push_back({client_id, unique_id});
+
+    for (auto & device : watched_) {
+        if (device.unique_id_ == unique_id) {
+            // bring the others up to date first, the snapshot below also resets what has been sent
+            if (device.pending_) {
+                transmit_values(unique_id);
+            }
+            transmit_values(unique_id, client);
+            return;
+        }
+    }
+
+    watched_.push_back({unique_id, false, 0, {}});
+    transmit_values(unique_id, client);
+}
+
+void WebDevicesService::unsubscribe(const uint32_t client_id) {
+    for (auto it = subscribers_.begin(); it != subscribers_.end(); ++it) {
+        if (it->client_id_ == client_id) {
+            uint8_t unique_id = it->unique_id_;
+            subscribers_.erase(it);
+
+            // stop tracking the device if no one is watching anymore
+            for (const auto & subscriber : subscribers_) {
+                if (subscriber.unique_id_ == unique_id) {
+                    return;
+                }
+            }
+            for (auto device = watched_.begin(); device != watched_.end(); ++device) {
+                if (device->unique_id_ == unique_id) {
+                    watched_.erase(device);
+                    return;
+                }
+            }
+            return;
+        }
+    }
+}
+
+// send the device values as {"type":"payload",...} to a single client with all values,
+// or as {"type":"delta",...} to all subscribers of the device with only the name/value pairs that changed
+void WebDevicesService::transmit_values(const uint8_t unique_id, AsyncWebSocketClient * client) {
+    WatchedDevice * device = nullptr;
+    for (auto & watched : watched_) {
+        if (watched.unique_id_ == unique_id) {
+            device = &watched;
+            break;
+        }
+    }
+    if (device == nullptr) {
+        return;
+    }
+
+    device->pending_   = false;
+    device->last_push_ = uuid::get_uptime();
+
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_MAX_DYN);
+    JsonObject         root = doc.to<JsonObject>();
+    root["type"]            = (client == nullptr) ? "delta" : "payload";
+    root["id"]              = unique_id;
+    JsonObject payload      = root.createNestedObject("payload");
+    EMSESP::device_info_web(unique_id, payload);
+
+    JsonArray data = payload["data"];
+    if (data.isNull()) {
+        return; // device is gone
+    }
+
+    // hash each name/value pair
+    size_t                size = data.size() / 2;
+    std::vector<uint32_t> hashes;
+    hashes.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        hashes.push_back(Helpers::hash(data[i * 2 + 1].as<const char *>(), Helpers::hash(data[i * 2].as<const char *>())));
+    }
+
+    if (client == nullptr) {
+        if (hashes.size() != device->hashes_.size()) {
+            root["type"] = "payload"; // the list of values itself changed, so send it all
+        } else {
+            // strip the unchanged pairs, from the back so the indexes stay valid
+            for (size_t i = size; i-- > 0;) {
+                if (hashes[i] == device->hashes_[i]) {
+                    data.remove(i * 2 + 1);
+                    data.remove(i * 2);
+                }
+            }
+            if (data.size() == 0) {
+                return; // nothing visible has changed
+            }
+        }
+    }
+
+    device->hashes_ = std::move(hashes);
+
+    uint8_t encoding;
+    EMSESP::webSettingsService.read([&](WebSettings & settings) { encoding = settings.ws_encoding; });
+
+    std::string buffer;
+    Helpers::serialize_payload(doc, buffer, encoding);
+
+    // MessagePack goes out as a binary frame
+    if (client != nullptr) {
+        if (encoding == PAYLOAD_MSGPACK) {
+            client->binary(buffer.c_str(), buffer.length());
+        } else {
+            client->text(buffer.c_str(), buffer.length());
+        }
+        return;
+    }
+
+    for (const auto & subscriber : subscribers_) {
+        if (subscriber.unique_id_ != unique_id) {
+            continue;
+        }
+        if (encoding == PAYLOAD_MSGPACK) {
+            _webSocket.binary(subscriber.client_id_, buffer.c_str(), buffer.length());
+        } else {
+            _webSocket.text(subscriber.client_id_, buffer.c_str(), buffer.length());
+        }
+    }
+}
+
+} // namespace emsesp
@@ -19,14 +19,19 @@
 #ifndef WebDevicesService_h
 #define WebDevicesService_h
 
+#include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
 #include <AsyncJson.h>
-#include <ESPAsyncWebServer.h>
 #include <SecurityManager.h>
 
+#include <vector>
+
+#include "framequeue.h"
+
 #define EMSESP_DEVICES_SERVICE_PATH "/rest/allDevices"
 #define SCAN_DEVICES_SERVICE_PATH "/rest/scanDevices"
 #define DEVICE_DATA_SERVICE_PATH "/rest/deviceData"
+#define DEVICE_DATA_SOCKET_PATH "/ws/deviceData"
 
 namespace emsesp {
 
@@ -34,12 +39,45 @@ class WebDevicesService {
   public:
     WebDevicesService(AsyncWebServer * server, SecurityManager * securityManager);
 
+    void loop();
+    void device_values_changed(const uint8_t unique_id);
+
   private:
+    static constexpr uint32_t SOCKET_PUSH_INTERVAL = 1000; // min time in ms between two pushes of the same device
+
     void all_devices(AsyncWebServerRequest * request);
     void scan_devices(AsyncWebServerRequest * request);
     void device_data(AsyncWebServerRequest * request, JsonVariant & json);
 
+    void onWSEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t * data, size_t len);
+    void subscribe(const uint32_t client_id, const uint8_t unique_id);
+    void unsubscribe(const uint32_t client_id);
+    void transmit_values(const uint8_t unique_id, AsyncWebSocketClient * client = nullptr);
+
     AsyncCallbackJsonWebHandler _device_dataHandler;
+    AsyncWebSocket              _webSocket;
+
+    // a web socket client and the device (by unique_id) it is watching
+    struct Subscriber {
+        uint32_t client_id_;
+        uint8_t  unique_id_;
+    };
+
+    // for every watched device, a hash of each name/value pair last sent, so only changes are pushed
+    struct WatchedDevice {
+        uint8_t               unique_id_;
+        bool                  pending_; // values have changed since the last push
+        uint32_t              last_push_;
+        std::vector<uint32_t> hashes_;
+    };
+
+    // only the loop touches these, the web server's task hands it subscribe and unsubscribe requests through requests_
+    std::vector<Subscriber>    subscribers_;
+    std::vector<WatchedDevice> watched_;
+
+    // a request is the client id, followed by the unique_id of the device for a subscribe
+    static constexpr uint8_t REQUEST_SIZE = sizeof(uint32_t) + 1;
+    FrameQueue<8, REQUEST_SIZE> requests_;
 };
 
 } // namespace emsesp
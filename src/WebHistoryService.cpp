@@ -0,0 +1,78 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WebHistoryService.h"
+#include "emsesp.h"
+
+namespace emsesp {
+
+WebHistoryService::WebHistoryService(AsyncWebServer * server, SecurityManager * securityManager) {
+    server->on(EMSESP_HISTORY_SERVICE_PATH,
+               HTTP_GET,
+               securityManager->wrapRequest(std::bind(&WebHistoryService::history, this, std::placeholders::_1), AuthenticationPredicates::IS_AUTHENTICATED));
+}
+
+// http://ems-esp/rest/history?name=boiler/curFlowTemp&from=1610000000&to=1610086400&resolution=60
+// from and to are in the times of the history, without them it's the last 24 hours. The resolution is in seconds,
+// without it it's the finest that goes back far enough. The values are sent in chunks, as they're decoded
+// from a copy of the segments that's taken here, the chunks are made in the web task while the history goes on.
+// A long range at a fine resolution can end before to, the client carries on from the last time it got
+static constexpr uint32_t HISTORY_DEFAULT_RANGE = 86400;
+static constexpr uint16_t HISTORY_CHUNK_VALUES  = 50;
+
+void WebHistoryService::history(AsyncWebServerRequest * request) {
+    if (!request->hasParam(F_(name))) {
+        request->send(400);
+        return;
+    }
+
+    uint32_t to         = request->hasParam(F("to")) ? strtoul(request->getParam(F("to"))->value().c_str(), nullptr, 10) : History::now();
+    uint32_t from       = request->hasParam(F("from")) ? strtoul(request->getParam(F("from"))->value().c_str(), nullptr, 10)
+                                                       : ((to > HISTORY_DEFAULT_RANGE) ? to - HISTORY_DEFAULT_RANGE : 0);
+    uint32_t resolution = request->hasParam(F("resolution")) ? strtoul(request->getParam(F("resolution"))->value().c_str(), nullptr, 10) : 0;
+
+    struct Progress {
+        History::Query query;
+        size_t         sent = 0;
+        std::string    pending;
+    };
+    auto progress = std::make_shared<Progress>();
+
+    if (!EMSESP::history_.start_query(progress->query, request->getParam(F_(name))->value().c_str(), from, to, resolution)) {
+        request->send(404);
+        return;
+    }
+
+    AsyncWebServerResponse * response = request->beginChunkedResponse("application/json", [progress](uint8_t * buffer, size_t max_len, size_t index) -> size_t {
+        while (progress->sent == progress->pending.size()) {
+            progress->pending.clear();
+            progress->sent = 0;
+            if (!History::render(progress->pending, progress->query, HISTORY_CHUNK_VALUES)) {
+                return 0; // all done
+            }
+        }
+
+        size_t len = std::min(max_len, progress->pending.size() - progress->sent);
+        memcpy(buffer, progress->pending.data() + progress->sent, len);
+        progress->sent += len;
+        return len;
+    });
+    request->send(response);
+}
+
+} // namespace emsesp
@@ -0,0 +1,39 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WebHistoryService_h
+#define WebHistoryService_h
+
+#include <ESPAsyncWebServer.h>
+#include <SecurityManager.h>
+
+#define EMSESP_HISTORY_SERVICE_PATH "/rest/history"
+
+namespace emsesp {
+
+class WebHistoryService {
+  public:
+    WebHistoryService(AsyncWebServer * server, SecurityManager * securityManager);
+
+  private:
+    void history(AsyncWebServerRequest * request);
+};
+
+} // namespace emsesp
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WebMetricsService.h"
+#include "emsesp.h"
+
+namespace emsesp {
+
+WebMetricsService::WebMetricsService(AsyncWebServer * server) {
+    server->on(EMSESP_METRICS_SERVICE_PATH, HTTP_GET, std::bind(&WebMetricsService::metrics, this, std::placeholders::_1));
+}
+
+// http://ems-esp/metrics, in the Prometheus text format
+// the response is chunked and built up as it's sent: first the system, then one EMS device at a time and the sensors last,
+// so there is never more than a single device's worth of text in memory
+// the chunks are made in the async web task, so it takes the loop's snapshot of the list of devices when the request
+// comes in and holds on to it until the response is done, even if devices are added in the meantime
+void WebMetricsService::metrics(AsyncWebServerRequest * request) {
+    struct Progress {
+        size_t                                                         step = 0;
+        size_t                                                         sent = 0;
+        std::string                                                    pending;
+        std::shared_ptr<const std::vector<std::shared_ptr<EMSdevice>>> emsdevices;
+    };
+    auto progress        = std::make_shared<Progress>();
+    progress->emsdevices = EMSESP::emsdevices_snapshot();
+
+    AsyncWebServerResponse * response =
+        request->beginChunkedResponse("text/plain; version=0.0.4", [progress](uint8_t * buffer, size_t max_len, size_t index) -> size_t {
+            // when all that we had is sent, move on to the next part
+            while (progress->sent == progress->pending.size()) {
+                progress->pending.clear();
+                progress->sent = 0;
+
+                size_t step = progress->step++;
+                if (step == 0) {
+                    system_metrics(progress->pending);
+                } else if (step <= progress->emsdevices->size()) {
+                    device_metrics(progress->pending, (*progress->emsdevices)[step - 1]);
+                } else if (step == progress->emsdevices->size() + 1) {
+                    sensor_metrics(progress->pending);
+                } else {
+                    return 0; // all done
+                }
+            }
+
+            size_t len = std::min(max_len, progress->pending.size() - progress->sent);
+            memcpy(buffer, progress->pending.data() + progress->sent, len);
+            progress->sent += len;
+            return len;
+        });
+
+    request->send(response);
+}
+
+// bus, queue and memory stats
+void WebMetricsService::system_metrics(std::string & output) {
+    char line[100];
+
+    snprintf_P(line, sizeof(line), PSTR("# TYPE emsesp_uptime_seconds counter\nemsesp_uptime_seconds %lu\n"), (unsigned long)uuid::get_uptime_sec());
+    output += line;
+    snprintf_P(line, sizeof(line), PSTR("# TYPE emsesp_free_mem_percent gauge\nemsesp_free_mem_percent %d\n"), System::free_mem());
+    output += line;
+
+    snprintf_P(line, sizeof(line), PSTR("# TYPE emsesp_rx_telegrams_total counter\nemsesp_rx_telegrams_total %lu\n"), (unsigned long)EMSESP::rxservice_.telegram_count());
+    output += line;
+    snprintf_P(line,
+               sizeof(line),
+               PSTR("# TYPE emsesp_rx_errors_total counter\nemsesp_rx_errors_total %lu\n"),
+               (unsigned long)EMSESP::rxservice_.telegram_error_count());
+    output += line;
+
+    snprintf_P(line, sizeof(line), PSTR("# TYPE emsesp_tx_reads_total counter\nemsesp_tx_reads_total %lu\n"), (unsigned long)EMSESP::txservice_.telegram_read_count());
+    output += line;
+    snprintf_P(line,
+               sizeof(line),
+               PSTR("# TYPE emsesp_tx_writes_total counter\nemsesp_tx_writes_total %lu\n"),
+               (unsigned long)EMSESP::txservice_.telegram_write_count());
+    output += line;
+    snprintf_P(line, sizeof(line), PSTR("# TYPE emsesp_tx_fails_total counter\nemsesp_tx_fails_total %lu\n"), (unsigned long)EMSESP::txservice_.telegram_fail_count());
+    output += line;
+    snprintf_P(line, sizeof(line), PSTR("# TYPE emsesp_tx_queue_telegrams gauge\nemsesp_tx_queue_telegrams %lu\n"), (unsigned long)EMSESP::txservice_.queue_size());
+    output += line;
+
+    snprintf_P(line,
+               sizeof(line),
+               PSTR("# TYPE emsesp_json_pool_fallbacks_total counter\nemsesp_json_pool_fallbacks_total %lu\n"),
+               (unsigned long)JsonPool::fallbacks());
+    output += line;
+
+    snprintf_P(line, sizeof(line), PSTR("# TYPE emsesp_mqtt_queue_messages gauge\nemsesp_mqtt_queue_messages %lu\n"), (unsigned long)Mqtt::queue_size());
+    output += line;
+    snprintf_P(line, sizeof(line), PSTR("# TYPE emsesp_mqtt_publish_fails_total counter\nemsesp_mqtt_publish_fails_total %lu\n"), (unsigned long)Mqtt::publish_fails());
+    output += line;
+}
+
+// all values of a single EMS device, labelled with the device and for thermostats and mixers also the heating circuit
+// written straight into the output by export_metrics(), without a json document in between
+void WebMetricsService::device_metrics(std::string & output, const std::shared_ptr<EMSdevice> & emsdevice) {
+    if (!emsdevice) {
+        return;
+    }
+
+    char labels[50];
+    char device_name[20];
+    snprintf_P(labels,
+               sizeof(labels),
+               PSTR("device=\"%s\",device_id=\"0x%02X\""),
+               EMSdevice::device_type_2_device_name_P(emsdevice->device_type()).c_str(device_name),
+               emsdevice->device_id());
+
+    MetricsObject json(output, labels);
+    emsdevice->export_metrics(json);
+}
+
+// Dallas temperature sensors
+void WebMetricsService::sensor_metrics(std::string & output) {
+    if (!EMSESP::have_sensors()) {
+        return;
+    }
+
+    output += "# TYPE emsesp_sensor_temperature_celsius gauge\n";
+    for (const auto & sensor : EMSESP::sensor_devices()) {
+        if (sensor.temperature_c == EMS_VALUE_SHORT_NOTSET) {
+            continue;
+        }
+        char line[80];
+        char s[10];
+        snprintf_P(line,
+                   sizeof(line),
+                   PSTR("emsesp_sensor_temperature_celsius{id=\"%s\"} %s\n"),
+                   sensor.to_string().c_str(),
+                   Helpers::render_value(s, sensor.temperature_c, 10));
+        output += line;
+    }
+}
+
+} // namespace emsesp
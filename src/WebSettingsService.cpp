@@ -24,8 +24,15 @@ namespace emsesp {
 uint8_t WebSettings::flags_;
 
 WebSettingsService::WebSettingsService(AsyncWebServer * server, FS * fs, SecurityManager * securityManager)
-    : _httpEndpoint(WebSettings::read, WebSettings::update, this, server, EMSESP_SETTINGS_SERVICE_PATH, securityManager)
-    , _fsPersistence(WebSettings::read, WebSettings::update, this, fs, EMSESP_SETTINGS_FILE) {
+    : _httpEndpoint(WebSettings::read,
+                    WebSettings::update,
+                    this,
+                    server,
+                    EMSESP_SETTINGS_SERVICE_PATH,
+                    securityManager,
+                    AuthenticationPredicates::IS_ADMIN,
+                    EMSESP_SETTINGS_BUFFER_SIZE)
+    , _fsPersistence(WebSettings::read, WebSettings::update, this, fs, EMSESP_SETTINGS_FILE, EMSESP_SETTINGS_BUFFER_SIZE) {
     addUpdateHandler([&](const String & originId) { onUpdate(); }, false);
 }
 
@@ -50,6 +57,25 @@ void WebSettings::read(WebSettings & settings, JsonObject & root) {
     root["api_enabled"]          = settings.api_enabled;
     root["bool_format"]          = settings.bool_format;
     root["analog_enabled"]       = settings.analog_enabled;
+    root["mqtt_encoding"]        = settings.mqtt_encoding;
+    root["api_encoding"]         = settings.api_encoding;
+    root["ws_encoding"]          = settings.ws_encoding;
+    root["stats_publish"]        = settings.stats_publish;
+
+    JsonObject filters = root.createNestedObject("value_filters");
+    for (const auto & setting : settings.value_filters) {
+        JsonObject filter  = filters.createNestedObject(setting.name);
+        filter["deadband"] = setting.config.deadband;
+        filter["relative"] = setting.config.relative;
+        filter["interval"] = setting.config.interval;
+        filter["window"]   = setting.config.window;
+    }
+
+    JsonArray history = root.createNestedArray("history_values");
+    for (const auto & name : settings.history_values) {
+        history.add(name);
+    }
+    root["history_spill"] = settings.history_spill;
 }
 
 StateUpdateResult WebSettings::update(JsonObject & root, WebSettings & settings) {
@@ -95,14 +121,56 @@ StateUpdateResult WebSettings::update(JsonObject & root, WebSettings & settings)
     }
 
     // other
-    snprintf_P(&crc_before[0], crc_before.capacity() + 1, PSTR("%d%d"), settings.bool_format, settings.analog_enabled);
+    snprintf_P(&crc_before[0],
+               crc_before.capacity() + 1,
+               PSTR("%d%d%d%d"),
+               settings.bool_format,
+               settings.analog_enabled,
+               settings.mqtt_encoding,
+               settings.stats_publish);
     settings.bool_format    = root["bool_format"] | EMSESP_DEFAULT_BOOL_FORMAT;
     settings.analog_enabled = root["analog_enabled"] | EMSESP_DEFAULT_ANALOG_ENABLED;
-    snprintf_P(&crc_after[0], crc_after.capacity() + 1, PSTR("%d%d"), settings.bool_format, settings.analog_enabled);
+    settings.mqtt_encoding  = root["mqtt_encoding"] | EMSESP_DEFAULT_MQTT_ENCODING;
+    settings.stats_publish  = root["stats_publish"] | EMSESP_DEFAULT_STATS_PUBLISH;
+    snprintf_P(&crc_after[0],
+               crc_after.capacity() + 1,
+               PSTR("%d%d%d%d"),
+               settings.bool_format,
+               settings.analog_enabled,
+               settings.mqtt_encoding,
+               settings.stats_publish);
     if (crc_before != crc_after) {
         add_flags(ChangeFlags::OTHER);
     }
 
+    // value filters, which are also applied in other_init()
+    std::vector<ValueFilter::Setting> value_filters;
+    for (JsonPair kv : root["value_filters"].as<JsonObject>()) {
+        ValueFilter::Setting setting;
+        setting.name            = kv.key().c_str();
+        setting.config.deadband = kv.value()["deadband"] | 0;
+        setting.config.relative = kv.value()["relative"] | 0;
+        setting.config.interval = kv.value()["interval"] | 0;
+        setting.config.window   = kv.value()["window"] | 1;
+        value_filters.push_back(setting);
+    }
+    if (value_filters != settings.value_filters) {
+        settings.value_filters = value_filters;
+        add_flags(ChangeFlags::OTHER);
+    }
+
+    // history, also applied in other_init()
+    std::vector<std::string> history_values;
+    for (JsonVariant name : root["history_values"].as<JsonArray>()) {
+        history_values.push_back(name.as<std::string>());
+    }
+    bool history_spill = root["history_spill"] | EMSESP_DEFAULT_HISTORY_SPILL;
+    if ((history_values != settings.history_values) || (history_spill != settings.history_spill)) {
+        settings.history_values = history_values;
+        settings.history_spill  = history_spill;
+        add_flags(ChangeFlags::OTHER);
+    }
+
     // dallas
     snprintf_P(&crc_before[0], crc_before.capacity() + 1, PSTR("%d%d"), settings.dallas_gpio, settings.dallas_parasite);
     settings.dallas_gpio     = root["dallas_gpio"] | EMSESP_DEFAULT_DALLAS_GPIO;
@@ -135,7 +203,9 @@ StateUpdateResult WebSettings::update(JsonObject & root, WebSettings & settings)
     settings.master_thermostat = root["master_thermostat"] | EMSESP_DEFAULT_MASTER_THERMOSTAT;
 
     // doesn't need any follow-up actions
-    settings.api_enabled = root["api_enabled"] | EMSESP_DEFAULT_API_ENABLED;
+    settings.api_enabled  = root["api_enabled"] | EMSESP_DEFAULT_API_ENABLED;
+    settings.api_encoding = root["api_encoding"] | EMSESP_DEFAULT_API_ENCODING;
+    settings.ws_encoding  = root["ws_encoding"] | EMSESP_DEFAULT_WS_ENCODING;
 
     return StateUpdateResult::CHANGED;
 }
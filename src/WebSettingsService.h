@@ -22,8 +22,11 @@
 #include <HttpEndpoint.h>
 #include <FSPersistence.h>
 
+#include "valuefilter.h"
+
 #define EMSESP_SETTINGS_FILE "/config/emsespSettings.json"
 #define EMSESP_SETTINGS_SERVICE_PATH "/rest/emsespSettings"
+#define EMSESP_SETTINGS_BUFFER_SIZE 2048 // with room for the value filters
 
 #define EMSESP_DEFAULT_TX_MODE 1       // EMS1.0
 #define EMSESP_DEFAULT_TX_DELAY 0      // no delay
@@ -45,6 +48,11 @@
 #define EMSESP_DEFAULT_API_ENABLED false // turn off, because its insecure
 #define EMSESP_DEFAULT_BOOL_FORMAT 1     // on/off
 #define EMSESP_DEFAULT_ANALOG_ENABLED false
+#define EMSESP_DEFAULT_MQTT_ENCODING PAYLOAD_JSON
+#define EMSESP_DEFAULT_API_ENCODING PAYLOAD_JSON_PRETTY
+#define EMSESP_DEFAULT_WS_ENCODING PAYLOAD_JSON
+#define EMSESP_DEFAULT_HISTORY_SPILL false
+#define EMSESP_DEFAULT_STATS_PUBLISH 10 // minutes
 
 // Default GPIO PIN definitions
 #if defined(ESP8266)
@@ -89,6 +97,14 @@ class WebSettings {
     bool     api_enabled;
     uint8_t  bool_format;
     bool     analog_enabled;
+    uint8_t  mqtt_encoding; // PAYLOAD_JSON_PRETTY, PAYLOAD_JSON or PAYLOAD_MSGPACK, the HA format is always json
+    uint8_t  api_encoding;
+    uint8_t  ws_encoding;
+    uint8_t  stats_publish; // minutes between the statistics, 0 is off
+
+    std::vector<ValueFilter::Setting> value_filters;  // by value name, e.g. "curFlowTemp":{"deadband":5,"interval":60}
+    std::vector<std::string>          history_values; // e.g. "boiler/curFlowTemp", see history.h
+    bool                              history_spill;
 
     static void              read(WebSettings & settings, JsonObject & root);
     static StateUpdateResult update(JsonObject & root, WebSettings & settings);
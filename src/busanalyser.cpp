@@ -0,0 +1,269 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "busanalyser.h"
+#include "emsesp.h"
+
+#include <algorithm>
+
+namespace emsesp {
+
+void BusAnalyser::start() {
+    start_ = ::millis();
+
+    // API call
+    Command::add_with_json(EMSdevice::DeviceType::SYSTEM, F_(bus), [&](const char * value, const int8_t id, JsonObject & json) {
+        return export_values(json);
+    });
+}
+
+// called for every frame received from the UART, before anything else looks at it. now is when it came in
+void BusAnalyser::incoming(const uint8_t * data, const uint8_t length, const uint32_t now) {
+    if (length == 0) {
+        return;
+    }
+
+    roll(now);
+
+    current_.frames_++;
+    current_.bytes_ += length;
+
+    uint8_t first = data[0];
+
+    // our own transmit, the time since the last poll to us is how quickly we used the bus
+    if (((first & 0x7F) == EMSbus::ems_bus_id()) && (length > 1)) {
+        current_.echoes_++;
+        if (pending_gap_) {
+            uint32_t gap = now - pending_gap_;
+            if (gap <= MAX_POLL_TX_GAP) {
+                current_.gap_sum_ += gap;
+                current_.gap_max_ = std::max(current_.gap_max_, gap);
+                current_.gap_count_++;
+            }
+            pending_gap_ = 0;
+        }
+        return;
+    }
+
+    // single bytes are polls from the master, or the ack of a write
+    if (length == 1) {
+        if (!((first ^ EMSbus::ems_mask()) & 0x80)) {
+            return; // write ack
+        }
+        current_.polls_++;
+        if ((first ^ 0x80 ^ EMSbus::ems_mask()) == EMSbus::ems_bus_id()) {
+            current_.polls_us_++;
+            if (last_poll_) {
+                uint32_t cycle = now - last_poll_;
+                if (cycle <= MAX_POLL_CYCLE) {
+                    current_.cycle_sum_ += cycle;
+                    current_.cycle_min_ = current_.cycle_count_ ? std::min(current_.cycle_min_, cycle) : cycle;
+                    current_.cycle_max_ = std::max(current_.cycle_max_, cycle);
+                    current_.cycle_count_++;
+                }
+            }
+            last_poll_   = now;
+            pending_gap_ = now;
+        }
+        return;
+    }
+
+    current_.telegrams_++;
+    count(sources_, MAX_SOURCES, first & 0x7F);
+    count(types_, MAX_TYPES, type_id(data, length));
+}
+
+// close the current window when it's full
+void BusAnalyser::roll(const uint32_t now) {
+    if ((now - start_) < WINDOW_MS) {
+        return;
+    }
+
+    last_           = current_;
+    last_.duration_ = now - start_;
+    have_last_      = true;
+    current_        = {};
+    start_          = now;
+
+    for (auto & counters : {&sources_, &types_}) {
+        for (auto & counter : *counters) {
+            counter.last_    = counter.current_;
+            counter.current_ = 0;
+        }
+        counters->erase(std::remove_if(counters->begin(), counters->end(), [](const Counter & counter) { return counter.last_ == 0; }), counters->end());
+    }
+}
+
+// tables are bounded, anything new once it's full goes into other
+void BusAnalyser::count(std::vector<Counter> & counters, const uint8_t max, const uint32_t key) {
+    for (auto & counter : counters) {
+        if (counter.key_ == key) {
+            counter.current_++;
+            return;
+        }
+    }
+
+    if (counters.size() < max) {
+        counters.push_back({key, 1, 0});
+        return;
+    }
+
+    for (auto & counter : counters) {
+        if (counter.key_ == OTHER) {
+            counter.current_++;
+            return;
+        }
+    }
+    counters.push_back({OTHER, 1, 0});
+}
+
+// the last complete window, or the current one with what has elapsed so far
+BusAnalyser::Window BusAnalyser::report() const {
+    if (have_last_) {
+        return last_;
+    }
+    Window window    = current_;
+    window.duration_ = ::millis() - start_;
+    return window;
+}
+
+// counters of the reported window, busiest first
+std::vector<BusAnalyser::Counter> BusAnalyser::sorted(const std::vector<Counter> & counters) const {
+    std::vector<Counter> result;
+    for (const auto & counter : counters) {
+        uint32_t n = have_last_ ? counter.last_ : counter.current_;
+        if (n) {
+            result.push_back({counter.key_, n, 0});
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Counter & a, const Counter & b) { return a.current_ > b.current_; });
+    return result;
+}
+
+// time the bus was busy, from the bytes and the breaks between frames
+uint32_t BusAnalyser::busy_percent(const Window & window) {
+    if (window.duration_ == 0) {
+        return 0;
+    }
+    uint64_t busy_us = (uint64_t)window.bytes_ * BYTE_TIME_US + (uint64_t)window.frames_ * BREAK_TIME_US;
+    return std::min((uint32_t)(busy_us / ((uint64_t)window.duration_ * 10)), (uint32_t)100);
+}
+
+// EMS 1.0 type in byte 2, EMS+ types are offset by 256 like in the device handlers, up to 0x100FF
+uint32_t BusAnalyser::type_id(const uint8_t * data, const uint8_t length) {
+    if (length < 4) {
+        return OTHER;
+    }
+    if (data[2] != 0xFF) {
+        return data[2];
+    }
+    if (data[1] & 0x80) {
+        return (length > 6) ? (data[5] << 8) + data[6] + 256 : OTHER;
+    }
+    return (length > 5) ? (data[4] << 8) + data[5] + 256 : OTHER;
+}
+
+void BusAnalyser::show(uuid::console::Shell & shell) {
+    roll(::millis());
+    Window window = report();
+
+    shell.printfln(F("EMS Bus analyser (%lu seconds):"), window.duration_ / 1000);
+    shell.printfln(F("  Frames: %lu, telegrams: %lu, polls: %lu (%lu to us), our transmits: %lu"),
+                   window.frames_,
+                   window.telegrams_,
+                   window.polls_,
+                   window.polls_us_,
+                   window.echoes_);
+    uint32_t busy = busy_percent(window);
+    shell.printfln(F("  Bytes: %lu, bus load: %lu%%, idle: %lu%%"), window.bytes_, busy, 100 - busy);
+    if (window.cycle_count_) {
+        shell.printfln(F("  Poll cycle: %lu ms (min %lu, max %lu)"),
+                       window.cycle_sum_ / window.cycle_count_,
+                       window.cycle_min_,
+                       window.cycle_max_);
+    }
+    if (window.gap_count_) {
+        shell.printfln(F("  Poll to transmit: %lu ms (max %lu)"), window.gap_sum_ / window.gap_count_, window.gap_max_);
+    }
+
+    auto sources = sorted(sources_);
+    if (!sources.empty()) {
+        shell.printfln(F("  Telegrams by source:"));
+        for (const auto & counter : sources) {
+            if (counter.key_ == OTHER) {
+                shell.printfln(F("    other: %lu"), counter.current_);
+            } else {
+                shell.printfln(F("    0x%02lX: %lu"), (unsigned long)counter.key_, counter.current_);
+            }
+        }
+    }
+
+    auto types = sorted(types_);
+    if (!types.empty()) {
+        shell.printfln(F("  Telegrams by type:"));
+        for (const auto & counter : types) {
+            if (counter.key_ == OTHER) {
+                shell.printfln(F("    other: %lu"), counter.current_);
+            } else {
+                shell.printfln(F("    0x%02lX: %lu"), (unsigned long)counter.key_, counter.current_);
+            }
+        }
+    }
+    shell.println();
+}
+
+bool BusAnalyser::export_values(JsonObject & json) {
+    roll(::millis());
+    Window window = report();
+    uint32_t busy = busy_percent(window);
+
+    json["duration"]  = window.duration_ / 1000;
+    json["frames"]    = window.frames_;
+    json["telegrams"] = window.telegrams_;
+    json["polls"]     = window.polls_;
+    json["transmits"] = window.echoes_;
+    json["bytes"]     = window.bytes_;
+    json["busload"]   = busy;
+    json["idle"]      = 100 - busy;
+    if (window.cycle_count_) {
+        json["pollcycle"]    = window.cycle_sum_ / window.cycle_count_;
+        json["pollcyclemin"] = window.cycle_min_;
+        json["pollcyclemax"] = window.cycle_max_;
+    }
+    if (window.gap_count_) {
+        json["polltxgap"]    = window.gap_sum_ / window.gap_count_;
+        json["polltxgapmax"] = window.gap_max_;
+    }
+
+    char key[8];
+    for (auto & list : {std::make_pair("sources", &sources_), std::make_pair("types", &types_)}) {
+        JsonObject counts = json.createNestedObject(list.first);
+        for (const auto & counter : sorted(*list.second)) {
+            if (counter.key_ == OTHER) {
+                strlcpy(key, "other", sizeof(key));
+            } else {
+                snprintf_P(key, sizeof(key), PSTR("0x%02lX"), (unsigned long)counter.key_);
+            }
+            counts[key] = counter.current_;
+        }
+    }
+
+    return true;
+}
+
+} // namespace emsesp
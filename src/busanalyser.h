@@ -0,0 +1,97 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_BUSANALYSER_H
+#define EMSESP_BUSANALYSER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <uuid/console.h>
+
+#include <vector>
+
+namespace emsesp {
+
+// passively counts everything seen on the EMS bus, in windows of a minute
+// results are reported from the last complete window, or the current one until the first is complete
+class BusAnalyser {
+  public:
+    void start();
+    void incoming(const uint8_t * data, const uint8_t length, const uint32_t now);
+
+    void show(uuid::console::Shell & shell);
+    bool export_values(JsonObject & json);
+
+    static constexpr uint32_t OTHER = 0xFFFFFFFF; // type id of polls, acks and anything too short
+
+    static uint32_t type_id(const uint8_t * data, const uint8_t length);
+
+  private:
+    static constexpr uint32_t WINDOW_MS       = 60000; // length of a window
+    static constexpr uint8_t  MAX_SOURCES     = 16;    // devices tracked by source, the rest is counted as other
+    static constexpr uint8_t  MAX_TYPES       = 24;    // telegram types tracked, the rest is counted as other
+    static constexpr uint32_t BYTE_TIME_US    = 1042;  // 10 bits at 9600 baud
+    static constexpr uint32_t BREAK_TIME_US   = 1146;  // 11 bits break at the end of each frame
+    static constexpr uint32_t MAX_POLL_CYCLE  = 10000; // ignore longer poll cycles, the bus was probably down
+    static constexpr uint32_t MAX_POLL_TX_GAP = 1000;
+
+    struct Window {
+        uint32_t duration_;   // ms
+        uint32_t frames_;     // everything, including polls and echoes
+        uint32_t telegrams_;  // frames with data
+        uint32_t bytes_;      // bytes on the wire
+        uint32_t polls_;      // polls from the master
+        uint32_t polls_us_;   // polls to us
+        uint32_t echoes_;     // our own transmits
+        uint32_t cycle_sum_;  // ms between two polls to us
+        uint32_t cycle_min_;
+        uint32_t cycle_max_;
+        uint32_t cycle_count_;
+        uint32_t gap_sum_; // ms between a poll to us and the echo of what we sent
+        uint32_t gap_max_;
+        uint32_t gap_count_;
+    };
+
+    // telegram count by source or by type id, for the current and last window
+    struct Counter {
+        uint32_t key_; // wide enough for every EMS+ type with the 256 added, and OTHER
+        uint32_t current_;
+        uint32_t last_;
+    };
+
+    void roll(const uint32_t now);
+    void count(std::vector<Counter> & counters, const uint8_t max, const uint32_t key);
+
+    Window               report() const;
+    std::vector<Counter> sorted(const std::vector<Counter> & counters) const;
+    static uint32_t      busy_percent(const Window & window);
+
+    Window               current_     = {};
+    Window               last_        = {};
+    bool                 have_last_   = false;
+    uint32_t             start_       = 0; // ms, start of the current window
+    uint32_t             last_poll_   = 0; // ms, last poll to us
+    uint32_t             pending_gap_ = 0; // ms, poll to us for which we haven't seen a transmit yet
+    std::vector<Counter> sources_;
+    std::vector<Counter> types_;
+};
+
+} // namespace emsesp
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buscapture.h"
+#include "emsesp.h"
+
+namespace emsesp {
+
+// the ring is only allocated while there is a capture, it's started empty
+// with a start type it waits for a telegram of that type, which is the first one recorded
+void BusCapture::start(const uint32_t start_type) {
+    // a ring that is being downloaded is left to the download
+    if (!ring_ || (ring_.use_count() > 1)) {
+        ring_ = std::shared_ptr<Ring>(new (std::nothrow) Ring);
+        if (!ring_) {
+            state_ = OFF;
+            return;
+        }
+    } else {
+        ring_->head_    = 0;
+        ring_->tail_    = 0;
+        ring_->used_    = 0;
+        ring_->records_ = 0;
+        ring_->dropped_ = 0;
+    }
+
+    start_type_  = start_type;
+    stop_type_   = TYPE_NONE;
+    stop_frames_ = 0;
+    state_       = (start_type == TYPE_NONE) ? RUNNING : ARMED;
+}
+
+// after a telegram of the stop type, records the given number of frames more and then stops
+void BusCapture::stop_after(const uint32_t stop_type, const uint16_t frames) {
+    stop_type_   = stop_type;
+    stop_frames_ = frames;
+    if (state_ == STOPPING) {
+        state_ = RUNNING;
+    }
+}
+
+// stops recording, what's in the ring is kept for the download
+void BusCapture::stop() {
+    if (state_ != OFF) {
+        state_ = STOPPED;
+    }
+}
+
+// stops and frees the ring, or leaves it to a download that still has it
+void BusCapture::clear() {
+    state_ = OFF;
+    ring_.reset();
+}
+
+std::shared_ptr<const BusCapture::Ring> BusCapture::download() {
+    stop();
+    return ring_;
+}
+
+void BusCapture::record(const uint8_t direction, const uint8_t * data, const uint8_t length, const uint32_t timestamp) {
+    // the type is only needed for the trigger conditions
+    uint32_t type_id = ((start_type_ != TYPE_NONE) || (stop_type_ != TYPE_NONE)) ? BusAnalyser::type_id(data, length) : BusAnalyser::OTHER;
+
+    if (state_ == ARMED) {
+        if (type_id != start_type_) {
+            return;
+        }
+        state_ = RUNNING;
+    }
+
+    uint32_t record_size = RECORD_HEADER + length;
+    if (record_size > CAPTURE_SIZE) {
+        return;
+    }
+    while (ring_->used_ + record_size > CAPTURE_SIZE) {
+        ring_->drop_oldest();
+    }
+
+    uint8_t header[RECORD_HEADER] = {(uint8_t)timestamp, (uint8_t)(timestamp >> 8), (uint8_t)(timestamp >> 16), (uint8_t)(timestamp >> 24), direction, length};
+    ring_->write(header, RECORD_HEADER);
+    ring_->write(data, length);
+    ring_->records_++;
+
+    if (state_ == STOPPING) {
+        if (--frames_left_ == 0) {
+            state_ = STOPPED;
+        }
+    } else if ((stop_type_ != TYPE_NONE) && (type_id == stop_type_)) {
+        frames_left_ = stop_frames_;
+        state_       = (stop_frames_ == 0) ? STOPPED : STOPPING;
+    }
+}
+
+// copies into the ring, in at most two pieces
+void BusCapture::Ring::write(const uint8_t * data, const size_t length) {
+    size_t first = std::min(length, (size_t)(CAPTURE_SIZE - head_));
+    memcpy(&buffer_[head_], data, first);
+    if (first < length) {
+        memcpy(&buffer_[0], data + first, length - first);
+    }
+    head_ = (head_ + length) % CAPTURE_SIZE;
+    used_ += length;
+}
+
+void BusCapture::Ring::drop_oldest() {
+    size_t record_size = RECORD_HEADER + at(RECORD_HEADER - 1);
+    tail_              = (tail_ + record_size) % CAPTURE_SIZE;
+    used_ -= record_size;
+    records_--;
+    dropped_++;
+}
+
+// the download, as the chunks of a web response. index is the position in the whole download
+size_t BusCapture::Ring::read(uint8_t * buffer, const size_t max_len, const size_t index) const {
+    uint8_t header[HEADER_SIZE] = {'E',
+                                   'M',
+                                   'S',
+                                   'C',
+                                   VERSION,
+                                   EMSESP::txservice_.ems_bus_id(),
+                                   (uint8_t)(dropped_ ? 1 : 0),
+                                   0,
+                                   (uint8_t)records_,
+                                   (uint8_t)(records_ >> 8),
+                                   (uint8_t)(records_ >> 16),
+                                   (uint8_t)(records_ >> 24),
+                                   (uint8_t)dropped_,
+                                   (uint8_t)(dropped_ >> 8),
+                                   (uint8_t)(dropped_ >> 16),
+                                   (uint8_t)(dropped_ >> 24)};
+
+    size_t len = 0;
+    size_t pos = index;
+    while ((pos < HEADER_SIZE) && (len < max_len)) {
+        buffer[len++] = header[pos++];
+    }
+
+    // the records, from the oldest, in at most two pieces
+    while ((pos - HEADER_SIZE < used_) && (len < max_len)) {
+        size_t offset = (tail_ + pos - HEADER_SIZE) % CAPTURE_SIZE;
+        size_t n      = std::min(std::min(max_len - len, used_ - (pos - HEADER_SIZE)), (size_t)(CAPTURE_SIZE - offset));
+        memcpy(buffer + len, &buffer_[offset], n);
+        len += n;
+        pos += n;
+    }
+
+    return len;
+}
+
+void BusCapture::show(uuid::console::Shell & shell, const uint8_t last) const {
+    static const __FlashStringHelper * const states[] = {F("off"), F("waiting for its start type"), F("running"), F("stopping"), F("stopped")};
+
+    shell.printfln(F("Bus capture is %s"), uuid::read_flash_string(states[state_]).c_str());
+    if (!ring_) {
+        return;
+    }
+
+    const Ring & ring = *ring_;
+    shell.printfln(F(" %lu frames, %lu of %lu bytes, %lu dropped"),
+                   (unsigned long)ring.records_,
+                   (unsigned long)ring.used_,
+                   (unsigned long)CAPTURE_SIZE,
+                   (unsigned long)ring.dropped_);
+    if (start_type_ != TYPE_NONE) {
+        shell.printfln(F(" Started by type 0x%02lX"), (unsigned long)start_type_);
+    }
+    if (stop_type_ != TYPE_NONE) {
+        shell.printfln(F(" Stops %u frames after type 0x%02lX"), stop_frames_, (unsigned long)stop_type_);
+    }
+
+    // the last frames, the ring only has forward links so walk it from the oldest
+    uint32_t skip   = (ring.records_ > last) ? ring.records_ - last : 0;
+    size_t   offset = 0;
+    for (uint32_t i = 0; i < ring.records_; i++) {
+        uint8_t length = ring.at(offset + RECORD_HEADER - 1);
+        if (i >= skip) {
+            uint32_t timestamp = ring.at(offset) | (ring.at(offset + 1) << 8) | (ring.at(offset + 2) << 16) | ((uint32_t)ring.at(offset + 3) << 24);
+            uint8_t  data[256];
+            for (uint8_t j = 0; j < length; j++) {
+                data[j] = ring.at(offset + RECORD_HEADER + j);
+            }
+            shell.printfln(F(" %5lu.%06lu %s %s"),
+                           (unsigned long)(timestamp / 1000000),
+                           (unsigned long)(timestamp % 1000000),
+                           ring.at(offset + RECORD_HEADER - 2) == TX ? "Tx" : "Rx",
+                           Helpers::data_to_hex(data, length).c_str());
+        }
+        offset += RECORD_HEADER + length;
+    }
+}
+
+} // namespace emsesp
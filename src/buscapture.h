@@ -0,0 +1,119 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_BUSCAPTURE_H
+#define EMSESP_BUSCAPTURE_H
+
+#include <Arduino.h>
+
+#include <uuid/console.h>
+
+#include <memory>
+
+namespace emsesp {
+
+// records the raw frames going over the bus, in and out, into a fixed size ring in RAM. Nothing is formatted,
+// a frame costs a copy of its bytes. When the ring is full the oldest frames are dropped.
+// The capture can wait for a telegram type before it starts, and stop a number of frames after another type.
+// It's downloaded in binary from /rest/busCapture and turned into text with scripts/capture_convert.py
+//
+// the download is a 16 byte header followed by the records, oldest first, all little endian:
+//   header: "EMSC", version, our bus id, flags (bit 0 set if frames were dropped), 0, records (u32), dropped (u32)
+//   record: micros() (u32), direction (0 Rx, 1 Tx), length, the bytes of the frame as they were on the wire
+class BusCapture {
+  public:
+    static constexpr uint32_t TYPE_NONE = 0xFFFFFFFF; // can't be a type id, see BusAnalyser::type_id
+
+    enum State : uint8_t { OFF, ARMED, RUNNING, STOPPING, STOPPED };
+
+#if defined(ESP8266)
+    static constexpr size_t CAPTURE_SIZE = 2048; // about 100 telegrams
+#else
+    static constexpr size_t CAPTURE_SIZE = 16384;
+#endif
+
+    // the recorded frames. A download holds on to the ring it was given, which is never written again:
+    // the capture is stopped for it, and a new capture gets a new ring while the download still has the old one
+    class Ring {
+      public:
+        size_t read(uint8_t * buffer, const size_t max_len, const size_t index) const;
+
+      private:
+        friend class BusCapture;
+
+        void    write(const uint8_t * data, const size_t length);
+        void    drop_oldest();
+        uint8_t at(const size_t offset) const {
+            return buffer_[(tail_ + offset) % CAPTURE_SIZE];
+        }
+
+        uint8_t  buffer_[CAPTURE_SIZE];
+        size_t   head_    = 0; // where the next record goes
+        size_t   tail_    = 0; // the oldest record
+        size_t   used_    = 0; // bytes
+        uint32_t records_ = 0;
+        uint32_t dropped_ = 0;
+    };
+
+    void start(const uint32_t start_type = TYPE_NONE);
+    void stop_after(const uint32_t stop_type, const uint16_t frames);
+    void stop();
+    void clear();
+
+    // stops the capture and hands its ring to a download, nullptr if there is none
+    std::shared_ptr<const Ring> download();
+
+    // called for every frame, so only a compare when it's not capturing. time_us is when it was on the bus
+    inline void incoming(const uint8_t * data, const uint8_t length, const uint32_t time_us) {
+        if (state_ >= ARMED && state_ <= STOPPING) {
+            record(RX, data, length, time_us);
+        }
+    }
+
+    inline void outgoing(const uint8_t * data, const uint8_t length, const uint32_t time_us = ::micros()) {
+        if (state_ >= ARMED && state_ <= STOPPING) {
+            record(TX, data, length, time_us);
+        }
+    }
+
+    State state() const {
+        return state_;
+    }
+
+    void show(uuid::console::Shell & shell, const uint8_t last = 10) const;
+
+  private:
+    static constexpr uint8_t VERSION       = 1;
+    static constexpr uint8_t HEADER_SIZE   = 16;
+    static constexpr uint8_t RECORD_HEADER = 6; // timestamp, direction and length
+    static constexpr uint8_t RX            = 0;
+    static constexpr uint8_t TX            = 1;
+
+    void record(const uint8_t direction, const uint8_t * data, const uint8_t length, const uint32_t timestamp);
+
+    std::shared_ptr<Ring> ring_;
+    uint32_t              start_type_  = TYPE_NONE;
+    uint32_t              stop_type_   = TYPE_NONE;
+    uint16_t              stop_frames_ = 0;
+    uint16_t              frames_left_ = 0;
+    State                 state_       = OFF;
+};
+
+} // namespace emsesp
+
+#endif
@@ -87,7 +87,7 @@ bool Command::call(const uint8_t device_type, const char * cmd, const char * val
 // add a command to the list, which does not return json
 void Command::add(const uint8_t device_type, const uint8_t device_id, const __FlashStringHelper * cmd, cmdfunction_p cb) {
     // if the command already exists for that device type don't add it
-    if (find_command(device_type, uuid::read_flash_string(cmd).c_str()) != nullptr) {
+    if (find_command(device_type, FlashStringView(cmd)) != nullptr) {
         return;
     }
     cmdfunctions_.emplace_back(device_type, cmd, cb, nullptr);
@@ -101,7 +101,7 @@ void Command::add(const uint8_t device_type, const uint8_t device_id, const __Fl
 // add a command to the list, which does return json object as output
 void Command::add_with_json(const uint8_t device_type, const __FlashStringHelper * cmd, cmdfunction_json_p cb) {
     // if the command already exists for that device type don't add it
-    if (find_command(device_type, uuid::read_flash_string(cmd).c_str()) != nullptr) {
+    if (find_command(device_type, FlashStringView(cmd)) != nullptr) {
         return;
     }
 
@@ -130,6 +130,17 @@ Command::CmdFunction * Command::find_command(const uint8_t device_type, const ch
     return nullptr; // command not found
 }
 
+// same, for a command name that is already lowercase in flash
+Command::CmdFunction * Command::find_command(const uint8_t device_type, const FlashStringView & cmd) {
+    for (auto & cf : cmdfunctions_) {
+        if ((cf.device_type_ == device_type) && (cmd == FlashStringView(cf.cmd_))) {
+            return &cf;
+        }
+    }
+
+    return nullptr; // command not found
+}
+
 // output list of all commands to console for a specific DeviceType
 void Command::show(uuid::console::Shell & shell, uint8_t device_type) {
     if (commands().empty()) {
@@ -27,6 +27,7 @@
 #include <functional>
 
 #include "console.h"
+#include "flashstring.h"
 
 #include <uuid/log.h>
 
@@ -63,6 +64,7 @@ class Command {
     static void                   add_with_json(const uint8_t device_type, const __FlashStringHelper * cmd, cmdfunction_json_p cb);
     static void                   show_all(uuid::console::Shell & shell);
     static Command::CmdFunction * find_command(const uint8_t device_type, const char * cmd);
+    static Command::CmdFunction * find_command(const uint8_t device_type, const FlashStringView & cmd);
 
     static void show(uuid::console::Shell & shell, uint8_t device_type);
     static void show_devices(uuid::console::Shell & shell);
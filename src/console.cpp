@@ -131,6 +131,33 @@ void EMSESPShell::add_console_commands() {
                           flash_string_vector{F_(show), F_(ems)},
                           [](Shell & shell, const std::vector<std::string> & arguments __attribute__((unused))) { EMSESP::show_ems(shell); });
 
+    commands->add_command(ShellContext::MAIN,
+                          CommandFlags::USER,
+                          flash_string_vector{F_(show), F_(bus)},
+                          [](Shell & shell, const std::vector<std::string> & arguments __attribute__((unused))) { EMSESP::busanalyser_.show(shell); });
+
+    commands->add_command(ShellContext::MAIN,
+                          CommandFlags::USER,
+                          flash_string_vector{F_(show), F_(tasks)},
+                          [](Shell & shell, const std::vector<std::string> & arguments __attribute__((unused))) { EMSESP::scheduler_.show(shell); });
+
+    commands->add_command(ShellContext::MAIN,
+                          CommandFlags::USER,
+                          flash_string_vector{F_(show), F_(history)},
+                          [](Shell & shell, const std::vector<std::string> & arguments __attribute__((unused))) { EMSESP::history_.show(shell); });
+
+    commands->add_command(ShellContext::MAIN,
+                          CommandFlags::USER,
+                          flash_string_vector{F_(show), F_(stats)},
+                          [](Shell & shell, const std::vector<std::string> & arguments __attribute__((unused))) { EMSESP::show_statistics(shell); });
+
+#if defined(EMSESP_HEAP_PROFILER)
+    commands->add_command(ShellContext::MAIN,
+                          CommandFlags::USER,
+                          flash_string_vector{F_(show), F_(heap)},
+                          [](Shell & shell, const std::vector<std::string> & arguments __attribute__((unused))) { HeapProfiler::show(shell); });
+#endif
+
     commands->add_command(ShellContext::MAIN,
                           CommandFlags::USER,
                           flash_string_vector{F_(show), F_(values)},
@@ -355,6 +382,33 @@ void EMSESPShell::add_console_commands() {
                               }
                           });
 
+    // capture on [ID] starts, at the first telegram of type ID if given
+    // capture stop <ID> [n] stops n frames after a telegram of type ID, capture off stops now
+    // a stopped capture keeps its frames for the download, capture clear frees them
+    commands->add_command(ShellContext::MAIN,
+                          CommandFlags::USER,
+                          flash_string_vector{F_(capture)},
+                          flash_string_vector{F_(capture_optional), F_(watchid_optional), F_(frames_optional)},
+                          [](Shell & shell, const std::vector<std::string> & arguments) {
+                              if (!arguments.empty()) {
+                                  uint32_t type_id = (arguments.size() > 1) ? Helpers::hextoint(arguments[1].c_str()) : BusCapture::TYPE_NONE;
+                                  if (arguments[0] == read_flash_string(F_(on))) {
+                                      EMSESP::buscapture_.start(type_id);
+                                  } else if (arguments[0] == read_flash_string(F_(off))) {
+                                      EMSESP::buscapture_.stop();
+                                  } else if (arguments[0] == read_flash_string(F_(stop)) && (arguments.size() > 1)) {
+                                      EMSESP::buscapture_.stop_after(type_id, (arguments.size() > 2) ? Helpers::atoint(arguments[2].c_str()) : 0);
+                                  } else if (arguments[0] == read_flash_string(F_(clear))) {
+                                      EMSESP::buscapture_.clear();
+                                  } else {
+                                      shell.printfln(F("Invalid capture command"));
+                                      return;
+                                  }
+                              }
+
+                              EMSESP::buscapture_.show(shell);
+                          });
+
     commands->add_command(
         ShellContext::MAIN,
         CommandFlags::ADMIN,
@@ -388,8 +442,8 @@ void EMSESPShell::add_console_commands() {
                 return;
             }
 
-            DynamicJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
-            JsonObject          json = doc.to<JsonObject>();
+            PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+            JsonObject         json = doc.to<JsonObject>();
 
             bool ok = false;
             if (arguments.size() == 2) {
@@ -408,7 +462,6 @@ void EMSESPShell::add_console_commands() {
             }
 
             if (ok && json.size()) {
-                doc.shrinkToFit();
                 serializeJsonPretty(doc, shell);
                 shell.println();
             }
@@ -682,6 +735,7 @@ void Console::start() {
 #if defined(EMSESP_STANDALONE)
     // always start in su/admin mode when running tests
     shell->add_flags(CommandFlags::ADMIN);
+    atexit(stop);
 #endif
 
 // start the telnet service
@@ -697,6 +751,18 @@ void Console::start() {
     // emsesp::EMSESP::watch(EMSESP::WATCH_OFF);
 }
 
+#if defined(EMSESP_STANDALONE)
+// the shell is a log handler, so it has to be gone before the handler list of uuid-log is destroyed at exit
+// this is registered with atexit() after that list was constructed, so it's called before the list's destructor
+void Console::stop() {
+    if (shell) {
+        shell->stop();
+        Shell::loop_all(); // takes it out of the running shells
+        shell.reset();
+    }
+}
+#endif
+
 // handles telnet sync and logging to console
 void Console::loop() {
     uuid::loop();
@@ -129,6 +129,10 @@ class Console {
     void loop();
     void start();
 
+#if defined(EMSESP_STANDALONE)
+    static void stop();
+#endif
+
     uuid::log::Level log_level();
 
     static void enter_custom_context(Shell & shell, unsigned int context);
@@ -35,11 +35,9 @@ uuid::log::Logger DallasSensor::logger_{F_(dallassensor), uuid::log::Facility::D
 void DallasSensor::start() {
     reload();
 
-#ifndef EMSESP_STANDALONE
     if (dallas_gpio_) {
         bus_.begin(dallas_gpio_);
     }
-#endif
 
     // API call
     Command::add_with_json(EMSdevice::DeviceType::DALLASSENSOR, F_(info), [&](const char * value, const int8_t id, JsonObject & json) {
@@ -60,9 +58,14 @@ void DallasSensor::reload() {
     }
 }
 
+// a reading starts the conversion on all sensors, then the known sensors are read one per pass by their address.
+// A full search of the bus, that reads the sensors as it finds them, is only done at the start, now and then
+// for new sensors and after a sensor couldn't be read, not more than every 30 seconds then
 void DallasSensor::loop() {
-#ifndef EMSESP_STANDALONE
-    uint32_t time_now = uuid::get_uptime();
+    uint32_t time_now  = uuid::get_uptime();
+    bool     unread    = changed_; // changes no one has taken yet
+    uint8_t  old_count = sensors_.size();
+    changed_           = false;
 
     if (state_ == State::IDLE) {
         if (time_now - last_activity_ >= READ_INTERVAL_MS) {
@@ -82,6 +85,7 @@ void DallasSensor::loop() {
                         LOG_ERROR(F("Bus reset failed"));
                         for (auto & sensor : sensors_) {
                             sensor.temperature_c = EMS_VALUE_SHORT_NOTSET;
+                            sensor.filter.update(sensor.temperature_c);
                         }
                     }
                 }
@@ -90,9 +94,17 @@ void DallasSensor::loop() {
         }
     } else if (state_ == State::READING) {
         if (temperature_convert_complete() && (time_now - last_activity_ > CONVERSION_MS)) {
-            // LOG_DEBUG(F("Scanning for sensors")); // uncomment for debug
-            bus_.reset_search();
-            state_ = State::SCANNING;
+            uint32_t since_search = time_now - last_search_;
+            if ((scancnt_ < 0) || sensors_.empty() || (since_search >= SEARCH_INTERVAL_MS) || (search_ && (since_search >= SEARCH_RETRY_MS))) {
+                // LOG_DEBUG(F("Scanning for sensors")); // uncomment for debug
+                bus_.reset_search();
+                last_search_ = time_now;
+                search_      = false;
+                state_       = State::SCANNING;
+            } else {
+                next_sensor_ = 0;
+                state_       = State::READING_KNOWN;
+            }
         } else if (time_now - last_activity_ > READ_TIMEOUT_MS) {
             LOG_WARNING(F("Dallas sensor read timeout"));
             state_ = State::IDLE;
@@ -123,10 +135,10 @@ void DallasSensor::loop() {
                             bool found = false;
                             for (auto & sensor : sensors_) {
                                 if (sensor.id() == get_id(addr)) {
-                                    changed_ |= (t != sensor.temperature_c);
                                     sensor.temperature_c = t;
                                     sensor.read          = true;
                                     found                = true;
+                                    changed_ |= sensor.filter.update(sensor.temperature_c);
                                     break;
                                 }
                             }
@@ -136,6 +148,7 @@ void DallasSensor::loop() {
                                 sensors_.back().temperature_c = t;
                                 sensors_.back().read          = true;
                                 changed_                      = true;
+                                sensors_.back().filter.update(sensors_.back().temperature_c);
                             }
                         } else {
                             sensorfails_++;
@@ -152,49 +165,74 @@ void DallasSensor::loop() {
                     LOG_ERROR(F("Invalid dallas sensor %s"), Sensor(addr).to_string().c_str());
                 }
             } else {
-                if (!parasite_) {
-                    bus_.depower();
-                }
-                // check for missing sensors after some samples
-                if (++scancnt_ > SCAN_MAX) {
-                    for (auto & sensor : sensors_) {
-                        if (!sensor.read) {
-                            sensor.temperature_c = EMS_VALUE_SHORT_NOTSET;
-                            changed_             = true;
-                        }
-                        sensor.read = false;
-                    }
-                    scancnt_ = 0;
-                } else if (scancnt_ == SCAN_START + 1) { // startup
-                    firstscan_ = sensors_.size();
-                    LOG_DEBUG(F("Adding %d dallassensor(s) from first scan"), firstscan_);
-                } else if ((scancnt_ <= 0) && (firstscan_ != sensors_.size())) { // check 2 times for no change of sensor #
-                    scancnt_ = SCAN_START;
-                    sensors_.clear(); // restart scaning and clear to get correct numbering
-                }
-                state_ = State::IDLE;
+                end_cycle();
+            }
+        }
+    } else if (state_ == State::READING_KNOWN) {
+        if (time_now - last_activity_ > SCAN_TIMEOUT_MS) {
+            LOG_ERROR(F("Dallas sensor read timeout"));
+            state_  = State::IDLE;
+            search_ = true;
+            sensorfails_++;
+        } else if (next_sensor_ < sensors_.size()) {
+            Sensor & sensor = sensors_[next_sensor_++];
+            int16_t  t      = get_temperature_c(sensor.addr());
+            if ((t >= -550) && (t <= 1250)) {
+                sensor.temperature_c = t;
+                sensor.read          = true;
+                changed_ |= sensor.filter.update(sensor.temperature_c);
+            } else {
+                sensorfails_++;
+                // it may have gone or the bus has a problem, one that's already missing is left to the next search
+                search_ |= Helpers::hasValue(sensor.temperature_c);
             }
+        } else {
+            end_cycle();
         }
     }
-#endif
+
+    // let the subscribers know of every change, one that couldn't publish the last one (e.g. MQTT was down) gets another go
+    bool changed = changed_;
+    changed_ |= unread;
+    if (changed) {
+        Events::emit(Events::SENSOR_VALUES, EMSdevice::DeviceType::DALLASSENSOR, 0, old_count, sensors_.size());
+    }
+}
+
+// after all sensors are read
+void DallasSensor::end_cycle() {
+    if (!parasite_) {
+        bus_.depower();
+    }
+    // check for missing sensors after some samples
+    if (++scancnt_ > SCAN_MAX) {
+        for (auto & sensor : sensors_) {
+            if (!sensor.read) {
+                sensor.temperature_c = EMS_VALUE_SHORT_NOTSET;
+                changed_             = true;
+                sensor.filter.update(sensor.temperature_c);
+            }
+            sensor.read = false;
+        }
+        scancnt_ = 0;
+    } else if (scancnt_ == SCAN_START + 1) { // startup
+        firstscan_ = sensors_.size();
+        LOG_DEBUG(F("Adding %d dallassensor(s) from first scan"), firstscan_);
+    } else if ((scancnt_ <= 0) && (firstscan_ != sensors_.size())) { // check 2 times for no change of sensor #
+        scancnt_ = SCAN_START;
+        sensors_.clear(); // restart scaning and clear to get correct numbering
+    }
+    state_ = State::IDLE;
 }
 
 bool DallasSensor::temperature_convert_complete() {
-#ifndef EMSESP_STANDALONE
     if (parasite_) {
         return true; // don't care, use the minimum time in loop
     }
     return bus_.read_bit() == 1;
-#else
-    return true;
-#endif
 }
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-parameter"
-
 int16_t DallasSensor::get_temperature_c(const uint8_t addr[]) {
-#ifndef EMSESP_STANDALONE
     if (!bus_.reset()) {
         LOG_ERROR(F("Bus reset failed before reading scratchpad from %s"), Sensor(addr).to_string().c_str());
         return EMS_VALUE_SHORT_NOTSET;
@@ -251,21 +289,18 @@ int16_t DallasSensor::get_temperature_c(const uint8_t addr[]) {
     }
     raw_value = ((int32_t)raw_value * 625 + 500) / 1000; // round to 0.1
     return raw_value;
-#else
-    return EMS_VALUE_SHORT_NOTSET;
-#endif
 }
 
-#pragma GCC diagnostic pop
-
 const std::vector<DallasSensor::Sensor> DallasSensor::sensors() const {
     return sensors_;
 }
 
 // skip crc from id.
 DallasSensor::Sensor::Sensor(const uint8_t addr[])
-    : id_(((uint64_t)addr[0] << 48) | ((uint64_t)addr[1] << 40) | ((uint64_t)addr[2] << 32) | ((uint64_t)addr[3] << 24) | ((uint64_t)addr[4] << 16)
+    : filter(F_(filter_sensorTemp))
+    , id_(((uint64_t)addr[0] << 48) | ((uint64_t)addr[1] << 40) | ((uint64_t)addr[2] << 32) | ((uint64_t)addr[3] << 24) | ((uint64_t)addr[4] << 16)
           | ((uint64_t)addr[5] << 8) | ((uint64_t)addr[6])) {
+    memcpy(addr_, addr, sizeof(addr_));
 }
 
 uint64_t DallasSensor::get_id(const uint8_t addr[]) {
@@ -317,7 +352,7 @@ bool DallasSensor::export_values(JsonObject & json) {
         JsonObject dataSensor = json.createNestedObject(sensorID);
         dataSensor["id"]      = sensor.to_string();
         if (Helpers::hasValue(sensor.temperature_c)) {
-            dataSensor["temp"] = (float)(sensor.temperature_c) / 10;
+            dataSensor["temp"] = FixedPoint(sensor.temperature_c, 10).json();
         }
     }
 
@@ -332,9 +367,9 @@ void DallasSensor::publish_values(const bool force) {
         return;
     }
 
-    DynamicJsonDocument doc(100 * num_sensors);
-    uint8_t             sensor_no    = 1;
-    uint8_t             mqtt_format_ = Mqtt::mqtt_format();
+    PooledJsonDocument doc(100 * num_sensors);
+    uint8_t            sensor_no    = 1;
+    uint8_t            mqtt_format_ = Mqtt::mqtt_format();
 
     for (const auto & sensor : sensors_) {
         char sensorID[10]; // sensor{1-n}
@@ -342,14 +377,14 @@ void DallasSensor::publish_values(const bool force) {
         if (mqtt_format_ == Mqtt::Format::SINGLE) {
             // e.g. dallassensor_data = {"28-EA41-9497-0E03":23.3,"28-233D-9497-0C03":24.0}
             if (Helpers::hasValue(sensor.temperature_c)) {
-                doc[sensor.to_string()] = (float)(sensor.temperature_c) / 10;
+                doc[sensor.to_string()] = FixedPoint(sensor.temperature_c, 10).json();
             }
         } else {
             // e.g. dallassensor_data = {"sensor1":{"id":"28-EA41-9497-0E03","temp":23.3},"sensor2":{"id":"28-233D-9497-0C03","temp":24.0}}
             JsonObject dataSensor = doc.createNestedObject(sensorID);
             dataSensor["id"]      = sensor.to_string();
             if (Helpers::hasValue(sensor.temperature_c)) {
-                dataSensor["temp"] = (float)(sensor.temperature_c) / 10;
+                dataSensor["temp"] = FixedPoint(sensor.temperature_c, 10).json();
             }
         }
 
@@ -357,7 +392,7 @@ void DallasSensor::publish_values(const bool force) {
         // to e.g. homeassistant/sensor/ems-esp/dallas_28-233D-9497-0C03/config
         if (mqtt_format_ == Mqtt::Format::HA) {
             if (!(registered_ha_[sensor_no - 1]) || force) {
-                StaticJsonDocument<EMSESP_MAX_JSON_SIZE_MEDIUM> config;
+                PooledJsonDocument config(EMSESP_MAX_JSON_SIZE_MEDIUM);
                 config["dev_cla"] = FJSON("temperature");
 
                 char stat_t[128];
@@ -390,8 +425,6 @@ void DallasSensor::publish_values(const bool force) {
         }
         sensor_no++; // increment sensor count
     }
-
-    doc.shrinkToFit();
     Mqtt::publish(F("dallassensor_data"), doc.as<JsonObject>());
 }
 
@@ -27,12 +27,11 @@
 #include "helpers.h"
 #include "mqtt.h"
 #include "console.h"
+#include "valuefilter.h"
 
 #include <uuid/log.h>
 
-#ifndef EMSESP_STANDALONE
 #include <OneWire.h>
-#endif
 
 namespace emsesp {
 
@@ -43,14 +42,19 @@ class DallasSensor {
         Sensor(const uint8_t addr[]);
         ~Sensor() = default;
 
-        uint64_t    id() const;
-        std::string to_string() const;
+        uint64_t        id() const;
+        std::string     to_string() const;
+        const uint8_t * addr() const {
+            return addr_;
+        }
 
-        int16_t temperature_c = EMS_VALUE_SHORT_NOTSET;
-        bool    read          = false;
+        int16_t     temperature_c = EMS_VALUE_SHORT_NOTSET;
+        bool        read          = false;
+        ValueFilter filter;
 
       private:
         const uint64_t id_;
+        uint8_t        addr_[8]; // with the CRC, to select it on the bus
     };
 
     DallasSensor()  = default;
@@ -71,7 +75,7 @@ class DallasSensor {
   private:
     static constexpr uint8_t MAX_SENSORS = 20;
 
-    enum class State { IDLE, READING, SCANNING };
+    enum class State { IDLE, READING, SCANNING, READING_KNOWN };
 
     static constexpr size_t ADDR_LEN = 8;
 
@@ -87,10 +91,12 @@ class DallasSensor {
     static constexpr uint8_t TYPE_DS1822  = 0x22;
     static constexpr uint8_t TYPE_DS1825  = 0x3B; // also DS1826
 
-    static constexpr uint32_t READ_INTERVAL_MS = 5000; // 5 seconds
-    static constexpr uint32_t CONVERSION_MS    = 1000; // 1 seconds
-    static constexpr uint32_t READ_TIMEOUT_MS  = 2000; // 2 seconds
-    static constexpr uint32_t SCAN_TIMEOUT_MS  = 3000; // 3 seconds
+    static constexpr uint32_t READ_INTERVAL_MS   = 5000;  // 5 seconds
+    static constexpr uint32_t CONVERSION_MS      = 1000;  // 1 seconds
+    static constexpr uint32_t READ_TIMEOUT_MS    = 2000;  // 2 seconds
+    static constexpr uint32_t SCAN_TIMEOUT_MS    = 3000;  // 3 seconds
+    static constexpr uint32_t SEARCH_INTERVAL_MS = 60000; // 1 minute, between full searches for new sensors
+    static constexpr uint32_t SEARCH_RETRY_MS    = 30000; // 30 seconds, between searches after a sensor couldn't be read
 
     static constexpr uint8_t CMD_CONVERT_TEMP    = 0x44;
     static constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
@@ -100,10 +106,9 @@ class DallasSensor {
 
     static uuid::log::Logger logger_;
 
-#ifndef EMSESP_STANDALONE
     OneWire bus_;
-#endif
 
+    void     end_cycle();
     bool     temperature_convert_complete();
     int16_t  get_temperature_c(const uint8_t addr[]);
     uint64_t get_id(const uint8_t addr[]);
@@ -121,6 +126,9 @@ class DallasSensor {
     int8_t   scancnt_     = SCAN_START;
     uint8_t  firstscan_   = 0;
     uint8_t  scanretry_   = 0;
+    uint8_t  next_sensor_ = 0; // the known sensors are read one per pass
+    uint32_t last_search_ = 0;
+    bool     search_      = false; // a full search with the next reading, after a bus error
     uint8_t  dallas_gpio_ = 0;
     bool     parasite_    = false;
     bool     changed_     = false;
@@ -107,7 +107,7 @@ void Boiler::register_mqtt_ha_config() {
     }
 
     // Create the Master device
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_HA_CONFIG> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
     doc["name"]    = FJSON("Service Code");
     doc["uniq_id"] = FJSON("boiler");
     doc["ic"]      = FJSON("mdi:home-thermometer-outline");
@@ -371,8 +371,8 @@ void Boiler::register_mqtt_ha_config_ww() {
 // send stuff to the Web UI
 void Boiler::device_info_web(JsonArray & root, uint8_t & part) {
     // fetch the values into a JSON document
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_LARGE> doc;
-    JsonObject                                     json = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE);
+    JsonObject         json = doc.to<JsonObject>();
     if (part == 0) {
         part = 1; // we have another part
         if (!export_values_main(json, true)) {
@@ -492,9 +492,28 @@ bool Boiler::export_values(JsonObject & json, int8_t id) {
     return true;
 }
 
+bool Boiler::export_metrics(MetricsObject & json) {
+    if (!export_values_main(json)) {
+        return false;
+    }
+    export_values_ww(json);
+    export_values_info(json);
+    return true;
+}
+
+bool Boiler::export_statistics(JsonObject & json) {
+    uint32_t now = uuid::get_uptime();
+    burnGasStat_.add_json(json, now);
+    burnStartsStat_.add_json(json, now);
+    curBurnPowStat_.add_json(json, now);
+    wWCurFlowStat_.add_json(json, now);
+    return json.size();
+}
+
 // creates JSON doc from values
 // returns false if empty
-bool Boiler::export_values_ww(JsonObject & json, const bool textformat) {
+template <typename Json>
+bool Boiler::export_values_ww(Json & json, const bool textformat) {
     char s[10]; // for formatting strings
 
     // Warm Water comfort setting
@@ -549,27 +568,27 @@ bool Boiler::export_values_ww(JsonObject & json, const bool textformat) {
 
     // Warm Water current temperature (intern)
     if (Helpers::hasValue(wWCurTemp_)) {
-        json["wWCurTemp"] = (float)wWCurTemp_ / 10;
+        json["wWCurTemp"] = FixedPoint(wWCurTemp_, 10).json();
     }
 
     // Warm Water current temperature (extern)
     if (Helpers::hasValue(wWCurTemp2_)) {
-        json["wWCurTemp2"] = (float)wWCurTemp2_ / 10;
+        json["wWCurTemp2"] = FixedPoint(wWCurTemp2_, 10).json();
     }
 
     // Warm Water current tap water flow l/min
     if (Helpers::hasValue(wWCurFlow_)) {
-        json["wWCurFlow"] = (float)wWCurFlow_ / 10;
+        json["wWCurFlow"] = FixedPoint(wWCurFlow_, 10).json();
     }
 
     // Warm water storage temperature (intern)
     if (Helpers::hasValue(wWStorageTemp1_)) {
-        json["wWStorageTemp1"] = (float)wWStorageTemp1_ / 10;
+        json["wWStorageTemp1"] = FixedPoint(wWStorageTemp1_, 10).json();
     }
 
     // Warm water storage temperature (extern)
     if (Helpers::hasValue(wWStorageTemp2_)) {
-        json["wWStorageTemp2"] = (float)wWStorageTemp2_ / 10;
+        json["wWStorageTemp2"] = FixedPoint(wWStorageTemp2_, 10).json();
     }
 
     // Warm Water activated bool
@@ -619,7 +638,8 @@ bool Boiler::export_values_ww(JsonObject & json, const bool textformat) {
 
 // creates JSON doc from values
 // returns false if empty
-bool Boiler::export_values_main(JsonObject & json, const bool textformat) {
+template <typename Json>
+bool Boiler::export_values_main(Json & json, const bool textformat) {
     // Hot tap water bool
     Helpers::json_boolean(json, "heatingActive", heatingActive_);
 
@@ -653,47 +673,47 @@ bool Boiler::export_values_main(JsonObject & json, const bool textformat) {
 
     // Outside temperature
     if (Helpers::hasValue(outdoorTemp_)) {
-        json["outdoorTemp"] = (float)outdoorTemp_ / 10;
+        json["outdoorTemp"] = FixedPoint(outdoorTemp_, 10).json();
     }
 
     // Current flow temperature
     if (Helpers::hasValue(curFlowTemp_)) {
-        json["curFlowTemp"] = (float)curFlowTemp_ / 10;
+        json["curFlowTemp"] = FixedPoint(curFlowTemp_, 10).json();
     }
 
     // Return temperature, with no sensor retTemp can be 0x8000 or 0x0000
     if (Helpers::hasValue(retTemp_) && (retTemp_ > 0)) {
-        json["retTemp"] = (float)retTemp_ / 10;
+        json["retTemp"] = FixedPoint(retTemp_, 10).json();
     }
 
     // Mixing switch temperature
     if (Helpers::hasValue(switchTemp_)) {
-        json["switchTemp"] = (float)switchTemp_ / 10;
+        json["switchTemp"] = FixedPoint(switchTemp_, 10).json();
     }
 
     // Mixer temperature
     if (Helpers::hasValue(mixerTemp_)) {
-        json["mixerTemp"] = (float)mixerTemp_ / 10;
+        json["mixerTemp"] = FixedPoint(mixerTemp_, 10).json();
     }
 
     // tank middle temperature (TS3)
     if (Helpers::hasValue(tankMiddleTemp_)) {
-        json["tankMiddleTemp"] = (float)tankMiddleTemp_ / 10;
+        json["tankMiddleTemp"] = FixedPoint(tankMiddleTemp_, 10).json();
     }
 
     // System pressure
     if (Helpers::hasValue(sysPress_)) {
-        json["sysPress"] = (float)sysPress_ / 10;
+        json["sysPress"] = FixedPoint(sysPress_, 10).json();
     }
 
     // Max boiler temperature
     if (Helpers::hasValue(boilTemp_)) {
-        json["boilTemp"] = (float)boilTemp_ / 10;
+        json["boilTemp"] = FixedPoint(boilTemp_, 10).json();
     }
 
     // Exhaust temperature
     if (Helpers::hasValue(exhaustTemp_)) {
-        json["exhaustTemp"] = (float)exhaustTemp_ / 10;
+        json["exhaustTemp"] = FixedPoint(exhaustTemp_, 10).json();
     }
 
     // Gas bool
@@ -701,7 +721,7 @@ bool Boiler::export_values_main(JsonObject & json, const bool textformat) {
 
     // Flame current uA
     if (Helpers::hasValue(flameCurr_)) {
-        json["flameCurr"] = (float)(int16_t)flameCurr_ / 10;
+        json["flameCurr"] = FixedPoint((int16_t)flameCurr_, 10).json();
     }
 
     // Heating pump bool
@@ -837,7 +857,8 @@ bool Boiler::export_values_main(JsonObject & json, const bool textformat) {
 }
 
 // creates JSON doc from values,  returns false if empty
-bool Boiler::export_values_info(JsonObject & json, const bool textformat) {
+template <typename Json>
+bool Boiler::export_values_info(Json & json, const bool textformat) {
     // Total heat operating time
     Helpers::json_time(json, "upTimeControl", upTimeControl_ / 60, textformat);
 
@@ -964,8 +985,8 @@ void Boiler::publish_values(JsonObject & json, bool force) {
         }
     }
 
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_LARGE> doc;
-    JsonObject                                     json_data = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE);
+    JsonObject         json_data = doc.to<JsonObject>();
     if (export_values_main(json_data)) {
         Mqtt::publish(F("boiler_data"), json_data);
     }
@@ -1046,29 +1067,15 @@ void Boiler::process_UBAParameterWW(std::shared_ptr<const Telegram> telegram) {
 
 // 0x18
 void Boiler::process_UBAMonitorFast(std::shared_ptr<const Telegram> telegram) {
-    changed_ |= telegram->read_value(selFlowTemp_, 0);
-    changed_ |= telegram->read_value(curFlowTemp_, 1);
-    changed_ |= telegram->read_value(selBurnPow_, 3); // burn power max setting
-    changed_ |= telegram->read_value(curBurnPow_, 4);
-    changed_ |= telegram->read_value(boilerState_, 5);
-
-    changed_ |= telegram->read_bitvalue(burnGas_, 7, 0);
-    changed_ |= telegram->read_bitvalue(fanWork_, 7, 2);
-    changed_ |= telegram->read_bitvalue(ignWork_, 7, 3);
-    changed_ |= telegram->read_bitvalue(heatingPump_, 7, 5);
-    changed_ |= telegram->read_bitvalue(wWHeat_, 7, 6);
-    changed_ |= telegram->read_bitvalue(wWCirc_, 7, 7);
-
-    // warm water storage sensors (if present)
     // wWStorageTemp2 is also used by some brands as the boiler temperature - see https://github.com/emsesp/EMS-ESP/issues/206
-    changed_ |= telegram->read_value(wWStorageTemp1_, 9);  // 0x8300 if not available
-    changed_ |= telegram->read_value(wWStorageTemp2_, 11); // 0x8000 if not available - this is boiler temp
-
-    changed_ |= telegram->read_value(retTemp_, 13);
-    changed_ |= telegram->read_value(flameCurr_, 15);
-
-    // system pressure. FF means missing
-    changed_ |= telegram->read_value(sysPress_, 17); // is *10
+    // curFlowTemp_, retTemp_ and flameCurr_ are filtered fields, their changes are registered by their filters
+    uint32_t changes = UBAMonitorFast::decode(*this, *telegram);
+    changed_ |= ((changes & ~UBAMonitorFast::filtered) != 0);
+    changed_ |= curFlowTempFilter_.update(curFlowTemp_);
+    changed_ |= retTempFilter_.update(retTemp_);
+    changed_ |= flameCurrFilter_.update(flameCurr_);
+    burnGasStat_.update(burnGas_);
+    curBurnPowStat_.update(curBurnPow_);
 
     // read the service code / installation status as appears on the display
     if ((telegram->message_length > 18) && (telegram->offset == 0)) {
@@ -1077,8 +1084,6 @@ void Boiler::process_UBAMonitorFast(std::shared_ptr<const Telegram> telegram) {
         serviceCode_[2] = '\0'; // null terminate string
     }
 
-    changed_ |= telegram->read_value(serviceCodeNumber_, 20);
-
     // at this point do a quick check to see if the hot water or heating is active
     check_active();
 }
@@ -1125,6 +1130,7 @@ void Boiler::process_UBAMonitorWW(std::shared_ptr<const Telegram> telegram) {
     changed_ |= telegram->read_value(wWCurTemp2_, 3);
     changed_ |= telegram->read_value(wWCurFlow_, 9);
     changed_ |= telegram->read_value(wWType_, 8);
+    wWCurFlowStat_.update(wWCurFlow_);
 
     changed_ |= telegram->read_value(wWWorkM_, 10, 3);  // force to 3 bytes
     changed_ |= telegram->read_value(wWStarts_, 13, 3); // force to 3 bytes
@@ -1152,10 +1158,15 @@ void Boiler::process_UBAMonitorFastPlus(std::shared_ptr<const Telegram> telegram
     changed_ |= telegram->read_bitvalue(wWHeat_, 11, 2);
     changed_ |= telegram->read_value(curBurnPow_, 10);
     changed_ |= telegram->read_value(selBurnPow_, 9);
-    changed_ |= telegram->read_value(curFlowTemp_, 7);
-    changed_ |= telegram->read_value(flameCurr_, 19);
-    changed_ |= telegram->read_value(retTemp_, 17); // can be 0 if no sensor, handled in export_values
+    telegram->read_value(curFlowTemp_, 7);
+    telegram->read_value(flameCurr_, 19);
+    telegram->read_value(retTemp_, 17); // can be 0 if no sensor, handled in export_values
+    changed_ |= curFlowTempFilter_.update(curFlowTemp_);
+    changed_ |= flameCurrFilter_.update(flameCurr_);
+    changed_ |= retTempFilter_.update(retTemp_);
     changed_ |= telegram->read_value(sysPress_, 21);
+    burnGasStat_.update(burnGas_);
+    curBurnPowStat_.update(curBurnPow_);
 
     //changed_ |= telegram->read_value(temperature_, 13); // unknown temperature
     //changed_ |= telegram->read_value(temperature_, 27); // unknown temperature
@@ -1194,6 +1205,7 @@ void Boiler::process_UBAMonitorSlow(std::shared_ptr<const Telegram> telegram) {
     changed_ |= telegram->read_value(switchTemp_, 25); // only if there is a mixer module present
     changed_ |= telegram->read_value(heatingPumpMod_, 9);
     changed_ |= telegram->read_value(burnStarts_, 10, 3);  // force to 3 bytes
+    burnStartsStat_.update(burnStarts_);
     changed_ |= telegram->read_value(burnWorkMin_, 13, 3); // force to 3 bytes
     changed_ |= telegram->read_value(heatWorkMin_, 19, 3); // force to 3 bytes
 }
@@ -1218,6 +1230,7 @@ void Boiler::process_UBAMonitorSlowPlus(std::shared_ptr<const Telegram> telegram
     changed_ |= telegram->read_bitvalue(wWCirc_, 2, 7);
     changed_ |= telegram->read_value(exhaustTemp_, 6);
     changed_ |= telegram->read_value(burnStarts_, 10, 3);  // force to 3 bytes
+    burnStartsStat_.update(burnStarts_);
     changed_ |= telegram->read_value(burnWorkMin_, 13, 3); // force to 3 bytes
     changed_ |= telegram->read_value(heatWorkMin_, 19, 3); // force to 3 bytes
     changed_ |= telegram->read_value(heatingPumpMod_, 25);
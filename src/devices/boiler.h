@@ -31,6 +31,8 @@
 #include "emsesp.h"
 #include "helpers.h"
 #include "mqtt.h"
+#include "valuefilter.h"
+#include "statistics.h"
 
 namespace emsesp {
 
@@ -41,6 +43,8 @@ class Boiler : public EMSdevice {
     virtual void publish_values(JsonObject & json, bool force);
     virtual bool export_values(JsonObject & json, int8_t id = -1);
     virtual void device_info_web(JsonArray & root, uint8_t & part);
+    virtual bool export_statistics(JsonObject & json);
+    virtual bool export_metrics(MetricsObject & json);
     virtual bool updated_values();
 
   private:
@@ -54,9 +58,12 @@ class Boiler : public EMSdevice {
     void register_mqtt_ha_config();
     void register_mqtt_ha_config_ww();
     void check_active(const bool force = false);
-    bool export_values_main(JsonObject & doc, const bool textformat = false);
-    bool export_values_ww(JsonObject & doc, const bool textformat = false);
-    bool export_values_info(JsonObject & doc, const bool textformat = false);
+    template <typename Json>
+    bool export_values_main(Json & doc, const bool textformat = false);
+    template <typename Json>
+    bool export_values_ww(Json & doc, const bool textformat = false);
+    template <typename Json>
+    bool export_values_info(Json & doc, const bool textformat = false);
 
     bool changed_           = false;
     bool mqtt_ha_config_    = false; // HA MQTT Discovery
@@ -109,6 +116,17 @@ class Boiler : public EMSdevice {
     char     lastCode_[30]      = {'\0'};
     uint32_t lastCodeDate_      = 0;
 
+    // the noisy values, their changes are registered through a filter
+    ValueFilter curFlowTempFilter_{F_(filter_curFlowTemp)};
+    ValueFilter retTempFilter_{F_(filter_retTemp)};
+    ValueFilter flameCurrFilter_{F_(filter_flameCurr)};
+
+    // figures over the last hour, published at a low rate instead of the raw values at a high one
+    Statistic burnGasStat_{"burnGas", Statistic::Kind::ON_TIME};
+    Statistic burnStartsStat_{"burnStarts", Statistic::Kind::STARTS};
+    Statistic curBurnPowStat_{"curBurnPow", Statistic::Kind::LEVEL};
+    Statistic wWCurFlowStat_{"wWCurFlow", Statistic::Kind::VOLUME};
+
     // UBAMonitorSlow - 0x19 on EMS1
     int16_t  outdoorTemp_    = EMS_VALUE_SHORT_NOTSET;  // Outside temperature
     uint16_t boilTemp_       = EMS_VALUE_USHORT_NOTSET; // Boiler temperature
@@ -234,6 +252,25 @@ class Boiler : public EMSdevice {
     bool set_pump_delay(const char * value, const int8_t id);
     // bool set_reset(const char * value, const int8_t id);
     bool set_maintenance(const char * value, const int8_t id);
+
+    // telegram layouts
+    using UBAMonitorFast = TelegramSchema<EMS_FIELD(Boiler, selFlowTemp_, 0),
+                                          EMS_FIELD_FILTERED(Boiler, curFlowTemp_, 1),
+                                          EMS_FIELD(Boiler, selBurnPow_, 3), // burn power max setting
+                                          EMS_FIELD(Boiler, curBurnPow_, 4),
+                                          EMS_FIELD(Boiler, boilerState_, 5),
+                                          EMS_FIELD_BIT(Boiler, burnGas_, 7, 0),
+                                          EMS_FIELD_BIT(Boiler, fanWork_, 7, 2),
+                                          EMS_FIELD_BIT(Boiler, ignWork_, 7, 3),
+                                          EMS_FIELD_BIT(Boiler, heatingPump_, 7, 5),
+                                          EMS_FIELD_BIT(Boiler, wWHeat_, 7, 6),
+                                          EMS_FIELD_BIT(Boiler, wWCirc_, 7, 7),
+                                          EMS_FIELD(Boiler, wWStorageTemp1_, 9),  // 0x8300 if not available
+                                          EMS_FIELD(Boiler, wWStorageTemp2_, 11), // 0x8000 if not available - this is boiler temp
+                                          EMS_FIELD_FILTERED(Boiler, retTemp_, 13),
+                                          EMS_FIELD_FILTERED(Boiler, flameCurr_, 15),
+                                          EMS_FIELD(Boiler, sysPress_, 17), // is *10, FF means missing
+                                          EMS_FIELD(Boiler, serviceCodeNumber_, 20)>;
 };
 
 } // namespace emsesp
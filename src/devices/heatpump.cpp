@@ -33,11 +33,20 @@ Heatpump::Heatpump(uint8_t device_type, uint8_t device_id, uint8_t product_id, c
     register_telegram_type(0x047B, F("HP2"), true, [&](std::shared_ptr<const Telegram> t) { process_HPMonitor2(t); });
 }
 
+bool Heatpump::export_values(JsonObject & json, int8_t id) {
+    return export_values_main(json);
+}
+
+bool Heatpump::export_metrics(MetricsObject & json) {
+    return export_values_main(json);
+}
+
 // creates JSON doc from values
 // returns false if empty
-bool Heatpump::export_values(JsonObject & json, int8_t id) {
+template <typename Json>
+bool Heatpump::export_values_main(Json & json) {
     if (Helpers::hasValue(airHumidity_)) {
-        json["airHumidity"] = (float)airHumidity_ / 2;
+        json["airHumidity"] = FixedPoint(airHumidity_, 2).json();
     }
 
     if (Helpers::hasValue(dewTemperature_)) {
@@ -47,10 +56,17 @@ bool Heatpump::export_values(JsonObject & json, int8_t id) {
     return json.size();
 }
 
+bool Heatpump::export_statistics(JsonObject & json) {
+    uint32_t now = uuid::get_uptime();
+    airHumidityStat_.add_json(json, now);
+    dewTemperatureStat_.add_json(json, now);
+    return json.size();
+}
+
 void Heatpump::device_info_web(JsonArray & root, uint8_t & part) {
     // fetch the values into a JSON document
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
-    JsonObject                                     json = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
+    JsonObject         json = doc.to<JsonObject>();
     if (!export_values(json)) {
         return; // empty
     }
@@ -69,8 +85,8 @@ void Heatpump::publish_values(JsonObject & json, bool force) {
         }
     }
 
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
-    JsonObject                                     json_data = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
+    JsonObject         json_data = doc.to<JsonObject>();
     if (export_values(json_data)) {
         Mqtt::publish(F("heatpump_data"), doc.as<JsonObject>());
     }
@@ -82,7 +98,7 @@ void Heatpump::register_mqtt_ha_config() {
     }
 
     // Create the Master device
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_HA_CONFIG> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
     doc["name"]    = F_(EMSESP);
     doc["uniq_id"] = F_(heatpump);
     doc["ic"]      = F_(iconpump);
@@ -124,6 +140,8 @@ bool Heatpump::updated_values() {
 void Heatpump::process_HPMonitor2(std::shared_ptr<const Telegram> telegram) {
     changed_ |= telegram->read_value(dewTemperature_, 0);
     changed_ |= telegram->read_value(airHumidity_, 1);
+    dewTemperatureStat_.update(dewTemperature_);
+    airHumidityStat_.update(airHumidity_);
 }
 
 #pragma GCC diagnostic push
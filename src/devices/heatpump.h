@@ -29,6 +29,7 @@
 #include "telegram.h"
 #include "helpers.h"
 #include "mqtt.h"
+#include "statistics.h"
 
 namespace emsesp {
 
@@ -38,17 +39,26 @@ class Heatpump : public EMSdevice {
 
     virtual void publish_values(JsonObject & json, bool force);
     virtual bool export_values(JsonObject & json, int8_t id = -1);
+    virtual bool export_metrics(MetricsObject & json);
     virtual void device_info_web(JsonArray & root, uint8_t & part);
+    virtual bool export_statistics(JsonObject & json);
     virtual bool updated_values();
 
   private:
     static uuid::log::Logger logger_;
 
+    template <typename Json>
+    bool export_values_main(Json & json);
+
     void register_mqtt_ha_config();
 
     uint8_t airHumidity_    = EMS_VALUE_UINT_NOTSET;
     uint8_t dewTemperature_ = EMS_VALUE_UINT_NOTSET;
 
+    // figures over the last hour
+    Statistic airHumidityStat_{"airHumidity", Statistic::Kind::LEVEL, 2};
+    Statistic dewTemperatureStat_{"dewTemperature", Statistic::Kind::LEVEL};
+
     bool changed_        = false;
     bool mqtt_ha_config_ = false; // for HA MQTT Discovery
 
@@ -62,8 +62,8 @@ void Mixer::device_info_web(JsonArray & root, uint8_t & part) {
     }
 
     // fetch the values into a JSON document
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
-    JsonObject                                     json = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
+    JsonObject         json = doc.to<JsonObject>();
 
     if (!export_values_format(Mqtt::Format::SINGLE, json)) {
         return; // empty
@@ -106,8 +106,8 @@ void Mixer::publish_values(JsonObject & json, bool force) {
     }
 
     if (Mqtt::mqtt_format() == Mqtt::Format::SINGLE) {
-        StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
-        JsonObject                                     json_data = doc.to<JsonObject>();
+        PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
+        JsonObject         json_data = doc.to<JsonObject>();
         if (export_values_format(Mqtt::mqtt_format(), json_data)) {
             char topic[30];
             if (type() == Type::HC) {
@@ -135,7 +135,7 @@ void Mixer::register_mqtt_ha_config() {
     }
 
     // Create the Master device
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_HA_CONFIG> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
 
     char name[20];
     snprintf_P(name, sizeof(name), PSTR("Mixer %02X"), device_id() - 0x20 + 1);
@@ -193,6 +193,17 @@ bool Mixer::export_values(JsonObject & json, int8_t id) {
     return false;
 }
 
+bool Mixer::export_metrics(MetricsObject & json) {
+    if (type() == Type::NONE) {
+        return false;
+    }
+
+    char hc_name[10]; // hc{1-4} or wwc{1-2}
+    snprintf_P(hc_name, sizeof(hc_name), (type() == Type::HC) ? PSTR("hc%d") : PSTR("wwc%d"), hc_);
+    auto json_hc = json.createNestedObject(hc_name);
+    return export_values_hc(json_hc);
+}
+
 // creates JSON doc from values
 // returns false if empty
 bool Mixer::export_values_format(uint8_t mqtt_format, JsonObject & json) {
@@ -215,6 +226,28 @@ bool Mixer::export_values_format(uint8_t mqtt_format, JsonObject & json) {
         } else {
             json_hc = json.createNestedObject(hc_name);
         }
+        return export_values_hc(json_hc);
+    }
+
+    // WWC
+    snprintf_P(hc_name, sizeof(hc_name), PSTR("wwc%d"), hc_);
+    if (mqtt_format == Mqtt::Format::SINGLE) {
+        json_hc      = json;
+        json["type"] = FJSON("wwc");
+    } else if (mqtt_format == Mqtt::Format::HA) {
+        json_hc         = json.createNestedObject(hc_name);
+        json_hc["type"] = FJSON("wwc");
+    } else {
+        json_hc = json.createNestedObject(hc_name);
+    }
+    return export_values_hc(json_hc);
+}
+
+// the values of the heating circuit or warm water circuit
+// returns false if empty
+template <typename Json>
+bool Mixer::export_values_hc(Json & json_hc) {
+    if (type() == Type::HC) {
         // T0: flow temperature on the low loss header
         // if (Helpers::hasValue(flowTempLowLoss_)) {
         //     json_hc["flowTempLowLoss"] = flowTempLowLoss_;
@@ -225,7 +258,7 @@ bool Mixer::export_values_format(uint8_t mqtt_format, JsonObject & json) {
         }
         // TC1: flow temperature in assigned hc or tank temperature in assigned tank primary circuit
         if (Helpers::hasValue(flowTempHc_)) {
-            json_hc["flowTempHc"] = (float)flowTempHc_ / 10;
+            json_hc["flowTempHc"] = FixedPoint(flowTempHc_, 10).json();
         }
         // PC1: heating pump in assigned hc -or- PW1: tank primary pump in assigned tank primary circuit (code switch 9 or 10)
         Helpers::json_boolean(json_hc, "pumpStatus", pumpStatus_);
@@ -238,18 +271,8 @@ bool Mixer::export_values_format(uint8_t mqtt_format, JsonObject & json) {
     }
 
     // WWC
-    snprintf_P(hc_name, sizeof(hc_name), PSTR("wwc%d"), hc_);
-    if (mqtt_format == Mqtt::Format::SINGLE) {
-        json_hc      = json;
-        json["type"] = FJSON("wwc");
-    } else if (mqtt_format == Mqtt::Format::HA) {
-        json_hc         = json.createNestedObject(hc_name);
-        json_hc["type"] = FJSON("wwc");
-    } else {
-        json_hc = json.createNestedObject(hc_name);
-    }
     if (Helpers::hasValue(flowTempHc_)) {
-        json_hc["wWTemp"] = (float)flowTempHc_ / 10;
+        json_hc["wWTemp"] = FixedPoint(flowTempHc_, 10).json();
     }
     Helpers::json_boolean(json_hc, "pumpStatus", pumpStatus_);
     if (Helpers::hasValue(status_)) {
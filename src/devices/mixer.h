@@ -39,12 +39,15 @@ class Mixer : public EMSdevice {
     virtual void publish_values(JsonObject & json, bool force);
     virtual bool export_values(JsonObject & json, int8_t id = -1);
     virtual void device_info_web(JsonArray & root, uint8_t & part);
+    virtual bool export_metrics(MetricsObject & json);
     virtual bool updated_values();
 
   private:
     static uuid::log::Logger logger_;
 
     bool export_values_format(uint8_t mqtt_format, JsonObject & doc);
+    template <typename Json>
+    bool export_values_hc(Json & doc);
     void register_mqtt_ha_config();
 
     void process_MMPLUSStatusMessage_HC(std::shared_ptr<const Telegram> telegram);
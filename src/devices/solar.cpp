@@ -64,8 +64,8 @@ Solar::Solar(uint8_t device_type, uint8_t device_id, uint8_t product_id, const s
 // print to web
 void Solar::device_info_web(JsonArray & root, uint8_t & part) {
     // fetch the values into a JSON document
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_MEDIUM> doc;
-    JsonObject                                      json = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_MEDIUM);
+    JsonObject         json = doc.to<JsonObject>();
     if (!export_values(json)) {
         return; // empty
     }
@@ -99,8 +99,8 @@ void Solar::publish_values(JsonObject & json, bool force) {
         }
     }
 
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_MEDIUM> doc;
-    JsonObject                                      json_payload = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_MEDIUM);
+    JsonObject         json_payload = doc.to<JsonObject>();
     if (export_values(json_payload)) {
         if (device_id() == 0x2A) {
             Mqtt::publish(F("ww_data"), doc.as<JsonObject>());
@@ -117,7 +117,7 @@ void Solar::register_mqtt_ha_config() {
     }
 
     // Create the Master device
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_HA_CONFIG> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
     doc["name"]    = F_(EMSESP);
     doc["uniq_id"] = F_(solar);
     doc["ic"]      = F_(iconthermostat);
@@ -158,28 +158,45 @@ void Solar::register_mqtt_ha_config() {
     mqtt_ha_config_ = true; // done
 }
 
+bool Solar::export_statistics(JsonObject & json) {
+    uint32_t now = uuid::get_uptime();
+    solarPumpStat_.add_json(json, now);
+    solarPumpModulationStat_.add_json(json, now);
+    collectorTempStat_.add_json(json, now);
+    return json.size();
+}
+
+bool Solar::export_values(JsonObject & json, int8_t id) {
+    return export_values_main(json);
+}
+
+bool Solar::export_metrics(MetricsObject & json) {
+    return export_values_main(json);
+}
+
 // creates JSON doc from values
 // returns false if empty
-bool Solar::export_values(JsonObject & json, int8_t id) {
+template <typename Json>
+bool Solar::export_values_main(Json & json) {
     // collector array temperature (TS1)
     if (Helpers::hasValue(collectorTemp_)) {
-        json["collectorTemp"] = (float)collectorTemp_ / 10;
+        json["collectorTemp"] = FixedPoint(collectorTemp_, 10).json();
     }
     // tank bottom temperature (TS2)
     if (Helpers::hasValue(tankBottomTemp_)) {
-        json["tankBottomTemp"] = (float)tankBottomTemp_ / 10;
+        json["tankBottomTemp"] = FixedPoint(tankBottomTemp_, 10).json();
     }
     // tank middle temperature (TS3)
     // if (Helpers::hasValue(tankMiddleTemp_)) {
-    // json["tankMiddleTemp"] = (float)tankMiddleTemp_ / 10;
+    // json["tankMiddleTemp"] = FixedPoint(tankMiddleTemp_, 10).json();
     // }
     // second tank bottom temperature or swimming pool (TS5)
     if (Helpers::hasValue(tank2BottomTemp_)) {
-        json["tank2BottomTemp"] = (float)tank2BottomTemp_ / 10;
+        json["tank2BottomTemp"] = FixedPoint(tank2BottomTemp_, 10).json();
     }
     // temperature heat exchanger (TS6)
     if (Helpers::hasValue(heatExchangerTemp_)) {
-        json["heatExchangerTemp"] = (float)heatExchangerTemp_ / 10;
+        json["heatExchangerTemp"] = FixedPoint(heatExchangerTemp_, 10).json();
     }
 
     if (Helpers::hasValue(tankBottomMaxTemp_)) {
@@ -217,7 +234,7 @@ bool Solar::export_values(JsonObject & json, int8_t id) {
     Helpers::json_boolean(json, "collectorShutdown", collectorShutdown_);
 
     if (Helpers::hasValue(energyLastHour_)) {
-        json["energyLastHour"] = (float)energyLastHour_ / 10;
+        json["energyLastHour"] = FixedPoint(energyLastHour_, 10).json();
     }
 
     if (Helpers::hasValue(energyToday_)) {
@@ -225,7 +242,7 @@ bool Solar::export_values(JsonObject & json, int8_t id) {
     }
 
     if (Helpers::hasValue(energyTotal_)) {
-        json["energyTotal"] = (float)energyTotal_ / 10;
+        json["energyTotal"] = FixedPoint(energyTotal_, 10).json();
     }
 
     return json.size();
@@ -247,6 +264,9 @@ void Solar::process_SM10Monitor(std::shared_ptr<const Telegram> telegram) {
     changed_ |= telegram->read_value(solarPumpModulation_, 4); // modulation solar pump
     changed_ |= telegram->read_bitvalue(solarPump_, 7, 1);     // PS1: solar pump on (1) or off (0)
     changed_ |= telegram->read_value(pumpWorkTime_, 8, 3);
+    collectorTempStat_.update(collectorTemp_);
+    solarPumpModulationStat_.update(solarPumpModulation_);
+    solarPumpStat_.update(solarPump_);
 }
 
 /*
@@ -323,6 +343,7 @@ void Solar::process_SM100Monitor(std::shared_ptr<const Telegram> telegram) {
     changed_ |= telegram->read_value(tankBottomTemp_, 2);     // is *10 - TS2: Temperature sensor 1st cylinder, bottom
     changed_ |= telegram->read_value(tank2BottomTemp_, 16);   // is *10 - TS5: Temperature sensor 2nd cylinder, bottom, or swimming pool
     changed_ |= telegram->read_value(heatExchangerTemp_, 20); // is *10 - TS6: Heat exchanger temperature sensor
+    collectorTempStat_.update(collectorTemp_);
 }
 
 #pragma GCC diagnostic push
@@ -382,6 +403,7 @@ void Solar::process_SM100Status(std::shared_ptr<const Telegram> telegram) {
     if (solarpumpmod == 0 && solarPumpModulation_ == 100) { // mask out boosts
         solarPumpModulation_ = 15;                          // set to minimum
     }
+    solarPumpModulationStat_.update(solarPumpModulation_);
 
     if (cylinderpumpmod == 0 && cylinderPumpModulation_ == 100) { // mask out boosts
         cylinderPumpModulation_ = 15;                             // set to minimum
@@ -399,6 +421,7 @@ void Solar::process_SM100Status(std::shared_ptr<const Telegram> telegram) {
 void Solar::process_SM100Status2(std::shared_ptr<const Telegram> telegram) {
     changed_ |= telegram->read_bitvalue(valveStatus_, 4, 2); // on if bit 2 set
     changed_ |= telegram->read_bitvalue(solarPump_, 10, 2);  // PS1: solar circuit pump on (1) or off (0), on if bit 2 set
+    solarPumpStat_.update(solarPump_);
 }
 
 /*
@@ -446,6 +469,8 @@ void Solar::process_ISM1StatusMessage(std::shared_ptr<const Telegram> telegram)
     changed_ |= telegram->read_value(pumpWorkTime_, 10, 3);        // force to 3 bytes
     changed_ |= telegram->read_bitvalue(collectorShutdown_, 9, 0); // collector shutdown on/off
     changed_ |= telegram->read_bitvalue(tankHeated_, 9, 2);        // tankBottomTemp reached tankBottomMaxTemp
+    collectorTempStat_.update(collectorTemp_);
+    solarPumpStat_.update(solarPump_);
 }
 
 /*
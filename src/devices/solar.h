@@ -29,6 +29,7 @@
 #include "telegram.h"
 #include "helpers.h"
 #include "mqtt.h"
+#include "statistics.h"
 
 namespace emsesp {
 
@@ -38,12 +39,17 @@ class Solar : public EMSdevice {
 
     virtual void publish_values(JsonObject & json, bool force);
     virtual bool export_values(JsonObject & json, int8_t id = -1);
+    virtual bool export_metrics(MetricsObject & json);
     virtual void device_info_web(JsonArray & root, uint8_t & part);
+    virtual bool export_statistics(JsonObject & json);
     virtual bool updated_values();
 
   private:
     static uuid::log::Logger logger_;
-    void                     register_mqtt_ha_config();
+
+    void register_mqtt_ha_config();
+    template <typename Json>
+    bool export_values_main(Json & json);
 
     int16_t collectorTemp_  = EMS_VALUE_SHORT_NOTSET; // TS1: Temperature sensor for collector array 1
     int16_t tankBottomTemp_ = EMS_VALUE_SHORT_NOTSET; // TS2: Temperature sensor 1st cylinder, bottom (solar thermal system)
@@ -62,6 +68,11 @@ class Solar : public EMSdevice {
     uint8_t  tankHeated_                 = EMS_VALUE_BOOL_NOTSET;
     uint8_t  collectorShutdown_          = EMS_VALUE_BOOL_NOTSET; // Collector shutdown on/off
 
+    // figures over the last hour
+    Statistic solarPumpStat_{"solarPump", Statistic::Kind::ON_TIME};
+    Statistic solarPumpModulationStat_{"solarPumpModulation", Statistic::Kind::LEVEL};
+    Statistic collectorTempStat_{"collectorTemp", Statistic::Kind::LEVEL, 10};
+
     uint8_t availabilityFlag_ = EMS_VALUE_BOOL_NOTSET;
     uint8_t configFlag_       = EMS_VALUE_BOOL_NOTSET;
     uint8_t userFlag_         = EMS_VALUE_BOOL_NOTSET;
@@ -37,8 +37,8 @@ Switch::Switch(uint8_t device_type, uint8_t device_id, uint8_t product_id, const
 
 // fetch the values into a JSON document for display in the web
 void Switch::device_info_web(JsonArray & root, uint8_t & part) {
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
-    JsonObject                                     json = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
+    JsonObject         json = doc.to<JsonObject>();
     if (export_values(json)) {
         create_value_json(root, F("activated"), nullptr, F_(activated), nullptr, json);
         create_value_json(root, F("flowTemp"), nullptr, F_(flowTempHc), F_(degrees), json);
@@ -55,8 +55,8 @@ void Switch::publish_values(JsonObject & json, bool force) {
         }
     }
 
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
-    JsonObject                                     json_data = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
+    JsonObject         json_data = doc.to<JsonObject>();
     if (export_values(json_data)) {
         Mqtt::publish(F("switch_data"), doc.as<JsonObject>());
     }
@@ -64,10 +64,21 @@ void Switch::publish_values(JsonObject & json, bool force) {
 
 // export values to JSON
 bool Switch::export_values(JsonObject & json, int8_t id) {
+    return export_values_main(json);
+}
+
+bool Switch::export_metrics(MetricsObject & json) {
+    return export_values_main(json);
+}
+
+// creates JSON doc from values
+// returns false if empty
+template <typename Json>
+bool Switch::export_values_main(Json & json) {
     Helpers::json_boolean(json, "activated", activated_);
 
     if (Helpers::hasValue(flowTempHc_)) {
-        json["flowTemp"] = (float)flowTempHc_ / 10;
+        json["flowTemp"] = FixedPoint(flowTempHc_, 10).json();
     }
 
     if (Helpers::hasValue(status_)) {
@@ -98,7 +109,7 @@ void Switch::register_mqtt_ha_config() {
     }
 
     // Create the Master device
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_HA_CONFIG> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
 
     char name[10];
     snprintf_P(name, sizeof(name), PSTR("Switch"));
@@ -38,12 +38,16 @@ class Switch : public EMSdevice {
 
     virtual void publish_values(JsonObject & json, bool force);
     virtual bool export_values(JsonObject & json, int8_t id = -1);
+    virtual bool export_metrics(MetricsObject & json);
     virtual void device_info_web(JsonArray & root, uint8_t & part);
     virtual bool updated_values();
 
   private:
     static uuid::log::Logger logger_;
 
+    template <typename Json>
+    bool export_values_main(Json & json);
+
     void process_WM10SetMessage(std::shared_ptr<const Telegram> telegram);
     void process_WM10MonitorMessage(std::shared_ptr<const Telegram> telegram);
     void process_WM10TempMessage(std::shared_ptr<const Telegram> telegram);
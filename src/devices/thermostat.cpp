@@ -196,8 +196,8 @@ Thermostat::Thermostat(uint8_t device_type, uint8_t device_id, uint8_t product_i
 
 // prepare data for Web UI
 void Thermostat::device_info_web(JsonArray & root, uint8_t & part) {
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_LARGE> doc;
-    JsonObject                                     json = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE);
+    JsonObject         json = doc.to<JsonObject>();
     if (part == 0) {
         if (export_values_main(json)) {
             create_value_json(root, F("dateTime"), nullptr, F_(time), nullptr, json);
@@ -299,6 +299,17 @@ bool Thermostat::export_values(JsonObject & json, int8_t id) {
     return has_value;
 }
 
+bool Thermostat::export_metrics(MetricsObject & json) {
+    bool has_value = export_values_main(json);
+    for (const auto & hc : heating_circuits_) {
+        char hc_name[10]; // hc{1-4}
+        snprintf_P(hc_name, 10, PSTR("hc%d"), hc->hc_num());
+        auto json_hc = json.createNestedObject(hc_name);
+        has_value |= export_values_hc(hc, json_hc);
+    }
+    return has_value;
+}
+
 // publish values via MQTT
 void Thermostat::publish_values(JsonObject & json, bool force) {
     if (EMSESP::actual_master_thermostat() != device_id()) {
@@ -307,8 +318,8 @@ void Thermostat::publish_values(JsonObject & json, bool force) {
 
     // if MQTT is in single mode send out the main data to the thermostat_data topic
     if (Mqtt::mqtt_format() == Mqtt::Format::SINGLE) {
-        StaticJsonDocument<EMSESP_MAX_JSON_SIZE_MEDIUM> doc;
-        JsonObject                                      json_data = doc.to<JsonObject>();
+        PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_MEDIUM);
+        JsonObject         json_data = doc.to<JsonObject>();
         if (export_values_main(json_data)) {
             Mqtt::publish(F("thermostat_data"), json_data);
             doc.clear();
@@ -331,8 +342,8 @@ void Thermostat::publish_values(JsonObject & json, bool force) {
         }
     }
 
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_LARGE> doc;
-    JsonObject                                     json_data = doc.to<JsonObject>();
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE);
+    JsonObject         json_data = doc.to<JsonObject>();
 
     // get the thermostat data.
     // we're in HA or CUSTOM, send out the complete topic with all the data
@@ -341,7 +352,8 @@ void Thermostat::publish_values(JsonObject & json, bool force) {
     }
 }
 
-bool Thermostat::export_values_main(JsonObject & rootThermostat) {
+template <typename Json>
+bool Thermostat::export_values_main(Json & rootThermostat) {
     uint8_t model = this->model();
 
     // Clock time
@@ -399,7 +411,7 @@ bool Thermostat::export_values_main(JsonObject & rootThermostat) {
 
     // Damped outdoor temperature (RC300)
     if (Helpers::hasValue(dampedoutdoortemp2_)) {
-        rootThermostat["dampedoutdoortemp"] = (float)dampedoutdoortemp2_ / 10;
+        rootThermostat["dampedoutdoortemp"] = FixedPoint(dampedoutdoortemp2_, 10).json();
     }
 
     // Floordry
@@ -411,17 +423,17 @@ bool Thermostat::export_values_main(JsonObject & rootThermostat) {
 
     // Temp sensor 1
     if (Helpers::hasValue(tempsensor1_)) {
-        rootThermostat["inttemp1"] = (float)tempsensor1_ / 10;
+        rootThermostat["inttemp1"] = FixedPoint(tempsensor1_, 10).json();
     }
 
     // Temp sensor 2
     if (Helpers::hasValue(tempsensor2_)) {
-        rootThermostat["inttemp2"] = (float)tempsensor2_ / 10;
+        rootThermostat["inttemp2"] = FixedPoint(tempsensor2_, 10).json();
     }
 
     // Offset int. temperature
     if (Helpers::hasValue(ibaCalIntTemperature_)) {
-        rootThermostat["intoffset"] = (float)ibaCalIntTemperature_ / 2;
+        rootThermostat["intoffset"] = FixedPoint(ibaCalIntTemperature_, 2).json();
     }
 
     // Min ext. temperature
@@ -475,7 +487,8 @@ bool Thermostat::export_values_main(JsonObject & rootThermostat) {
 
 // creates JSON doc from values, for each heating circuit
 // returns false if empty
-bool Thermostat::export_values_hc(std::shared_ptr<Thermostat::HeatingCircuit> hc, JsonObject & dataThermostat) {
+template <typename Json>
+bool Thermostat::export_values_hc(std::shared_ptr<Thermostat::HeatingCircuit> hc, Json & dataThermostat) {
     uint8_t model = this->model();
 
     if (!hc->is_active()) {
@@ -497,61 +510,61 @@ bool Thermostat::export_values_hc(std::shared_ptr<Thermostat::HeatingCircuit> hc
 
     // Setpoint room temperature
     if (Helpers::hasValue(hc->setpoint_roomTemp)) {
-        dataThermostat["seltemp"] = Helpers::round2((float)hc->setpoint_roomTemp / setpoint_temp_divider);
+        dataThermostat["seltemp"] = FixedPoint(hc->setpoint_roomTemp, setpoint_temp_divider).json();
     }
 
     // Current room temperature
     if (Helpers::hasValue(hc->curr_roomTemp)) {
-        dataThermostat["currtemp"] = Helpers::round2((float)hc->curr_roomTemp / curr_temp_divider);
+        dataThermostat["currtemp"] = FixedPoint(hc->curr_roomTemp, curr_temp_divider).json();
     }
 
     if (Mqtt::mqtt_format() == Mqtt::Format::HA) {
         if (Helpers::hasValue(hc->ha_temp)) {
-            dataThermostat["hatemp"] = Helpers::round2((float)hc->ha_temp / 10);
+            dataThermostat["hatemp"] = FixedPoint(hc->ha_temp, 10).json();
         } else if (Helpers::hasValue(hc->curr_roomTemp)) {
-            dataThermostat["hatemp"] = Helpers::round2((float)hc->curr_roomTemp / curr_temp_divider);
+            dataThermostat["hatemp"] = FixedPoint(hc->curr_roomTemp, curr_temp_divider).json();
         } else {
-            dataThermostat["hatemp"] = Helpers::round2((float)hc->setpoint_roomTemp / setpoint_temp_divider);
+            dataThermostat["hatemp"] = FixedPoint(hc->setpoint_roomTemp, setpoint_temp_divider).json();
         }
     }
 
     if (Helpers::hasValue(hc->daytemp)) {
         if (model == EMSdevice::EMS_DEVICE_FLAG_JUNKERS) {
             // Heat temperature
-            dataThermostat["heattemp"] = (float)hc->daytemp / 2;
+            dataThermostat["heattemp"] = FixedPoint(hc->daytemp, 2).json();
         } else if (model == EMSdevice::EMS_DEVICE_FLAG_RC300 || model == EMSdevice::EMS_DEVICE_FLAG_RC100) {
             // Comfort temperature
-            dataThermostat["comforttemp"] = (float)hc->daytemp / 2;
+            dataThermostat["comforttemp"] = FixedPoint(hc->daytemp, 2).json();
         } else {
             // Day temperature
-            dataThermostat["daytemp"] = (float)hc->daytemp / 2;
+            dataThermostat["daytemp"] = FixedPoint(hc->daytemp, 2).json();
         }
     }
 
     if (Helpers::hasValue(hc->nighttemp)) {
         if (model == EMSdevice::EMS_DEVICE_FLAG_JUNKERS || model == EMSdevice::EMS_DEVICE_FLAG_RC300 || model == EMSdevice::EMS_DEVICE_FLAG_RC100) {
             // Eco temperature
-            dataThermostat["ecotemp"] = (float)hc->nighttemp / 2;
+            dataThermostat["ecotemp"] = FixedPoint(hc->nighttemp, 2).json();
         } else {
             // Night temperature
-            dataThermostat["nighttemp"] = (float)hc->nighttemp / 2;
+            dataThermostat["nighttemp"] = FixedPoint(hc->nighttemp, 2).json();
         }
     }
 
     // Manual temperature
     if (Helpers::hasValue(hc->manualtemp)) {
-        dataThermostat["manualtemp"] = (float)hc->manualtemp / 2;
+        dataThermostat["manualtemp"] = FixedPoint(hc->manualtemp, 2).json();
     }
 
     // Holiday temperature
     if (Helpers::hasValue(hc->holidaytemp)) {
-        dataThermostat["holidaytemp"] = (float)hc->holidaytemp / 2;
+        dataThermostat["holidaytemp"] = FixedPoint(hc->holidaytemp, 2).json();
     }
 
     // Nofrost temperature
     if (Helpers::hasValue(hc->nofrosttemp)) {
         if (model == EMSdevice::EMS_DEVICE_FLAG_JUNKERS) {
-            dataThermostat["nofrosttemp"] = (float)hc->nofrosttemp / 2;
+            dataThermostat["nofrosttemp"] = FixedPoint(hc->nofrosttemp, 2).json();
         } else {
             dataThermostat["nofrosttemp"] = hc->nofrosttemp;
         }
@@ -819,7 +832,7 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
 // publish config topic for HA MQTT Discovery for main thermostat values
 // homeassistant/sensor/ems-esp/thermostat/config
 void Thermostat::register_mqtt_ha_config() {
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_HA_CONFIG> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
     doc["uniq_id"] = FJSON("thermostat");
     doc["ic"]      = FJSON("mdi:home-thermometer-outline");
 
@@ -879,7 +892,7 @@ void Thermostat::register_mqtt_ha_config() {
 // publish config topic for HA MQTT Discovery for each of the heating circuit
 // e.g. homeassistant/climate/ems-esp/thermostat_hc1/config
 void Thermostat::register_mqtt_ha_config(uint8_t hc_num) {
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_MEDIUM> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_MEDIUM);
 
     char str1[20];
     snprintf_P(str1, sizeof(str1), PSTR("Thermostat hc%d"), hc_num);
@@ -1685,8 +1698,8 @@ bool Thermostat::set_display(const char * value, const int8_t id) {
 
 // set roomtemp for HA-thermostat
 bool Thermostat::set_roomtemp(const char * value, const int8_t id) {
-    float f = 0;
-    if (!Helpers::value2float(value, f)) {
+    int32_t t = 0; // in 0.1 degrees
+    if (!Helpers::value2fixed(value, t, 10)) {
         LOG_WARNING(F("Set roomtemperature: Invalid value"));
         return false;
     }
@@ -1697,10 +1710,10 @@ bool Thermostat::set_roomtemp(const char * value, const int8_t id) {
         return false;
     }
 
-    if (f > 100 || f < 0) {
+    if (t > 1000 || t < 0) {
         hc->ha_temp = EMS_VALUE_SHORT_NOTSET;
     } else {
-        hc->ha_temp = (int16_t)(f * 10);
+        hc->ha_temp = (int16_t)t;
     }
 
     return true;
@@ -1708,8 +1721,8 @@ bool Thermostat::set_roomtemp(const char * value, const int8_t id) {
 
 // set remotetemp for RC20 remote simulation on RC35 master
 bool Thermostat::set_remotetemp(const char * value, const int8_t id) {
-    float f = 0;
-    if (!Helpers::value2float(value, f)) {
+    int32_t t = 0; // in 0.1 degrees
+    if (!Helpers::value2fixed(value, t, 10)) {
         LOG_WARNING(F("Set remote temperature: Invalid value"));
         return false;
     }
@@ -1720,10 +1733,10 @@ bool Thermostat::set_remotetemp(const char * value, const int8_t id) {
         return false;
     }
 
-    if (f > 100 || f < 0) {
+    if (t > 1000 || t < 0) {
         Roomctrl::set_remotetemp(hc->hc_num() - 1, EMS_VALUE_SHORT_NOTSET);
     } else {
-        Roomctrl::set_remotetemp(hc->hc_num() - 1, (int16_t)(f * 10));
+        Roomctrl::set_remotetemp(hc->hc_num() - 1, (int16_t)t);
     }
 
     return true;
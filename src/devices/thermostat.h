@@ -129,14 +129,17 @@ class Thermostat : public EMSdevice {
     virtual void publish_values(JsonObject & json, bool force);
     virtual bool export_values(JsonObject & json, int8_t id = -1);
     virtual void device_info_web(JsonArray & root, uint8_t & part);
+    virtual bool export_metrics(MetricsObject & json);
     virtual bool updated_values();
 
   private:
     static uuid::log::Logger logger_;
 
     void add_commands();
-    bool export_values_main(JsonObject & doc);
-    bool export_values_hc(std::shared_ptr<Thermostat::HeatingCircuit> hc, JsonObject & doc);
+    template <typename Json>
+    bool export_values_main(Json & doc);
+    template <typename Json>
+    bool export_values_hc(std::shared_ptr<Thermostat::HeatingCircuit> hc, Json & doc);
 
     bool ha_registered() const {
         return ha_registered_;
@@ -51,58 +51,63 @@ std::string EMSdevice::brand_to_string() const {
 }
 
 // returns the name of the MQTT topic to use for a specific device
-std::string EMSdevice::device_type_2_device_name(const uint8_t device_type) {
+FlashStringView EMSdevice::device_type_2_device_name_P(const uint8_t device_type) {
     switch (device_type) {
     case DeviceType::SYSTEM:
-        return read_flash_string(F_(system));
+        return F_(system);
         break;
 
     case DeviceType::BOILER:
-        return read_flash_string(F_(boiler));
+        return F_(boiler);
         break;
 
     case DeviceType::THERMOSTAT:
-        return read_flash_string(F_(thermostat));
+        return F_(thermostat);
         break;
 
     case DeviceType::HEATPUMP:
-        return read_flash_string(F_(heatpump));
+        return F_(heatpump);
         break;
 
     case DeviceType::SOLAR:
-        return read_flash_string(F_(solar));
+        return F_(solar);
         break;
 
     case DeviceType::CONNECT:
-        return read_flash_string(F_(connect));
+        return F_(connect);
         break;
 
     case DeviceType::MIXER:
-        return read_flash_string(F_(mixer));
+        return F_(mixer);
         break;
 
     case DeviceType::DALLASSENSOR:
-        return read_flash_string(F_(dallassensor));
+        return F_(dallassensor);
         break;
 
     case DeviceType::CONTROLLER:
-        return read_flash_string(F_(controller));
+        return F_(controller);
         break;
 
     case DeviceType::SWITCH:
-        return read_flash_string(F_(switch));
+        return F_(switch);
         break;
 
     case DeviceType::GATEWAY:
-        return read_flash_string(F_(gateway));
+        return F_(gateway);
         break;
 
     default:
-        return read_flash_string(F_(unknown));
+        return F_(unknown);
         break;
     }
 }
 
+// a copy, for when it's kept or needs changing
+std::string EMSdevice::device_type_2_device_name(const uint8_t device_type) {
+    return device_type_2_device_name_P(device_type).str();
+}
+
 // returns device_type from a string
 uint8_t EMSdevice::device_name_2_device_type(const char * topic) {
     if (!strcmp_P(topic, reinterpret_cast<PGM_P>(F_(boiler)))) {
@@ -297,36 +302,43 @@ void EMSdevice::register_telegram_type(const uint16_t telegram_type_id, const __
 }
 
 // return the name of the telegram type
-std::string EMSdevice::telegram_type_name(std::shared_ptr<const Telegram> telegram) {
+FlashStringView EMSdevice::telegram_type_name(std::shared_ptr<const Telegram> telegram) {
     // see if it's one of the common ones, like Version
     if (telegram->type_id == EMS_TYPE_VERSION) {
-        return read_flash_string(F("Version"));
+        return F("Version");
     } else if (telegram->type_id == EMS_TYPE_UBADevices) {
-        return read_flash_string(F("UBADevices"));
+        return F("UBADevices");
     }
 
     for (const auto & tf : telegram_functions_) {
         if ((tf.telegram_type_id_ == telegram->type_id) && (telegram->type_id != 0xFF)) {
-            return uuid::read_flash_string(tf.telegram_type_name_);
+            return tf.telegram_type_name_;
         }
     }
 
-    return std::string{};
+    return FlashStringView();
 }
 
 // take a telegram_type_id and call the matching handler
 // return true if match found
 bool EMSdevice::handle_telegram(std::shared_ptr<const Telegram> telegram) {
-    for (const auto & tf : telegram_functions_) {
+    for (auto & tf : telegram_functions_) {
         if (tf.telegram_type_id_ == telegram->type_id) {
             // if the data block is empty, assume that this telegram is not recognized by the bus master
             // so remove it from the automatic fetch list
             if (telegram->message_length == 0 && telegram->offset == 0) {
-                EMSESP::logger().debug(F("This telegram (%s) is not recognized by the EMS bus"), uuid::read_flash_string(tf.telegram_type_name_).c_str());
+                char type_name[30];
+                EMSESP::logger().debug(F("This telegram (%s) is not recognized by the EMS bus"), FlashStringView(tf.telegram_type_name_).c_str(type_name));
                 toggle_fetch(tf.telegram_type_id_, false);
                 return false;
             }
             if (telegram->message_length > 0) {
+                // only a telegram with different data can change our values
+                uint32_t hash = Helpers::hash(telegram->message_data, telegram->message_length, Helpers::hash(&telegram->offset, 1));
+                if (hash != tf.hash_) {
+                    tf.hash_       = hash;
+                    value_version_ = EMSESP::next_value_version();
+                }
                 tf.process_function_(telegram);
             }
             return true;
@@ -362,7 +374,7 @@ void EMSdevice::create_value_json(JsonArray &                 root,
                                   const __FlashStringHelper * name,
                                   const __FlashStringHelper * suffix,
                                   JsonObject &                json) {
-    JsonVariant data = json[uuid::read_flash_string(key)];
+    JsonVariant data = json[key];
     if (data == nullptr) {
         return; // doesn't exist
     }
@@ -370,7 +382,8 @@ void EMSdevice::create_value_json(JsonArray &                 root,
     // add prefix to name
     if (prefix != nullptr) {
         char name_text[100];
-        snprintf_P(name_text, sizeof(name_text), PSTR("%s%s"), uuid::read_flash_string(prefix).c_str(), uuid::read_flash_string(name).c_str());
+        FlashStringView(prefix).copy(name_text, sizeof(name_text));
+        FlashStringView(name).append(name_text, sizeof(name_text));
         root.add(name_text);
     } else {
         root.add(name);
@@ -378,24 +391,28 @@ void EMSdevice::create_value_json(JsonArray &                 root,
 
     // convert to string and add the suffix, this is to save space when sending to the web as json
     // which is why we use n and v instead of name and value
-    std::string suffix_string(10, '\0');
-    if (suffix == nullptr) {
-        suffix_string = "";
-    } else {
-        suffix_string = " " + uuid::read_flash_string(suffix);
+    char suffix_string[20] = "";
+    if (suffix != nullptr) {
+        suffix_string[0] = ' ';
+        FlashStringView(suffix).copy(suffix_string + 1, sizeof(suffix_string) - 1);
     }
 
     char data_string[40];
     if (data.is<char *>()) {
-        snprintf_P(data_string, sizeof(data_string), PSTR("%s%s"), data.as<char *>(), suffix_string.c_str());
+        snprintf_P(data_string, sizeof(data_string), PSTR("%s%s"), data.as<char *>(), suffix_string);
     } else if (data.is<int>()) {
-        snprintf_P(data_string, sizeof(data_string), PSTR("%d%s"), data.as<int>(), suffix_string.c_str());
+        snprintf_P(data_string, sizeof(data_string), PSTR("%d%s"), data.as<int>(), suffix_string);
     } else if (data.is<float>()) {
         char s[10];
-        snprintf_P(data_string, sizeof(data_string), PSTR("%s%s"), Helpers::render_value(s, (float)data.as<float>(), 1), suffix_string.c_str());
+        snprintf_P(data_string, sizeof(data_string), PSTR("%s%s"), Helpers::render_value(s, (float)data.as<float>(), 1), suffix_string);
     } else if (data.is<bool>()) {
         char s[10];
-        snprintf_P(data_string, sizeof(data_string), PSTR("%s%s"), Helpers::render_boolean(s, data.as<bool>()), suffix_string.c_str());
+        snprintf_P(data_string, sizeof(data_string), PSTR("%s%s"), Helpers::render_boolean(s, data.as<bool>()), suffix_string);
+    } else {
+        // a FixedPoint, which is already rendered
+        char s[FixedPoint::MAX_LENGTH + 1];
+        serializeJson(data, s, sizeof(s));
+        snprintf_P(data_string, sizeof(data_string), PSTR("%s%s"), s, suffix_string);
     }
 
     root.add(data_string);
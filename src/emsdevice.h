@@ -27,6 +27,7 @@
 #include "telegram.h"
 #include "mqtt.h"
 #include "helpers.h"
+#include "metricsobject.h"
 
 namespace emsesp {
 
@@ -52,7 +53,8 @@ class EMSdevice {
     }
 
     std::string        device_type_name() const;
-    static std::string device_type_2_device_name(const uint8_t device_type);
+    static std::string     device_type_2_device_name(const uint8_t device_type);
+    static FlashStringView device_type_2_device_name_P(const uint8_t device_type);
     static uint8_t     device_name_2_device_type(const char * topic);
 
     inline uint8_t product_id() const {
@@ -117,6 +119,11 @@ class EMSdevice {
         unique_id_ = unique_id;
     }
 
+    // the value version of when a telegram last brought new data, see EMSESP::next_value_version()
+    inline uint32_t value_version() const {
+        return value_version_;
+    }
+
     std::string    brand_to_string() const;
     static uint8_t decode_brand(uint8_t value);
 
@@ -145,7 +152,17 @@ class EMSdevice {
     virtual bool updated_values()                                      = 0;
     virtual void device_info_web(JsonArray & root, uint8_t & part)     = 0;
 
-    std::string telegram_type_name(std::shared_ptr<const Telegram> telegram);
+    // figures over the last hour, see Statistic. Returns false if there are none
+    virtual bool export_statistics(JsonObject &) {
+        return false;
+    }
+
+    // the same values as export_values(), written straight out as metrics. Returns false if there are none
+    virtual bool export_metrics(MetricsObject &) {
+        return false;
+    }
+
+    FlashStringView telegram_type_name(std::shared_ptr<const Telegram> telegram);
 
     void fetch_values();
     void toggle_fetch(uint16_t telegram_id, bool toggle);
@@ -238,20 +255,23 @@ class EMSdevice {
     uint8_t     product_id_  = 0;
     std::string version_;
     std::string name_; // the long name for the EMS model
-    uint8_t     flags_ = 0;
-    uint8_t     brand_ = Brand::NO_BRAND;
+    uint8_t     flags_         = 0;
+    uint8_t     brand_         = Brand::NO_BRAND;
+    uint32_t    value_version_ = 0;
 
     struct TelegramFunction {
         uint16_t                    telegram_type_id_;   // it's type_id
         const __FlashStringHelper * telegram_type_name_; // e.g. RC20Message
         bool                        fetch_;              // if this type_id be queried automatically
         process_function_p          process_function_;
+        uint32_t                    hash_; // hash of the last telegram received, to see if anything changed
 
         TelegramFunction(uint16_t telegram_type_id, const __FlashStringHelper * telegram_type_name, bool fetch, process_function_p process_function)
             : telegram_type_id_(telegram_type_id)
             , telegram_type_name_(telegram_type_name)
             , fetch_(fetch)
-            , process_function_(process_function) {
+            , process_function_(process_function)
+            , hash_(0) {
         }
     };
     std::vector<TelegramFunction> telegram_functions_; // each EMS device has its own set of registered telegram types
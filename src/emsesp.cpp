@@ -35,14 +35,19 @@ WebSettingsService EMSESP::webSettingsService = WebSettingsService(&webServer, &
 #endif
 
 WebStatusService  EMSESP::webStatusService  = WebStatusService(&webServer, EMSESP::esp8266React.getSecurityManager());
-WebDevicesService EMSESP::webDevicesService = WebDevicesService(&webServer, EMSESP::esp8266React.getSecurityManager());
+WebDevicesService EMSESP::webDevicesService(&webServer, EMSESP::esp8266React.getSecurityManager());
 WebAPIService     EMSESP::webAPIService     = WebAPIService(&webServer);
+WebMetricsService EMSESP::webMetricsService = WebMetricsService(&webServer);
+WebCaptureService EMSESP::webCaptureService = WebCaptureService(&webServer, EMSESP::esp8266React.getSecurityManager());
+WebHistoryService EMSESP::webHistoryService = WebHistoryService(&webServer, EMSESP::esp8266React.getSecurityManager());
 
 using DeviceFlags = emsesp::EMSdevice;
 using DeviceType  = emsesp::EMSdevice::DeviceType;
-std::vector<std::unique_ptr<EMSdevice>>    EMSESP::emsdevices;      // array of all the detected EMS devices
+std::vector<std::shared_ptr<EMSdevice>>    EMSESP::emsdevices;      // array of all the detected EMS devices, shared so a web request can hold on to them
 std::vector<emsesp::EMSESP::Device_record> EMSESP::device_library_; // libary of all our known EMS devices so far
 
+std::shared_ptr<const std::vector<std::shared_ptr<EMSdevice>>> EMSESP::emsdevices_snapshot_ = std::make_shared<const std::vector<std::shared_ptr<EMSdevice>>>();
+
 uuid::log::Logger EMSESP::logger_{F_(emsesp), uuid::log::Facility::KERN};
 
 // The services
@@ -53,6 +58,10 @@ System       EMSESP::system_;       // core system services
 Console      EMSESP::console_;      // telnet and serial console
 DallasSensor EMSESP::dallassensor_; // Dallas sensors
 Shower       EMSESP::shower_;       // Shower logic
+BusAnalyser  EMSESP::busanalyser_;  // bus statistics
+BusCapture   EMSESP::buscapture_;   // raw frames on the bus
+History      EMSESP::history_;      // selected values over time
+Scheduler    EMSESP::scheduler_;    // runs the services from loop()
 
 // static/common variables
 uint8_t  EMSESP::actual_master_thermostat_ = EMSESP_DEFAULT_MASTER_THERMOSTAT; // which thermostat leads when multiple found
@@ -62,12 +71,16 @@ uint16_t EMSESP::read_id_                  = WATCH_ID_NONE;
 bool     EMSESP::read_next_                = false;
 uint16_t EMSESP::publish_id_               = 0;
 bool     EMSESP::tap_water_active_         = false; // for when Boiler states we having running warm water. used in Shower()
-uint32_t EMSESP::last_fetch_               = 0;
 uint8_t  EMSESP::publish_all_idx_          = 0;
 uint8_t  EMSESP::unique_id_count_          = 0;
 bool     EMSESP::trace_raw_                = false;
 uint64_t EMSESP::tx_delay_                 = 0;
+uint64_t EMSESP::delayed_tx_start_         = 0;
 bool     EMSESP::force_scan_               = false;
+uint32_t EMSESP::value_version_            = 0;
+uint8_t  EMSESP::stats_publish_            = EMSESP_DEFAULT_STATS_PUBLISH;
+
+FrameQueue<EMSESP_RX_FRAMES, EMS_MAXBUFFERSIZE> EMSESP::rx_frames_;
 
 // for a specific EMS device go and request data values
 // or if device_id is 0 it will fetch from all our known and active devices
@@ -101,6 +114,17 @@ uint8_t EMSESP::count_devices(const uint8_t device_type) {
     return count;
 }
 
+// the latest value version of all devices of this type, 0 if there are none
+uint32_t EMSESP::value_version(const uint8_t device_type) {
+    uint32_t version = 0;
+    for (const auto & emsdevice : emsdevices) {
+        if (emsdevice && (emsdevice->device_type() == device_type) && (emsdevice->value_version() > version)) {
+            version = emsdevice->value_version();
+        }
+    }
+    return version;
+}
+
 // scans for new devices
 void EMSESP::scan_devices() {
     EMSESP::clear_all_devices();
@@ -231,9 +255,17 @@ void EMSESP::show_ems(uuid::console::Shell & shell) {
         shell.printfln(F("  #read requests sent: %d"), txservice_.telegram_read_count());
         shell.printfln(F("  #write requests sent: %d"), txservice_.telegram_write_count());
         shell.printfln(F("  #incomplete telegrams: %d"), rxservice_.telegram_error_count());
+        shell.printfln(F("  #frames dropped (Rx queue full): %d"), rx_frames_.dropped());
         shell.printfln(F("  #tx fails (after %d retries): %d"), TxService::MAXIMUM_TX_RETRIES, txservice_.telegram_fail_count());
         shell.printfln(F("  Rx line quality: %d%%"), rxservice_.quality());
         shell.printfln(F("  Tx line quality: %d%%"), txservice_.quality());
+        for (const auto & h : txservice_.tx_health()) {
+            if (txservice_.suspended(h.dest_)) {
+                shell.printfln(F("  Tx quality to 0x%02X: %d%% (%d fails in a row, suspended)"), h.dest_, h.quality(), h.consecutive_fails_);
+            } else {
+                shell.printfln(F("  Tx quality to 0x%02X: %d%%"), h.dest_, h.quality());
+            }
+        }
         shell.println();
     }
 
@@ -281,7 +313,7 @@ void EMSESP::show_device_values(uuid::console::Shell & shell) {
         return;
     }
 
-    DynamicJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
 
     // do this in the order of factory classes to keep a consistent order when displaying
     for (const auto & device_class : EMSFactory::device_handlers()) {
@@ -309,6 +341,21 @@ void EMSESP::show_device_values(uuid::console::Shell & shell) {
     }
 }
 
+// the figures over the last hour, for the devices that have them
+void EMSESP::show_statistics(uuid::console::Shell & shell) {
+    for (const auto & emsdevice : emsdevices) {
+        if (emsdevice) {
+            PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_MEDIUM);
+            JsonObject         json = doc.to<JsonObject>();
+            if (emsdevice->export_statistics(json)) {
+                std::string figures;
+                serializeJson(json, figures);
+                shell.printfln(F("%s: %s"), emsdevice->name().c_str(), figures.c_str());
+            }
+        }
+    }
+}
+
 // show Dallas temperature sensors
 void EMSESP::show_sensor_values(uuid::console::Shell & shell) {
     if (!have_sensors()) {
@@ -385,9 +432,8 @@ void EMSESP::publish_all_loop() {
 // special case for Mixer units, since we want to bundle all devices together into one payload
 void EMSESP::publish_device_values(uint8_t device_type, bool force) {
     if (device_type == EMSdevice::DeviceType::MIXER && Mqtt::mqtt_format() != Mqtt::Format::SINGLE) {
-        // DynamicJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE);
-        StaticJsonDocument<EMSESP_MAX_JSON_SIZE_LARGE> doc;
-        JsonObject                                     json = doc.to<JsonObject>();
+        PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE);
+        JsonObject         json = doc.to<JsonObject>();
         for (const auto & emsdevice : emsdevices) {
             if (emsdevice && (emsdevice->device_type() == device_type)) {
                 emsdevice->publish_values(json, force);
@@ -407,6 +453,32 @@ void EMSESP::publish_device_values(uint8_t device_type, bool force) {
     }
 }
 
+// the figures over the last hour, in <device>_stats
+void EMSESP::publish_statistics() {
+    if (!Mqtt::connected()) {
+        return;
+    }
+    for (const auto & emsdevice : emsdevices) {
+        if (emsdevice) {
+            PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_MEDIUM);
+            JsonObject         json = doc.to<JsonObject>();
+            if (emsdevice->export_statistics(json)) {
+                Mqtt::publish(EMSdevice::device_type_2_device_name(emsdevice->device_type()) + "_stats", json);
+            }
+        }
+    }
+}
+
+// called every minute, they go out every stats_publish_ minutes
+void EMSESP::publish_statistics_loop() {
+    static uint8_t minutes = 0;
+    if (!stats_publish_ || (++minutes < stats_publish_)) {
+        return;
+    }
+    minutes = 0;
+    publish_statistics();
+}
+
 void EMSESP::publish_other_values() {
     for (const auto & emsdevice : emsdevices) {
         if (emsdevice && (emsdevice->device_type() != EMSdevice::DeviceType::BOILER) && (emsdevice->device_type() != EMSdevice::DeviceType::THERMOSTAT)
@@ -417,6 +489,21 @@ void EMSESP::publish_other_values() {
     }
 }
 
+// subscriber for device value changes, publishes to MQTT if it's set to publish on change
+void EMSESP::device_values_changed(const Events::Event & event) {
+    if (!Mqtt::connected() || !mqtt_.get_publish_onchange(event.device_type_)) {
+        return;
+    }
+    for (const auto & emsdevice : emsdevices) {
+        if (emsdevice && (emsdevice->unique_id() == event.unique_id_)) {
+            if (emsdevice->updated_values()) {
+                publish_device_values(event.device_type_);
+            }
+            return;
+        }
+    }
+}
+
 void EMSESP::publish_sensor_values(const bool time, const bool force) {
     if (dallassensor_.updated_values() || time || force) {
         dallassensor_.publish_values(force);
@@ -429,7 +516,7 @@ void EMSESP::publish_response(std::shared_ptr<const Telegram> telegram) {
         return;
     }
 
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
 
     char buffer[100];
     doc["src"]    = Helpers::hextoa(buffer, telegram->src);
@@ -470,10 +557,10 @@ std::string EMSESP::pretty_telegram(std::shared_ptr<const Telegram> telegram) {
     uint8_t offset = telegram->offset;
 
     // find name for src and dest by looking up known devices
-    std::string src_name;
-    std::string dest_name;
-    std::string type_name;
-    std::string direction;
+    std::string     src_name;
+    std::string     dest_name;
+    FlashStringView type_name;
+    FlashStringView direction;
     for (const auto & emsdevice : emsdevices) {
         if (emsdevice) {
             // get src & dest
@@ -500,20 +587,23 @@ std::string EMSESP::pretty_telegram(std::shared_ptr<const Telegram> telegram) {
 
     // check for global/common types like Version
     if (telegram->type_id == EMSdevice::EMS_TYPE_VERSION) {
-        type_name = read_flash_string(F("Version"));
+        type_name = F("Version");
     }
 
     // if we don't know the type show
     if (type_name.empty()) {
-        type_name = read_flash_string(F("?"));
+        type_name = F("?");
     }
 
     if (telegram->operation == Telegram::Operation::RX_READ) {
-        direction = read_flash_string(F("<-"));
+        direction = F("<-");
     } else {
-        direction = read_flash_string(F("->"));
+        direction = F("->");
     }
 
+    char type_name_s[30];
+    char direction_s[3];
+
     std::string str(200, '\0');
     if (offset) {
         snprintf_P(&str[0],
@@ -521,10 +611,10 @@ std::string EMSESP::pretty_telegram(std::shared_ptr<const Telegram> telegram) {
                    PSTR("%s(0x%02X) %s %s(0x%02X), %s(0x%02X), data: %s (offset %d)"),
                    src_name.c_str(),
                    src,
-                   direction.c_str(),
+                   direction.c_str(direction_s),
                    dest_name.c_str(),
                    dest,
-                   type_name.c_str(),
+                   type_name.c_str(type_name_s),
                    telegram->type_id,
                    telegram->to_string_message().c_str(),
                    offset);
@@ -534,10 +624,10 @@ std::string EMSESP::pretty_telegram(std::shared_ptr<const Telegram> telegram) {
                    PSTR("%s(0x%02X) %s %s(0x%02X), %s(0x%02X), data: %s"),
                    src_name.c_str(),
                    src,
-                   direction.c_str(),
+                   direction.c_str(direction_s),
                    dest_name.c_str(),
                    dest,
-                   type_name.c_str(),
+                   type_name.c_str(type_name_s),
                    telegram->type_id,
                    telegram->to_string_message().c_str());
     }
@@ -676,17 +766,18 @@ bool EMSESP::process_telegram(std::shared_ptr<const Telegram> telegram) {
     for (const auto & emsdevice : emsdevices) {
         if (emsdevice) {
             if (emsdevice->is_device_id(telegram->src)) {
-                knowndevice = true;
-                found       = emsdevice->handle_telegram(telegram);
-                // if we correctly processes the telegram follow up with sending it via MQTT if needed
-                if (found && Mqtt::connected()) {
-                    if ((mqtt_.get_publish_onchange(emsdevice->device_type()) && emsdevice->updated_values())
-                        || (telegram->type_id == publish_id_ && telegram->dest == txservice_.ems_bus_id())) {
-                        if (telegram->type_id == publish_id_) {
-                            publish_id_ = 0;
-                        }
-                        publish_device_values(emsdevice->device_type()); // publish to MQTT if we explicitly have too
-                    }
+                knowndevice          = true;
+                uint32_t old_version = emsdevice->value_version();
+                HEAP_SCOPE_DEVICE(emsdevice->device_type());
+                found = emsdevice->handle_telegram(telegram);
+                // let the subscribers know, i.e. MQTT publish on change and the web
+                if (found && (emsdevice->value_version() != old_version)) {
+                    Events::emit(Events::DEVICE_VALUES, emsdevice->device_type(), emsdevice->unique_id(), old_version, emsdevice->value_version());
+                }
+                // if this is the response we were waiting for, publish it via MQTT
+                if (found && Mqtt::connected() && (telegram->type_id == publish_id_) && (telegram->dest == txservice_.ems_bus_id())) {
+                    publish_id_ = 0;
+                    publish_device_values(emsdevice->device_type()); // publish to MQTT if we explicitly have too
                 }
                 break;
             }
@@ -827,6 +918,7 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, std::
         std::string name("unknown");
         emsdevices.push_back(
             EMSFactory::add(DeviceType::GENERIC, device_id, product_id, version, name, DeviceFlags::EMS_DEVICE_FLAG_NONE, EMSdevice::Brand::NO_BRAND));
+        snapshot_devices();
         return false; // not found
     }
 
@@ -836,6 +928,7 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, std::
     LOG_DEBUG(F("Adding new device %s (device ID 0x%02X, product ID %d, version %s)"), name.c_str(), device_id, product_id, version.c_str());
     emsdevices.push_back(EMSFactory::add(device_type, device_id, product_id, version, name, flags, brand));
     emsdevices.back()->unique_id(++unique_id_count_);
+    snapshot_devices();
 
     fetch_device_values(device_id); // go and fetch its data
 
@@ -851,6 +944,11 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, std::
     return true;
 }
 
+// the web task takes the list in one go, so it's copied once here rather than for every request
+void EMSESP::snapshot_devices() {
+    std::atomic_store(&emsdevices_snapshot_, std::make_shared<const std::vector<std::shared_ptr<EMSdevice>>>(emsdevices));
+}
+
 // export all values to info command
 // value and id are ignored
 bool EMSESP::command_info(uint8_t device_type, JsonObject & json, const int8_t id) {
@@ -895,13 +993,60 @@ void EMSESP::send_write_request(const uint16_t type_id, const uint8_t dest, cons
     EMSESP::send_write_request(type_id, dest, offset, message_data, 1, validate_typeid);
 }
 
+// the UART hands over what it has received here, from its own task or interrupt.
+// A poll for us is answered straight away, with what the loop has got ready in the Tx slot, and the answer to one
+// of our telegrams is followed by the poll ack that hands the bus back. Every frame is queued and processed in
+// the loop, which owns the Rx and Tx services, with the time it came in and whether it's been answered
+void EMSESP::incoming_frame(const uint8_t * data, const uint8_t length) {
+    if (txservice_.close_bus(data, length)) {
+        rx_frames_.push(data, length, true);
+        return;
+    }
+    bool poll = (length == 1) && txservice_.slot().polled(data[0]);
+    rx_frames_.push(data, length, poll);
+    if (poll) {
+        txservice_.answer_poll(rx_frames_.next()); // the loop takes what went out after the poll
+    }
+}
+
+// the frames the UART has received since the last time, oldest first
+// what went out on a poll is taken in between, after the frames that came in before it
+void EMSESP::process_frames() {
+    while (true) {
+        if (txservice_.slot().sent(rx_frames_.current())) {
+            txservice_.sent();
+        }
+        auto frame = rx_frames_.front();
+        if (frame == nullptr) {
+            break;
+        }
+        incoming_telegram(frame->data, frame->length, frame->time_ms, frame->time_us, frame->replied);
+        rx_frames_.pop();
+    }
+
+    // ready for the next poll, the first send is delayed after connect
+    if ((uuid::get_uptime_ms() - delayed_tx_start_) >= tx_delay_) {
+        txservice_.prepare();
+    }
+}
+
+// a frame that doesn't come through the Rx queue, e.g. from the tests, as if it had just come in
+void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
+    incoming_telegram(data, length, ::millis(), ::micros(), false);
+}
+
 // this is main entry point when data is received on the Rx line, via emsuart library
 // we check if its a complete telegram or just a single byte (which could be a poll or a return status)
 // the CRC check is not done here, only when it's added to the Rx queue with add()
-void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
+// replied is set when the receive context has already answered the poll or handed the bus back
+void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length, const uint32_t time_ms, const uint32_t time_us, const bool replied) {
 #ifdef EMSESP_UART_DEBUG
     static uint32_t rx_time_ = 0;
 #endif
+    HEAP_SCOPE(F("rx"));
+    buscapture_.incoming(data, length, time_us);  // raw capture, if there is one
+    busanalyser_.incoming(data, length, time_ms); // statistics of everything on the bus
+
     // check first for echo
     uint8_t first_value = data[0];
     if (((first_value & 0x7F) == txservice_.ems_bus_id()) && (length > 1)) {
@@ -915,8 +1060,10 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
     }
 
     // are we waiting for a response from a recent Tx Read or Write?
+    // a read is answered with a telegram to us, someone else's telegram in between doesn't end the wait
     uint8_t tx_state = EMSbus::tx_state();
-    if (tx_state != Telegram::Operation::NONE) {
+    bool    other    = (tx_state == Telegram::Operation::TX_READ) && (length > 1) && ((data[1] & 0x7F) != txservice_.ems_bus_id());
+    if ((tx_state != Telegram::Operation::NONE) && !other) {
         bool tx_successful = false;
         EMSbus::tx_state(Telegram::Operation::NONE); // reset Tx wait state
 
@@ -925,14 +1072,16 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
             if (first_value == TxService::TX_WRITE_SUCCESS) {
                 LOG_DEBUG(F("Last Tx write successful"));
                 txservice_.increment_telegram_write_count(); // last tx/write was confirmed ok
-                txservice_.send_poll();                      // close the bus
+                txservice_.send_poll(replied);               // close the bus
                 publish_id_ = txservice_.post_send_query();  // follow up with any post-read if set
                 txservice_.reset_retry_count();
+                txservice_.tx_success();
                 tx_successful = true;
             } else if (first_value == TxService::TX_WRITE_FAIL) {
                 LOG_ERROR(F("Last Tx write rejected by host"));
-                txservice_.send_poll(); // close the bus
+                txservice_.send_poll(replied); // close the bus
                 txservice_.reset_retry_count();
+                txservice_.tx_success(); // the device did answer
             }
         } else if (tx_state == Telegram::Operation::TX_READ) {
             // got a telegram with data in it. See if the src/dest matches that from the last one we sent and continue to process it
@@ -941,8 +1090,9 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
             if (txservice_.is_last_tx(src, dest)) {
                 LOG_DEBUG(F("Last Tx read successful"));
                 txservice_.increment_telegram_read_count();
-                txservice_.send_poll(); // close the bus
+                txservice_.send_poll(replied); // close the bus
                 txservice_.reset_retry_count();
+                txservice_.tx_success();
                 tx_successful = true;
                 // if telegram is longer read next part with offset + 25 for ems+
                 if (length == 32) {
@@ -961,7 +1111,6 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
     }
     // check for poll
     if (length == 1) {
-        static uint64_t delayed_tx_start_ = 0;
         if (!rxservice_.bus_connected() && (tx_delay_ > 0)) {
             delayed_tx_start_ = uuid::get_uptime_ms();
             LOG_DEBUG(F("Tx delay started"));
@@ -986,7 +1135,8 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
 #endif
         // check for poll to us, if so send top message from Tx queue immediately and quit
         // if ht3 poll must be ems_bus_id else if Buderus poll must be (ems_bus_id | 0x80)
-        if ((first_value ^ 0x80 ^ rxservice_.ems_mask()) == txservice_.ems_bus_id()) {
+        // the receive task answers these itself once the slot knows our poll, only one it hasn't is answered here
+        if (!replied && ((first_value ^ 0x80 ^ rxservice_.ems_mask()) == txservice_.ems_bus_id())) {
             txservice_.send();
         }
         // send remote room temperature if active
@@ -1010,6 +1160,10 @@ void EMSESP::send_raw_telegram(const char * data) {
 // start all the core services
 // the services must be loaded in the correct order
 void EMSESP::start() {
+#if defined(EMSESP_HEAP_PROFILER)
+    HeapProfiler::start();
+#endif
+
     // see if we need to migrate from previous versions
     if (!system_.check_upgrade()) {
 #ifdef ESP32
@@ -1032,6 +1186,28 @@ void EMSESP::start() {
     mqtt_.start();         // mqtt init
     system_.start();       // starts syslog, uart, sets version, initializes LED. Requires pre-loaded settings.
     shower_.start();       // initialize shower timer and shower alert
+    busanalyser_.start();  // bus statistics
+
+    // services called from loop(), Rx first and again after each slower one
+    scheduler_.add(F("rx"), Scheduler::PRIORITY_HIGH, 0, [] {
+        process_frames();
+        rxservice_.loop();
+    });
+    scheduler_.add(F("console"), Scheduler::PRIORITY_NORMAL, 0, [] { console_.loop(); });
+    scheduler_.add(F("system"), Scheduler::PRIORITY_NORMAL, 0, [] { system_.loop(); });
+    scheduler_.add(F("web"), Scheduler::PRIORITY_NORMAL, 0, [] { webDevicesService.loop(); });
+    scheduler_.add(F("shower"), Scheduler::PRIORITY_NORMAL, SHOWER_INTERVAL, [] { shower_.loop(); });
+    scheduler_.add(F("dallas"), Scheduler::PRIORITY_LOW, 0, [] { dallassensor_.loop(); });
+    scheduler_.add(F("publish"), Scheduler::PRIORITY_LOW, 0, [] { publish_all_loop(); });
+    scheduler_.add(F("mqtt"), Scheduler::PRIORITY_LOW, 0, [] { mqtt_.loop(); });
+    scheduler_.add(F("fetch"), Scheduler::PRIORITY_LOW, EMS_FETCH_FREQUENCY, [] { fetch_device_values(); }); // latest data from the EMS devices
+    scheduler_.add(F("history"), Scheduler::PRIORITY_LOW, History::SAMPLE_INTERVAL, [] { history_.loop(); });
+    scheduler_.add(F("stats"), Scheduler::PRIORITY_LOW, STATS_INTERVAL, [] { publish_statistics_loop(); });
+
+    // react to value changes
+    Events::subscribe(Events::DEVICE_VALUES, device_values_changed);
+    Events::subscribe(Events::DEVICE_VALUES, [](const Events::Event & event) { webDevicesService.device_values_changed(event.unique_id_); });
+    Events::subscribe(Events::TAP_WATER_ACTIVE, [](const Events::Event & event) { shower_.tap_water_active(event.new_value_); });
     dallassensor_.start(); // dallas external sensors
     webServer.begin();     // start web server
 
@@ -1053,19 +1229,7 @@ void EMSESP::loop() {
         return;
     }
 
-    system_.loop();       // does LED and checks system health, and syslog service
-    rxservice_.loop();    // process any incoming Rx telegrams
-    shower_.loop();       // check for shower on/off
-    dallassensor_.loop(); // this will also send out via MQTT
-    publish_all_loop();   // See which topics need publishing to MQTT and queue them
-    mqtt_.loop();         // sends out anything in the MQTT queue
-    console_.loop();      // telnet/serial console
-
-    // force a query on the EMS devices to fetch latest data at a set interval (1 min)
-    if ((uuid::get_uptime() - last_fetch_ > EMS_FETCH_FREQUENCY)) {
-        last_fetch_ = uuid::get_uptime();
-        fetch_device_values();
-    }
+    scheduler_.loop(); // system, Rx, shower, dallas, MQTT, web and console, see start()
 
     delay(1); // helps telnet catch up
 }
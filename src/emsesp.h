@@ -21,6 +21,7 @@
 
 #include <Arduino.h>
 
+#include <memory>
 #include <vector>
 #include <queue>
 #include <string>
@@ -38,6 +39,9 @@
 #include "WebDevicesService.h"
 #include "WebSettingsService.h"
 #include "WebAPIService.h"
+#include "WebMetricsService.h"
+#include "WebCaptureService.h"
+#include "WebHistoryService.h"
 
 #include "emsdevice.h"
 #include "emsfactory.h"
@@ -47,18 +51,33 @@
 #include "dallassensor.h"
 #include "console.h"
 #include "shower.h"
+#include "busanalyser.h"
+#include "buscapture.h"
+#include "history.h"
+#include "jsonpool.h"
+#include "framequeue.h"
+#include "events.h"
+#include "scheduler.h"
+#include "heapprofiler.h"
 #include "roomcontrol.h"
 #include "command.h"
 
 #define WATCH_ID_NONE 0 // no watch id set
 
-#define EMSESP_MAX_JSON_SIZE_HA_CONFIG 384   // for small HA config payloads, using StaticJsonDocument
-#define EMSESP_MAX_JSON_SIZE_SMALL 256       // for smaller json docs, using StaticJsonDocument
-#define EMSESP_MAX_JSON_SIZE_MEDIUM 768      // for medium json docs from ems devices, using StaticJsonDocument
-#define EMSESP_MAX_JSON_SIZE_LARGE 1024      // for large json docs from ems devices, like boiler or thermostat data, using StaticJsonDocument
-#define EMSESP_MAX_JSON_SIZE_MEDIUM_DYN 1024 // for large json docs, using DynamicJsonDocument
-#define EMSESP_MAX_JSON_SIZE_LARGE_DYN 2048  // for very large json docs, using DynamicJsonDocument
-#define EMSESP_MAX_JSON_SIZE_MAX_DYN 4096    // for very very large json docs, using DynamicJsonDocument
+// frames from the UART waiting for the loop
+#if defined(ESP8266)
+#define EMSESP_RX_FRAMES 8
+#else
+#define EMSESP_RX_FRAMES 16
+#endif
+
+#define EMSESP_MAX_JSON_SIZE_HA_CONFIG 384   // for small HA config payloads
+#define EMSESP_MAX_JSON_SIZE_SMALL 256       // for smaller json docs
+#define EMSESP_MAX_JSON_SIZE_MEDIUM 768      // for medium json docs from ems devices
+#define EMSESP_MAX_JSON_SIZE_LARGE 1024      // for large json docs from ems devices, like boiler or thermostat data
+#define EMSESP_MAX_JSON_SIZE_MEDIUM_DYN 1024 // for large json docs
+#define EMSESP_MAX_JSON_SIZE_LARGE_DYN 2048  // for very large json docs
+#define EMSESP_MAX_JSON_SIZE_MAX_DYN 4096    // for very very large json docs
 
 namespace emsesp {
 
@@ -73,6 +92,7 @@ class EMSESP {
     static void publish_other_values();
     static void publish_sensor_values(const bool time, const bool force = false);
     static void publish_all(bool force = false);
+    static void publish_statistics();
 
 #ifdef EMSESP_STANDALONE
     static void run_test(uuid::console::Shell & shell, const std::string & command); // only for testing
@@ -100,7 +120,13 @@ class EMSESP {
 
     static void device_info_web(const uint8_t unique_id, JsonObject & root);
 
-    static uint8_t count_devices(const uint8_t device_type);
+    static uint8_t  count_devices(const uint8_t device_type);
+    static uint32_t value_version(const uint8_t device_type);
+
+    // every time a device gets new data it takes the next value version, so versions only go up
+    static uint32_t next_value_version() {
+        return ++value_version_;
+    }
 
     static uint8_t actual_master_thermostat();
     static void    actual_master_thermostat(const uint8_t device_id);
@@ -111,10 +137,13 @@ class EMSESP {
 
     static void show_devices(uuid::console::Shell & shell);
     static void show_ems(uuid::console::Shell & shell);
+    static void show_statistics(uuid::console::Shell & shell);
 
     static void init_tx();
 
     static void incoming_telegram(uint8_t * data, const uint8_t length);
+    static void incoming_telegram(uint8_t * data, const uint8_t length, const uint32_t time_ms, const uint32_t time_us, const bool replied);
+    static void incoming_frame(const uint8_t * data, const uint8_t length); // from the UART's receive context
 
     static const std::vector<DallasSensor::Sensor> sensor_devices() {
         return dallassensor_.sensors();
@@ -162,8 +191,15 @@ class EMSESP {
         trace_raw_ = set;
     }
 
+    static void stats_publish(const uint8_t minutes) {
+        stats_publish_ = minutes;
+    }
+
     static void tap_water_active(const bool tap_water_active) {
-        tap_water_active_ = tap_water_active;
+        if (tap_water_active != tap_water_active_) {
+            tap_water_active_ = tap_water_active;
+            Events::emit(Events::TAP_WATER_ACTIVE, EMSdevice::DeviceType::BOILER, 0, !tap_water_active, tap_water_active);
+        }
     }
 
     static void fetch_device_values(const uint8_t device_id = 0);
@@ -175,7 +211,12 @@ class EMSESP {
         return (uint32_t) (tx_delay_ / 1000ul);
     }
 
-    static std::vector<std::unique_ptr<EMSdevice>> emsdevices;
+    static std::vector<std::shared_ptr<EMSdevice>> emsdevices;
+
+    // a copy of emsdevices for the async web task, which mustn't look at the list while the loop adds to it
+    static std::shared_ptr<const std::vector<std::shared_ptr<EMSdevice>>> emsdevices_snapshot() {
+        return std::atomic_load(&emsdevices_snapshot_);
+    }
 
     // services
     static Mqtt         mqtt_;
@@ -185,6 +226,10 @@ class EMSESP {
     static Shower       shower_;
     static RxService    rxservice_;
     static TxService    txservice_;
+    static BusAnalyser  busanalyser_;
+    static BusCapture   buscapture_;
+    static History      history_;
+    static Scheduler    scheduler_;
 
     // web controllers
     static ESP8266React       esp8266React;
@@ -192,6 +237,9 @@ class EMSESP {
     static WebStatusService   webStatusService;
     static WebDevicesService  webDevicesService;
     static WebAPIService      webAPIService;
+    static WebMetricsService  webMetricsService;
+    static WebCaptureService  webCaptureService;
+    static WebHistoryService  webHistoryService;
 
     static uuid::log::Logger logger() {
         return logger_;
@@ -206,13 +254,18 @@ class EMSESP {
 
     static void process_UBADevices(std::shared_ptr<const Telegram> telegram);
     static void process_version(std::shared_ptr<const Telegram> telegram);
+    static void device_values_changed(const Events::Event & event);
     static void publish_response(std::shared_ptr<const Telegram> telegram);
     static void publish_all_loop();
+    static void process_frames();
+    static void publish_statistics_loop();
+    static void snapshot_devices();
 
     static bool command_info(uint8_t device_type, JsonObject & json, const int8_t id);
 
     static constexpr uint32_t EMS_FETCH_FREQUENCY = 60000; // check every minute
-    static uint32_t           last_fetch_;
+    static constexpr uint32_t SHOWER_INTERVAL     = 1000;  // shower timers, starting and stopping is done by event
+    static constexpr uint32_t STATS_INTERVAL      = 60000; // statistics are published in whole minutes
 
     struct Device_record {
         uint8_t                     product_id;
@@ -223,6 +276,8 @@ class EMSESP {
 
     static std::vector<Device_record> device_library_;
 
+    static std::shared_ptr<const std::vector<std::shared_ptr<EMSdevice>>> emsdevices_snapshot_; // replaced, never changed
+
     static uint8_t  actual_master_thermostat_;
     static uint16_t watch_id_;
     static uint8_t  watch_;
@@ -234,7 +289,12 @@ class EMSESP {
     static uint8_t  unique_id_count_;
     static bool     trace_raw_;
     static uint64_t tx_delay_;
+    static uint64_t delayed_tx_start_; // when the bus came back, sending waits tx_delay_ after it
     static bool     force_scan_;
+    static uint32_t value_version_;
+    static uint8_t  stats_publish_;
+
+    static FrameQueue<EMSESP_RX_FRAMES, EMS_MAXBUFFERSIZE> rx_frames_;
 };
 
 } // namespace emsesp
@@ -0,0 +1,55 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "events.h"
+#include "emsesp.h"
+
+namespace emsesp {
+
+Events::Subscriber Events::subscribers_[Events::MAX_SUBSCRIBERS];
+uint8_t            Events::num_subscribers_ = 0;
+uint32_t           Events::counts_[Events::NUM_TYPES];
+
+uuid::log::Logger Events::logger_{F_(emsesp), uuid::log::Facility::KERN};
+
+// returns false if the table is full
+bool Events::subscribe(const uint8_t type, Handler handler) {
+    if ((type >= NUM_TYPES) || (num_subscribers_ >= MAX_SUBSCRIBERS)) {
+        LOG_ERROR(F("Can't subscribe to event %d"), type);
+        return false;
+    }
+    subscribers_[num_subscribers_++] = {type, handler};
+    return true;
+}
+
+// calls the subscribers in the order they subscribed
+void Events::emit(const uint8_t type, const uint8_t device_type, const uint8_t unique_id, const int32_t old_value, const int32_t new_value) {
+    if (type >= NUM_TYPES) {
+        return;
+    }
+    counts_[type]++;
+
+    Event event = {type, device_type, unique_id, old_value, new_value};
+    for (uint8_t i = 0; i < num_subscribers_; i++) {
+        if (subscribers_[i].type_ == type) {
+            subscribers_[i].handler_(event);
+        }
+    }
+}
+
+} // namespace emsesp
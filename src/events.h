@@ -0,0 +1,73 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_EVENTS_H
+#define EMSESP_EVENTS_H
+
+#include <Arduino.h>
+
+#include <uuid/log.h>
+
+namespace emsesp {
+
+// value change events, delivered straight away to whoever subscribed to them
+// subscribers are plain functions in a fixed table, so nothing is allocated
+class Events {
+  public:
+    enum Type : uint8_t {
+        DEVICE_VALUES = 0, // values of an EMS device changed, old/new is its value version
+        TAP_WATER_ACTIVE,  // hot water started or stopped, old/new is 0 or 1
+        SENSOR_VALUES,     // a Dallas sensor changed, old/new is the number of sensors
+        NUM_TYPES
+    };
+
+    struct Event {
+        uint8_t type_;
+        uint8_t device_type_;
+        uint8_t unique_id_; // of the EMS device, 0 if not from a device
+        int32_t old_value_;
+        int32_t new_value_;
+    };
+
+    typedef void (*Handler)(const Event & event);
+
+    static bool subscribe(const uint8_t type, Handler handler);
+    static void emit(const uint8_t type, const uint8_t device_type, const uint8_t unique_id, const int32_t old_value, const int32_t new_value);
+
+    static uint32_t count(const uint8_t type) {
+        return (type < NUM_TYPES) ? counts_[type] : 0;
+    }
+
+  private:
+    static uuid::log::Logger logger_;
+
+    static constexpr uint8_t MAX_SUBSCRIBERS = 8;
+
+    struct Subscriber {
+        uint8_t type_;
+        Handler handler_;
+    };
+
+    static Subscriber subscribers_[MAX_SUBSCRIBERS];
+    static uint8_t    num_subscribers_;
+    static uint32_t   counts_[NUM_TYPES]; // events emitted, by type
+};
+
+} // namespace emsesp
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_FIXEDPOINT_H
+#define EMSESP_FIXEDPOINT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+namespace emsesp {
+
+// a value as it comes from the telegram, e.g. a temperature in 0.1 degrees, with its divider.
+// It's rendered as a decimal with integer maths only, the ESP8266 has no FPU and
+// a float like 20.3 would come back as 20.299999. In json it goes in as the rendered number:
+//   json["curFlowTemp"] = FixedPoint(curFlowTemp_, 10).json();
+class FixedPoint {
+  public:
+    static constexpr size_t MAX_LENGTH = 14; // -2147483648 with a dot and up to 3 decimals
+
+    FixedPoint(const int32_t value, const uint16_t divider = 1)
+        : value_(value)
+        , divider_(divider ? divider : 1) {
+    }
+
+    int32_t value() const {
+        return value_;
+    }
+
+    uint16_t divider() const {
+        return divider_;
+    }
+
+    // the decimals are what the divider needs, 1 for 10 and 2, 2 for 100 and 4.
+    // With trim the trailing zeros go, like a json number: 21.0 is 21
+    char * render(char * result, const size_t size, const bool trim = false) const {
+        uint32_t scale    = 1;
+        uint8_t  decimals = 0;
+        while ((scale % divider_) && (decimals < 3)) {
+            scale *= 10;
+            decimals++;
+        }
+
+        // a divider like 3 that doesn't go into a power of ten is rounded on the third decimal
+        int64_t scaled = (int64_t)value_ * scale;
+        if (scale % divider_) {
+            scaled = (scaled + ((scaled < 0) ? -(int64_t)(divider_ / 2) : (int64_t)(divider_ / 2))) / divider_;
+        } else {
+            scaled /= divider_;
+        }
+
+        char     text[MAX_LENGTH + 1];
+        char *   p         = text + sizeof(text);
+        uint64_t magnitude = (scaled < 0) ? -scaled : scaled;
+        *--p               = '\0';
+        for (uint8_t i = 0; i < decimals; i++) {
+            uint8_t digit = magnitude % 10;
+            magnitude /= 10;
+            if (trim && (digit == 0) && (*p == '\0')) {
+                continue; // a trailing zero
+            }
+            *--p = '0' + digit;
+        }
+        if (*p != '\0') {
+            *--p = '.';
+        }
+        do {
+            *--p = '0' + (magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude);
+        if (scaled < 0) {
+            *--p = '-';
+        }
+
+        strlcpy(result, p, size);
+        return result;
+    }
+
+    // the rendered number, for a json document. ArduinoJson copies it and writes it out as it is
+    ARDUINOJSON_NAMESPACE::SerializedValue<char *> json() const {
+        return serialized(render(text_, sizeof(text_), true));
+    }
+
+    // for what really needs a float, like a MessagePack payload
+    float to_float() const {
+        return (float)value_ / divider_;
+    }
+
+  private:
+    int32_t      value_;
+    uint16_t     divider_;
+    mutable char text_[MAX_LENGTH + 1];
+};
+
+} // namespace emsesp
+
+#endif
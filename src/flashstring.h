@@ -0,0 +1,158 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_FLASHSTRING_H
+#define EMSESP_FLASHSTRING_H
+
+#include <Arduino.h>
+
+#include <string>
+
+namespace emsesp {
+
+// a PROGMEM string that is read where it is, instead of being copied into a std::string
+// with uuid::read_flash_string(). Every byte goes through pgm_read_byte so it's safe on the ESP8266.
+// ArduinoJson copies a __FlashStringHelper from flash itself, so hand it get()
+class FlashStringView {
+  public:
+    FlashStringView(const __FlashStringHelper * str = nullptr)
+        : str_(str) {
+    }
+
+    const __FlashStringHelper * get() const {
+        return str_;
+    }
+
+    bool empty() const {
+        return (str_ == nullptr) || (at(0) == '\0');
+    }
+
+    size_t length() const {
+        size_t length = 0;
+        if (str_ != nullptr) {
+            while (at(length) != '\0') {
+                length++;
+            }
+        }
+        return length;
+    }
+
+    char operator[](const size_t i) const {
+        return at(i);
+    }
+
+    bool operator==(const char * other) const {
+        if (other == nullptr) {
+            return empty();
+        }
+        size_t i = 0;
+        char   c;
+        do {
+            c = at(i);
+            if (c != other[i]) {
+                return false;
+            }
+            i++;
+        } while (c != '\0');
+        return true;
+    }
+
+    bool operator==(const FlashStringView & other) const {
+        if (str_ == other.str_) {
+            return true;
+        }
+        size_t i = 0;
+        char   c;
+        do {
+            c = at(i);
+            if (c != other.at(i)) {
+                return false;
+            }
+            i++;
+        } while (c != '\0');
+        return true;
+    }
+
+    bool operator!=(const char * other) const {
+        return !(*this == other);
+    }
+
+    bool operator!=(const FlashStringView & other) const {
+        return !(*this == other);
+    }
+
+    // FNV-1a, the same as Helpers::hash() of the string in RAM
+    uint32_t hash(uint32_t seed = 2166136261u) const {
+        char c;
+        for (size_t i = 0; (c = at(i)) != '\0'; i++) {
+            seed ^= (uint8_t)c;
+            seed *= 16777619u;
+        }
+        return seed;
+    }
+
+    // like strlcpy, returns the length of the string so a truncation can be spotted
+    size_t copy(char * buffer, const size_t size) const {
+        size_t length = 0;
+        char   c;
+        while ((c = at(length)) != '\0') {
+            if (length + 1 < size) {
+                buffer[length] = c;
+            }
+            length++;
+        }
+        if (size) {
+            buffer[(length < size) ? length : size - 1] = '\0';
+        }
+        return length;
+    }
+
+    // like strlcat
+    size_t append(char * buffer, const size_t size) const {
+        size_t used = strnlen(buffer, size);
+        if (used == size) {
+            return size + length();
+        }
+        return used + copy(buffer + used, size - used);
+    }
+
+    // a copy in a buffer on the stack, for %s in snprintf_P
+    template <size_t N>
+    const char * c_str(char (&buffer)[N]) const {
+        copy(buffer, N);
+        return buffer;
+    }
+
+    // only when a std::string is really needed
+    std::string str() const {
+        std::string s(length(), '\0');
+        copy(&s[0], s.size() + 1);
+        return s;
+    }
+
+  private:
+    char at(const size_t i) const {
+        return (str_ == nullptr) ? '\0' : (char)pgm_read_byte(reinterpret_cast<PGM_P>(str_) + i);
+    }
+
+    const __FlashStringHelper * str_;
+};
+
+} // namespace emsesp
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef EMSESP_FRAMEQUEUE_H
+#define EMSESP_FRAMEQUEUE_H
+
+#include <Arduino.h>
+
+#include <atomic>
+
+namespace emsesp {
+
+// frames handed from one producer to one consumer, e.g. from the UART's receive task to the main loop.
+// It's a ring of fixed size, without locks or allocation. Only the producer moves head_ and only the consumer
+// moves tail_. A frame is written before head_ is moved past it and read before tail_ is, the release and
+// acquire make sure the other side sees it that way. When it's full the new frame is dropped and counted
+template <uint8_t CAPACITY, uint8_t FRAME_SIZE>
+class FrameQueue {
+  public:
+    struct Frame {
+        uint8_t  length;
+        uint8_t  data[FRAME_SIZE];
+        uint32_t time_ms; // when it came in, the loop can get to it a lot later
+        uint32_t time_us;
+        bool     replied; // the producer has already sent what goes after it on the bus
+    };
+
+    // producer, a frame longer than FRAME_SIZE is cut
+    bool push(const uint8_t * data, const uint8_t length, const bool replied = false) {
+        uint8_t head = head_.load(std::memory_order_relaxed);
+        uint8_t next = advance(head);
+        if (next == tail_.load(std::memory_order_acquire)) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // only we write it
+            return false;
+        }
+        Frame & frame = frames_[head];
+        frame.length  = (length < FRAME_SIZE) ? length : FRAME_SIZE;
+        memcpy(frame.data, data, frame.length);
+        frame.time_ms = ::millis();
+        frame.time_us = ::micros();
+        frame.replied = replied;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // consumer, the oldest frame or nullptr. It's ours until pop()
+    Frame * front() {
+        uint8_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &frames_[tail];
+    }
+
+    void pop() {
+        tail_.store(advance(tail_.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    bool empty() const {
+        return tail_.load(std::memory_order_relaxed) == head_.load(std::memory_order_acquire);
+    }
+
+    uint32_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    // producer, where the next frame goes
+    uint8_t next() const {
+        return head_.load(std::memory_order_relaxed);
+    }
+
+    // consumer, where the frame front() gives is. It gets to next() once it has taken all the frames before it
+    uint8_t current() const {
+        return tail_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    static uint8_t advance(const uint8_t index) {
+        return (index == CAPACITY) ? 0 : index + 1;
+    }
+
+    Frame                 frames_[CAPACITY + 1]; // one is always free, so a full ring isn't taken for an empty one
+    std::atomic<uint8_t>  head_{0};              // the next frame to write
+    std::atomic<uint8_t>  tail_{0};              // the next frame to read
+    std::atomic<uint32_t> dropped_{0};
+};
+
+} // namespace emsesp
+
+#endif
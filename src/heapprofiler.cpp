@@ -0,0 +1,251 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "heapprofiler.h"
+
+#if defined(EMSESP_STANDALONE) && defined(EMSESP_HEAP_PROFILER)
+
+#include "emsdevice.h"
+
+#include <uuid/common.h>
+
+#include <algorithm>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <new>
+
+namespace emsesp {
+
+// all zero or constant initialised, operator new can be called before any constructor has run
+HeapProfiler::Tag     HeapProfiler::tags_[HeapProfiler::MAX_TAGS];
+std::mutex            HeapProfiler::tags_mutex_;
+thread_local uint8_t  HeapProfiler::current_ = 0;
+std::atomic<bool>     HeapProfiler::enabled_{false};
+std::atomic<uint32_t> HeapProfiler::in_use_{0};
+std::atomic<uint32_t> HeapProfiler::peak_{0};
+
+HeapProfiler::Scope::Scope(const __FlashStringHelper * name, const uint8_t device_type)
+    : previous_(current_) {
+    current_ = tag(name, device_type);
+}
+
+HeapProfiler::Scope::~Scope() {
+    current_ = previous_;
+}
+
+// counting is switched on by the environment, so any run can be profiled without a rebuild
+void HeapProfiler::start() {
+    if (getenv("EMSESP_HEAP_PROFILE") != nullptr) {
+        enable(true);
+    }
+}
+
+void HeapProfiler::enable(const bool enable) {
+    static bool at_exit_set = false;
+    if (enable && !at_exit_set) {
+        at_exit_set = true;
+        atexit(at_exit);
+    }
+    enabled_ = enable;
+}
+
+// finds the tag, or adds it. When the table is full it goes to the untagged slot
+uint8_t HeapProfiler::tag(const __FlashStringHelper * name, const uint8_t device_type) {
+    std::lock_guard<std::mutex> lock(tags_mutex_);
+    for (uint8_t i = 1; i < MAX_TAGS; i++) {
+        if (tags_[i].name_ == nullptr) {
+            tags_[i].name_        = name;
+            tags_[i].device_type_ = device_type;
+            return i;
+        }
+        if ((tags_[i].device_type_ == device_type)
+            && ((tags_[i].name_ == name) || !strcmp(reinterpret_cast<const char *>(tags_[i].name_), reinterpret_cast<const char *>(name)))) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+uint8_t HeapProfiler::bucket(const size_t size) {
+    uint8_t bucket = 0;
+    for (size_t limit = 16; (size > limit) && (bucket < NUM_BUCKETS - 1); limit <<= 1) {
+        bucket++;
+    }
+    return bucket;
+}
+
+void HeapProfiler::raise(std::atomic<uint32_t> & peak, const uint32_t value) {
+    uint32_t current = peak.load(std::memory_order_relaxed);
+    while ((value > current) && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void * HeapProfiler::allocate(const size_t size) {
+    uint8_t * block = static_cast<uint8_t *>(malloc(size + HEADER_SIZE));
+    if (block == nullptr) {
+        return nullptr;
+    }
+
+    Header * header  = reinterpret_cast<Header *>(block);
+    header->size_    = size;
+    header->tag_     = current_;
+    header->counted_ = enabled();
+
+    if (header->counted_) {
+        Tag & tag = tags_[current_];
+        tag.allocs_.fetch_add(1, std::memory_order_relaxed);
+        tag.bytes_.fetch_add(size, std::memory_order_relaxed);
+        raise(tag.peak_, tag.in_use_.fetch_add(size, std::memory_order_relaxed) + size);
+        tag.buckets_[bucket(size)].fetch_add(1, std::memory_order_relaxed);
+        raise(peak_, in_use_.fetch_add(size, std::memory_order_relaxed) + size);
+    }
+
+    return block + HEADER_SIZE;
+}
+
+void HeapProfiler::release(void * ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    uint8_t * block  = static_cast<uint8_t *>(ptr) - HEADER_SIZE;
+    Header *  header = reinterpret_cast<Header *>(block);
+
+    // a block from before counting started is left out, or in use would go below zero
+    if (header->counted_) {
+        Tag & tag = tags_[header->tag_];
+        tag.frees_.fetch_add(1, std::memory_order_relaxed);
+        tag.in_use_.fetch_sub(header->size_, std::memory_order_relaxed);
+        in_use_.fetch_sub(header->size_, std::memory_order_relaxed);
+    }
+
+    free(block);
+}
+
+// e.g. mqtt or device:boiler
+std::string HeapProfiler::tag_name(const uint8_t i) {
+    if (i == 0) {
+        return "other";
+    }
+    std::string name = uuid::read_flash_string(tags_[i].name_);
+    if (tags_[i].device_type_ != NO_DEVICE) {
+        name += ":" + EMSdevice::device_type_2_device_name(tags_[i].device_type_);
+    }
+    return name;
+}
+
+void HeapProfiler::print_row(Print & out, const char * format, ...) {
+    char    line[120];
+    va_list ap;
+    va_start(ap, format);
+    vsnprintf(line, sizeof(line), format, ap);
+    va_end(ap);
+    out.print(line);
+    out.println();
+}
+
+void HeapProfiler::show(Print & out) {
+    // the report itself shouldn't be counted
+    bool was_enabled = enabled_.exchange(false);
+
+    if (!was_enabled) {
+        print_row(out, "Heap profiler is off, set EMSESP_HEAP_PROFILE to switch it on");
+        return;
+    }
+
+    print_row(out, "Heap allocations by subsystem (in use %u bytes, peak %u bytes):", in_use_.load(), peak_.load());
+    print_row(out, " %-18s %8s %8s %10s %8s %8s", "tag", "allocs", "frees", "bytes", "in use", "peak");
+    for (uint8_t i = 0; i < MAX_TAGS; i++) {
+        const Tag & tag = tags_[i];
+        if ((i && (tag.name_ == nullptr)) || (tag.allocs_ == 0)) {
+            continue;
+        }
+        print_row(out,
+                  " %-18s %8u %8u %10llu %8u %8u",
+                  tag_name(i).c_str(),
+                  tag.allocs_.load(),
+                  tag.frees_.load(),
+                  (unsigned long long)tag.bytes_.load(),
+                  tag.in_use_.load(),
+                  tag.peak_.load());
+    }
+
+    print_row(out, "Allocation sizes:");
+    print_row(out, " %-18s %6s %6s %6s %6s %6s %6s %6s %6s", "tag", "<=16", "<=32", "<=64", "<=128", "<=256", "<=512", "<=1k", ">1k");
+    for (uint8_t i = 0; i < MAX_TAGS; i++) {
+        const Tag & tag = tags_[i];
+        if ((i && (tag.name_ == nullptr)) || (tag.allocs_ == 0)) {
+            continue;
+        }
+        uint32_t b[NUM_BUCKETS];
+        for (uint8_t j = 0; j < NUM_BUCKETS; j++) {
+            b[j] = tag.buckets_[j].load();
+        }
+        print_row(out, " %-18s %6u %6u %6u %6u %6u %6u %6u %6u", tag_name(i).c_str(), b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7]);
+    }
+    out.println();
+
+    enabled_.store(was_enabled);
+}
+
+void HeapProfiler::at_exit() {
+    if (enabled()) {
+        show(Serial);
+    }
+}
+
+} // namespace emsesp
+
+// every new and delete in the program goes through the profiler
+void * operator new(size_t size) {
+    void * ptr = emsesp::HeapProfiler::allocate(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void * operator new[](size_t size) {
+    return operator new(size);
+}
+
+void * operator new(size_t size, const std::nothrow_t &) noexcept {
+    return emsesp::HeapProfiler::allocate(size);
+}
+
+void * operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return emsesp::HeapProfiler::allocate(size);
+}
+
+void operator delete(void * ptr) noexcept {
+    emsesp::HeapProfiler::release(ptr);
+}
+
+void operator delete[](void * ptr) noexcept {
+    emsesp::HeapProfiler::release(ptr);
+}
+
+void operator delete(void * ptr, const std::nothrow_t &) noexcept {
+    emsesp::HeapProfiler::release(ptr);
+}
+
+void operator delete[](void * ptr, const std::nothrow_t &) noexcept {
+    emsesp::HeapProfiler::release(ptr);
+}
+
+#endif
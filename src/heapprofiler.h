@@ -0,0 +1,111 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_HEAPPROFILER_H
+#define EMSESP_HEAPPROFILER_H
+
+#include <Arduino.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#if defined(EMSESP_STANDALONE) && defined(EMSESP_HEAP_PROFILER)
+
+namespace emsesp {
+
+// counts what operator new and delete do, by the subsystem that was running at the time
+// only in a standalone build made with EMSESP_HEAP_PROFILER, as every block then gets a 16 byte header,
+// and only once enabled, with the environment variable EMSESP_HEAP_PROFILE or from a test.
+// The report is shown with "show heap" and when the program exits.
+// The bus thread allocates too, so the counters are atomic and each thread has its own current tag
+class HeapProfiler {
+  public:
+    // everything allocated while it's in scope goes to the tag, the innermost one wins
+    class Scope {
+      public:
+        Scope(const __FlashStringHelper * name, const uint8_t device_type = NO_DEVICE);
+        ~Scope();
+
+      private:
+        uint8_t previous_;
+    };
+
+    static constexpr uint8_t NO_DEVICE = 0xFF;
+
+    static void start();
+    static void enable(const bool enable);
+    static bool enabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    static void show(Print & out);
+
+    static void * allocate(const size_t size);
+    static void   release(void * ptr);
+
+  private:
+    static constexpr uint8_t MAX_TAGS    = 32;
+    static constexpr uint8_t NUM_BUCKETS = 8; // up to 16 bytes, 32, ... 1024 and bigger
+    static constexpr size_t  HEADER_SIZE = 16; // in front of every block, keeps the alignment of new
+
+    struct Header {
+        uint32_t size_;
+        uint8_t  tag_;
+        bool     counted_; // false if it was allocated before counting started
+    };
+
+    struct Tag {
+        const __FlashStringHelper * name_; // nullptr if the slot is free, slot 0 is everything untagged
+        uint8_t                     device_type_;
+        std::atomic<uint32_t>       allocs_;
+        std::atomic<uint32_t>       frees_;
+        std::atomic<uint64_t>       bytes_;  // all allocated
+        std::atomic<uint32_t>       in_use_; // bytes
+        std::atomic<uint32_t>       peak_;
+        std::atomic<uint32_t>       buckets_[NUM_BUCKETS];
+    };
+
+    static uint8_t     tag(const __FlashStringHelper * name, const uint8_t device_type);
+    static uint8_t     bucket(const size_t size);
+    static void        raise(std::atomic<uint32_t> & peak, const uint32_t value);
+    static std::string tag_name(const uint8_t i);
+    static void        print_row(Print & out, const char * format, ...);
+    static void        at_exit();
+
+    static Tag                   tags_[MAX_TAGS];
+    static std::mutex            tags_mutex_; // for adding a tag, the counters don't need it
+    static thread_local uint8_t  current_;
+    static std::atomic<bool>     enabled_;
+    static std::atomic<uint32_t> in_use_;
+    static std::atomic<uint32_t> peak_;
+};
+
+} // namespace emsesp
+
+#define HEAP_SCOPE(name) HeapProfiler::Scope heap_scope_(name)
+#define HEAP_SCOPE_DEVICE(device_type) HeapProfiler::Scope heap_scope_(F("device"), device_type)
+
+#else
+
+#define HEAP_SCOPE(name)
+#define HEAP_SCOPE_DEVICE(device_type)
+
+#endif
+
+#endif
@@ -17,6 +17,7 @@
  */
 
 #include "helpers.h"
+#include "metricsobject.h"
 
 namespace emsesp {
 
@@ -124,7 +125,8 @@ char * Helpers::smallitoa(char * result, const uint16_t value) {
 }
 
 // set a json value to boolean format
-void Helpers::json_boolean(JsonObject & json, const char * name, uint8_t value) {
+template <typename Json>
+void Helpers::json_boolean(Json & json, const char * name, uint8_t value) {
     if (value == EMS_VALUE_BOOL_NOTSET) {
         return;
     }
@@ -140,7 +142,8 @@ void Helpers::json_boolean(JsonObject & json, const char * name, uint8_t value)
 }
 
 // set a json value to enumerated strings or numbers
-void Helpers::json_enum(JsonObject & json, const char * name, const std::vector<const __FlashStringHelper *> & value, const uint8_t no) {
+template <typename Json>
+void Helpers::json_enum(Json & json, const char * name, const std::vector<const __FlashStringHelper *> & value, const uint8_t no) {
     if (no >= value.size()) {
         return; // out of bounds
     }
@@ -150,7 +153,7 @@ void Helpers::json_enum(JsonObject & json, const char * name, const std::vector<
         return;
     }
     // return text
-    json[name] = uuid::read_flash_string(value[no]);
+    json[name] = value[no];
     /* replace on/off by true/false, but mismatch to other strings in the enum
     if (bool_format() == BOOL_FORMAT_TRUEFALSE) {
         if (no == 0 && uuid::read_flash_string(value[0]) == "off") {
@@ -163,7 +166,8 @@ void Helpers::json_enum(JsonObject & json, const char * name, const std::vector<
 }
 
 // set json value to time from uint32
-void Helpers::json_time(JsonObject & json, const char * name, const uint32_t value, const bool textformat) {
+template <typename Json>
+void Helpers::json_time(Json & json, const char * name, const uint32_t value, const bool textformat) {
     if (value == EMS_VALUE_ULONG_NOTSET || value == EMS_VALUE_ULONG_NOTSET / 60) {
         return;
     }
@@ -176,6 +180,12 @@ void Helpers::json_time(JsonObject & json, const char * name, const uint32_t val
     json[name] = value;
 }
 
+template void Helpers::json_boolean(JsonObject & json, const char * name, uint8_t value);
+template void Helpers::json_boolean(MetricsObject & json, const char * name, uint8_t value);
+template void Helpers::json_enum(JsonObject & json, const char * name, const std::vector<const __FlashStringHelper *> & value, const uint8_t no);
+template void Helpers::json_enum(MetricsObject & json, const char * name, const std::vector<const __FlashStringHelper *> & value, const uint8_t no);
+template void Helpers::json_time(JsonObject & json, const char * name, const uint32_t value, const bool textformat);
+template void Helpers::json_time(MetricsObject & json, const char * name, const uint32_t value, const bool textformat);
 
 // work out how to display booleans
 char * Helpers::render_boolean(char * result, bool value) {
@@ -228,28 +238,16 @@ char * Helpers::render_value(char * result, uint8_t value, uint8_t format) {
 }
 
 // float: convert float to char
-// format is the precision, 0 to 8
+// format is the precision, 0 to 3. It's rounded, and then rendered with integer maths
 char * Helpers::render_value(char * result, const float value, const uint8_t format) {
-    if (format > 8) {
+    if (format > 3) {
         return nullptr;
     }
 
-    uint32_t p[] = {0, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+    uint16_t p[] = {1, 10, 100, 1000};
 
-    char *  ret   = result;
-    int32_t whole = (int32_t)value;
-
-    itoa(result, whole, 10);
-
-    while (*result != '\0') {
-        result++;
-    }
-
-    *result++       = '.';
-    int32_t decimal = abs((int32_t)((value - whole) * p[format]));
-    itoa(result, decimal, 10);
-
-    return ret;
+    int32_t scaled = (int32_t)((value * p[format]) + ((value < 0) ? -0.5f : 0.5f));
+    return FixedPoint(scaled, p[format]).render(result, 10);
 }
 
 // int16: convert short (two bytes) to text string and returns string
@@ -394,6 +392,28 @@ uint32_t Helpers::hextoint(const char * hex) {
     return val;
 }
 
+// FNV-1a hash of a string, used to detect changes without keeping a copy of the text
+// pass the result of a previous call as seed to hash several strings together
+uint32_t Helpers::hash(const char * value, uint32_t seed) {
+    if (value == nullptr) {
+        return seed;
+    }
+    while (*value != '\0') {
+        seed ^= (uint8_t)*value++;
+        seed *= 16777619u;
+    }
+    return seed;
+}
+
+// same, for a block of data
+uint32_t Helpers::hash(const uint8_t * data, const uint8_t length, uint32_t seed) {
+    for (uint8_t i = 0; i < length; i++) {
+        seed ^= data[i];
+        seed *= 16777619u;
+    }
+    return seed;
+}
+
 // quick char to long
 uint16_t Helpers::atoint(const char * value) {
     unsigned int x = 0;
@@ -404,16 +424,6 @@ uint16_t Helpers::atoint(const char * value) {
     return x;
 }
 
-// rounds a number to 2 decimal places
-// example: round2(3.14159) -> 3.14
-double Helpers::round2(double value) {
-    if (value >= 0) {
-        return (int)(value * 100 + 0.5) / 100.0;
-    } else {
-        return (int)(value * 100 - 0.5) / 100.0;
-    }
-}
-
 bool Helpers::check_abs(const int32_t i) {
     return ((i < 0 ? -i : i) != 0xFFFFFF);
 }
@@ -455,11 +465,60 @@ bool Helpers::value2number(const char * v, int & value) {
 
 // checks if we can convert a char string to a float value
 bool Helpers::value2float(const char * v, float & value) {
-    if ((v == nullptr) || (strlen(v) == 0)) {
+    int32_t thousandths;
+    if (!value2fixed(v, thousandths, 1000)) {
         value = 0;
         return false;
     }
-    value = atof((char *)v);
+    value = (float)thousandths / 1000;
+    return true;
+}
+
+// reads a decimal like 20.35 straight into the integer it's stored as, without atof.
+// The divider is what the value is stored in, e.g. 10 for 0.1 degrees gives 204. Rounds half away from zero
+bool Helpers::value2fixed(const char * v, int32_t & value, const uint16_t divider) {
+    value = 0;
+    if (v == nullptr) {
+        return false;
+    }
+
+    while (*v == ' ') {
+        v++;
+    }
+    bool negative = (*v == '-');
+    if ((*v == '-') || (*v == '+')) {
+        v++;
+    }
+
+    int64_t whole    = 0;
+    int64_t fraction = 0;
+    int64_t scale    = 1;
+    bool    digits   = false;
+    for (; isdigit(*v); v++) {
+        whole  = whole * 10 + (*v - '0');
+        digits = true;
+        if (whole > INT32_MAX) {
+            return false;
+        }
+    }
+    if ((*v == '.') || (*v == ',')) {
+        for (v++; isdigit(*v); v++) {
+            if (scale < 1000000) {
+                fraction = fraction * 10 + (*v - '0');
+                scale *= 10;
+            }
+            digits = true;
+        }
+    }
+    if (!digits) {
+        return false;
+    }
+
+    int64_t result = whole * divider + (fraction * divider * 2 + scale) / (2 * scale);
+    if (result > INT32_MAX) {
+        return false;
+    }
+    value = negative ? -result : result;
     return true;
 }
 
@@ -509,12 +568,24 @@ bool Helpers::value2enum(const char * v, uint8_t & value, const std::vector<cons
     }
     std::string str = toLower(v);
     for (value = 0; value < strs.size(); value++) {
-        std::string str1 = uuid::read_flash_string(strs[value]);
-        if ((str1 == "off" && str == "false") || (str1 == "on" && str == "true") || (str == str1) || (v[0] == ('0' + value) && v[1] == '\0')) {
+        FlashStringView str1(strs[value]);
+        if ((str1 == "off" && str == "false") || (str1 == "on" && str == "true") || (str1 == str.c_str()) || (v[0] == ('0' + value) && v[1] == '\0')) {
             return true;
         }
     }
     return false;
 }
 
+// the content type that goes with the payload encoding
+// pretty json stays text/plain so it shows nicely in a browser, like the API always did
+const char * Helpers::payload_mimetype(const uint8_t encoding) {
+    if (encoding == PAYLOAD_MSGPACK) {
+        return "application/msgpack";
+    }
+    if (encoding == PAYLOAD_JSON_PRETTY) {
+        return "text/plain";
+    }
+    return "application/json";
+}
+
 } // namespace emsesp
@@ -24,12 +24,20 @@
 #include <uuid/common.h>
 
 #include "telegram.h" // for EMS_VALUE_* settings
+#include "flashstring.h"
+#include "fixedpoint.h"
+#include "jsonpool.h"
 
 #define BOOL_FORMAT_ONOFF 1
 #define BOOL_FORMAT_TRUEFALSE 2
 #define BOOL_FORMAT_NUMBERS 3
 #define BOOL_FORMAT_ONOFF_CAP 4
 
+// how json documents are sent out, set per transport
+#define PAYLOAD_JSON_PRETTY 0
+#define PAYLOAD_JSON 1
+#define PAYLOAD_MSGPACK 2
+
 // #define FJSON(x) x
 #define FJSON(x) F(x)
 
@@ -37,7 +45,7 @@ namespace emsesp {
 
 class Helpers {
   public:
-    static char * render_value(char * result, const float value, const uint8_t format); // format is the precision
+    static char * render_value(char * result, const float value, const uint8_t format); // format is the precision, 0 to 3
     static char * render_value(char * result, const uint8_t value, const uint8_t format);
     static char * render_value(char * result, const int8_t value, const uint8_t format);
     static char * render_value(char * result, const uint16_t value, const uint8_t format);
@@ -45,9 +53,14 @@ class Helpers {
     static char * render_value(char * result, const int16_t value, const uint8_t format);
     static char * render_value(char * result, const char * value, uint8_t format);
     static char * render_boolean(char * result, bool value);
-    static void   json_boolean(JsonObject & json, const char * name, uint8_t value);
-    static void   json_enum(JsonObject & json, const char * name, const std::vector<const __FlashStringHelper *> & value, const uint8_t no);
-    static void   json_time(JsonObject & json, const char * name, const uint32_t value, const bool textformat);
+
+    // for a JsonObject as well as a MetricsObject, both are instantiated in helpers.cpp
+    template <typename Json>
+    static void json_boolean(Json & json, const char * name, uint8_t value);
+    template <typename Json>
+    static void json_enum(Json & json, const char * name, const std::vector<const __FlashStringHelper *> & value, const uint8_t no);
+    template <typename Json>
+    static void json_time(Json & json, const char * name, const uint32_t value, const bool textformat);
 
     static char *      hextoa(char * result, const uint8_t value);
     static std::string data_to_hex(const uint8_t * data, const uint8_t length);
@@ -55,9 +68,10 @@ class Helpers {
     static char *      smallitoa(char * result, const uint16_t value);
     static char *      itoa(char * result, int32_t value, const uint8_t base = 10);
     static uint32_t    hextoint(const char * hex);
+    static uint32_t    hash(const char * value, uint32_t seed = 2166136261u);
+    static uint32_t    hash(const uint8_t * data, const uint8_t length, uint32_t seed = 2166136261u);
     static uint16_t    atoint(const char * value);
     static bool        check_abs(const int32_t i);
-    static double      round2(double value);
     static std::string toLower(std::string const & s);
 
     static bool hasValue(const uint8_t & v, const uint8_t isBool = 0);
@@ -68,10 +82,36 @@ class Helpers {
 
     static bool value2number(const char * v, int & value);
     static bool value2float(const char * v, float & value);
+    static bool value2fixed(const char * v, int32_t & value, const uint16_t divider);
     static bool value2bool(const char * v, bool & value);
     static bool value2string(const char * v, std::string & value);
     static bool value2enum(const char * v, uint8_t & value, const std::vector<const __FlashStringHelper *> & strs);
 
+    static const char * payload_mimetype(const uint8_t encoding);
+
+    // write a json document to a string or stream, as pretty json, compact json or MessagePack.
+    // encoding comes back as what it's been written as, MessagePack falls back to json if the document can't be converted
+    template <typename TSource, typename TDestination>
+    static size_t serialize_payload(const TSource & source, TDestination & destination, uint8_t & encoding) {
+        if (encoding == PAYLOAD_MSGPACK) {
+            // fixed point values are in the document as rendered json, which MessagePack can't carry like that.
+            // Reading the json back turns them into numbers, the strings stay where they are in the text and
+            // can take more room than in the source, so there's room for the whole text on top
+            std::string json;
+            serializeJson(source, json);
+            PooledJsonDocument doc(source.memoryUsage() + json.size());
+            DeserializationError error = deserializeJson(doc, &json[0]);
+            if (!error) {
+                return serializeMsgPack(doc, destination);
+            }
+            encoding = PAYLOAD_JSON;
+        }
+        if (encoding == PAYLOAD_JSON_PRETTY) {
+            return serializeJsonPretty(source, destination);
+        }
+        return serializeJson(source, destination);
+    }
+
     static void bool_format(uint8_t bool_format) {
         bool_format_ = bool_format;
     }
@@ -0,0 +1,491 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "history.h"
+#include "emsesp.h"
+
+#include <algorithm>
+
+#if defined(ESP32)
+#include <SPIFFS.h>
+#define HISTORY_FS SPIFFS
+#elif defined(ESP8266)
+#include <LittleFS.h>
+#define HISTORY_FS LittleFS
+#endif
+
+namespace emsesp {
+
+uuid::log::Logger History::logger_{F_(history), uuid::log::Facility::DAEMON};
+
+// seconds between samples in each tier, and the segments in its ring
+// on an ESP32 that's about 2.5 hours at 10 seconds, 24 hours at 1 minute and 4.5 days at 15 minutes, in 3 KB a value
+static constexpr uint16_t INTERVAL[History::NUM_TIERS] = {10, 60, 900};
+#if defined(ESP8266)
+static constexpr uint8_t MAX_SERIES                    = 4;
+static constexpr uint8_t SEGMENTS[History::NUM_TIERS]  = {4, 8, 4};
+static constexpr uint8_t MAX_QUERY_SEGMENTS            = 12;
+#else
+static constexpr uint8_t MAX_SERIES                    = 8;
+static constexpr uint8_t SEGMENTS[History::NUM_TIERS]  = {16, 26, 8};
+static constexpr uint8_t MAX_QUERY_SEGMENTS            = 24; // copied for a query, 1.5 KB
+#endif
+static constexpr uint8_t  TOTAL_SEGMENTS = SEGMENTS[0] + SEGMENTS[1] + SEGMENTS[2];
+static constexpr uint32_t SPILL_SIZE     = 8192; // bytes in a spill file, the one before is kept as .old
+
+// the web server has its own task on the ESP32, a query is started there while the loop samples and configures.
+// It's a mutex and not a critical section, the spill files are read and written with it held
+#if defined(ESP32)
+static SemaphoreHandle_t mutex_ = xSemaphoreCreateMutex();
+#define HISTORY_LOCK() xSemaphoreTake(mutex_, portMAX_DELAY)
+#define HISTORY_UNLOCK() xSemaphoreGive(mutex_)
+#else
+#define HISTORY_LOCK()
+#define HISTORY_UNLOCK()
+#endif
+
+// the values and what's kept of them are from the settings, a value that stays keeps its history
+void History::configure(const std::vector<std::string> & names, const bool spill) {
+    HISTORY_LOCK();
+    std::vector<Series> series;
+    for (const auto & name : names) {
+        if (series.size() == MAX_SERIES) {
+            LOG_WARNING(F("History is limited to %d values, %s is not kept"), MAX_SERIES, name.c_str());
+            break;
+        }
+
+        auto existing = std::find_if(series_.begin(), series_.end(), [&](const Series & s) { return (s.name == name) && s.segments; });
+        if (existing != series_.end()) {
+            series.push_back(std::move(*existing));
+            continue;
+        }
+
+        // device/key or device/object/key
+        size_t first = name.find('/');
+        size_t last  = name.rfind('/');
+        if (first == std::string::npos) {
+            LOG_WARNING(F("History value %s is not device/name"), name.c_str());
+            continue;
+        }
+        Series s;
+        s.name        = name;
+        s.device_type = EMSdevice::device_name_2_device_type(name.substr(0, first).c_str());
+        s.object      = (first == last) ? "" : name.substr(first + 1, last - first - 1);
+        s.key         = name.substr(last + 1);
+        if (s.device_type == EMSdevice::DeviceType::UNKNOWN) {
+            LOG_WARNING(F("History value %s has an unknown device"), name.c_str());
+            continue;
+        }
+        s.segments.reset(new (std::nothrow) Segment[TOTAL_SEGMENTS]);
+        if (!s.segments) {
+            LOG_ERROR(F("No memory for the history of %s"), name.c_str());
+            break;
+        }
+        memset(s.tiers, 0, sizeof(s.tiers));
+        series.push_back(std::move(s));
+    }
+
+    series_ = std::move(series);
+    spill_  = spill;
+    HISTORY_UNLOCK();
+}
+
+// unix time once it's set by NTP, the uptime until then
+uint32_t History::now() {
+    time_t t = time(nullptr);
+    return (t > 1600000000) ? (uint32_t)t : uuid::get_uptime_sec();
+}
+
+void History::loop() {
+    if (!series_.empty()) {
+        sample(now());
+    }
+}
+
+// the devices are exported once for all their values
+void History::sample(const uint32_t time) {
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+    uint8_t            exported = EMSdevice::DeviceType::UNKNOWN;
+
+    for (auto & series : series_) {
+        int32_t value = MISSING;
+        if (series.device_type == EMSdevice::DeviceType::DALLASSENSOR) {
+            for (const auto & sensor : EMSESP::sensor_devices()) {
+                if ((sensor.to_string() == series.key) && Helpers::hasValue(sensor.temperature_c)) {
+                    value = sensor.temperature_c;
+                }
+            }
+        } else {
+            if (exported != series.device_type) {
+                JsonObject json = doc.to<JsonObject>();
+                for (const auto & emsdevice : EMSESP::emsdevices) {
+                    if (emsdevice && (emsdevice->device_type() == series.device_type)) {
+                        emsdevice->export_values(json);
+                    }
+                }
+                exported = series.device_type;
+            }
+            JsonObjectConst values = series.object.empty() ? doc.as<JsonObjectConst>() : doc[series.object].as<JsonObjectConst>();
+            value                  = tenths(values[series.key]);
+        }
+        HISTORY_LOCK();
+        add(series, 0, time, value);
+        HISTORY_UNLOCK();
+    }
+}
+
+// an exported value in 0.1 units, booleans are 0 and 1
+int32_t History::tenths(JsonVariantConst value) {
+    if (value.isNull()) {
+        return MISSING;
+    }
+    if (value.is<bool>()) {
+        return value.as<bool>() ? 10 : 0;
+    }
+    if (value.is<long>()) {
+        return value.as<long>() * 10;
+    }
+    if (value.is<float>()) {
+        float f = value.as<float>() * 10;
+        return (int32_t)((f < 0) ? (f - 0.5f) : (f + 0.5f));
+    }
+
+    // a text like on or off, or a FixedPoint which is already rendered
+    char    text[20];
+    int32_t result;
+    if (value.is<const char *>()) {
+        strlcpy(text, value.as<const char *>(), sizeof(text));
+        if (!strcasecmp(text, "on") || !strcasecmp(text, "true")) {
+            return 10;
+        }
+        if (!strcasecmp(text, "off") || !strcasecmp(text, "false")) {
+            return 0;
+        }
+    } else {
+        serializeJson(value, text, sizeof(text));
+    }
+    return Helpers::value2fixed(text, result, 10) ? result : MISSING;
+}
+
+// adds a sample to a tier, and every so many samples their average to the next one
+void History::add(Series & series, const uint8_t t, const uint32_t time, const int32_t value) {
+    append(series, t, time, value);
+    if (t + 1 == NUM_TIERS) {
+        return;
+    }
+
+    Tier & tier = series.tiers[t];
+    if (value != MISSING) {
+        tier.sum += value;
+        tier.samples++;
+    }
+    if (++tier.ticks < INTERVAL[t + 1] / INTERVAL[t]) {
+        return;
+    }
+
+    int32_t average = MISSING;
+    if (tier.samples) {
+        average = (tier.sum + ((tier.sum < 0) ? -(tier.samples / 2) : (tier.samples / 2))) / tier.samples;
+    }
+    uint32_t start = time - (tier.ticks - 1) * INTERVAL[t];
+    tier.sum       = 0;
+    tier.samples   = 0;
+    tier.ticks     = 0;
+    add(series, t + 1, start, average);
+}
+
+History::Segment & History::segment(const Series & series, const uint8_t t, const uint8_t index) const {
+    static_assert(sizeof(Segment) == SEGMENT_SIZE, "a history segment is SEGMENT_SIZE bytes");
+
+    uint8_t offset = 0;
+    for (uint8_t i = 0; i < t; i++) {
+        offset += SEGMENTS[i];
+    }
+    return series.segments[offset + ((series.tiers[t].first + index) % SEGMENTS[t])];
+}
+
+// a sample is coded as 0 if it's missing, otherwise as the zigzag of its difference to the one before, plus 1
+static uint8_t encode(uint8_t * code, const int32_t value, const int32_t previous) {
+    uint32_t zigzag = 0;
+    if (value != History::MISSING) {
+        int32_t difference = value - previous;
+        zigzag             = (((uint32_t)difference << 1) ^ (uint32_t)(difference >> 31)) + 1;
+    }
+    uint8_t length = 0;
+    do {
+        code[length++] = (zigzag & 0x7F) | ((zigzag > 0x7F) ? 0x80 : 0);
+        zigzag >>= 7;
+    } while (zigzag);
+    return length;
+}
+
+// a new segment is started when the newest is full, or when the time jumps like when the clock is set
+void History::append(Series & series, const uint8_t t, const uint32_t time, const int32_t value) {
+    Tier &    tier   = series.tiers[t];
+    Segment * newest = tier.used ? &segment(series, t, tier.used - 1) : nullptr;
+
+    uint32_t expected = newest ? newest->start + newest->count * INTERVAL[t] : 0;
+    bool     follows  = newest && (time + INTERVAL[t] / 2 >= expected) && (time < expected + INTERVAL[t] / 2);
+
+    uint8_t code[5];
+    uint8_t length = encode(code, value, follows ? tier.previous : 0);
+    if (!follows || (newest->length + length > (uint8_t)sizeof(newest->data))) {
+        if (tier.used == SEGMENTS[t]) {
+            if ((t + 1 == NUM_TIERS) && spill_) {
+                spill(series, segment(series, t, 0));
+            }
+            tier.first = (tier.first + 1) % SEGMENTS[t];
+            tier.used--;
+        }
+        tier.used++;
+        newest         = &segment(series, t, tier.used - 1);
+        newest->start  = time;
+        newest->count  = 0;
+        newest->length = 0;
+        tier.previous  = 0; // a segment starts from 0
+        length         = encode(code, value, 0);
+    }
+
+    memcpy(&newest->data[newest->length], code, length);
+    newest->length += length;
+    newest->count++;
+    if (value != MISSING) {
+        tier.previous = value;
+    }
+}
+
+// the dropped segments of the coarsest tier are appended to a file, when it's full it becomes the .old one
+void History::spill(const Series & series, const Segment & segment) const {
+#ifndef EMSESP_STANDALONE
+    char path[32];
+    char old_path[32];
+    snprintf_P(path, sizeof(path), PSTR("/history_%08X.bin"), Helpers::hash(series.name.c_str()));
+    snprintf_P(old_path, sizeof(old_path), PSTR("/history_%08X.old"), Helpers::hash(series.name.c_str()));
+
+    File file = HISTORY_FS.open(path, "a");
+    if (!file) {
+        return;
+    }
+    file.write((const uint8_t *)&segment, sizeof(Segment));
+    size_t size = file.size();
+    file.close();
+
+    if (size >= SPILL_SIZE) {
+        HISTORY_FS.remove(old_path);
+        HISTORY_FS.rename(path, old_path);
+    }
+#endif
+}
+
+// the copy is capped, when there's more the query ends where the copy does and the rest is asked for from there
+bool History::start_query(Query & query, const char * name, const uint32_t from, const uint32_t to, const uint32_t resolution) const {
+    HISTORY_LOCK();
+    auto series = std::find_if(series_.begin(), series_.end(), [&](const Series & s) { return s.name == name; });
+    if (series == series_.end()) {
+        HISTORY_UNLOCK();
+        return false;
+    }
+
+    uint8_t t;
+    for (t = 0; t < NUM_TIERS - 1; t++) {
+        const Tier & tier = series->tiers[t];
+        if (resolution) {
+            if (INTERVAL[t] >= resolution) {
+                break;
+            }
+        } else if (tier.used && (segment(*series, t, 0).start <= from)) {
+            break;
+        }
+    }
+
+    query.name     = series->name;
+    query.interval = INTERVAL[t];
+    query.from     = from;
+    query.to       = to;
+    query.next     = from;
+    query.state    = HEADER;
+    query.segment  = 0;
+    query.segments.clear();
+    query.segments.reserve(MAX_QUERY_SEGMENTS);
+
+    // they're in time order, the oldest first
+    auto keep = [&](const Segment & segment) {
+        if (!in_range(query, segment)) {
+            return true;
+        }
+        if (query.segments.size() == MAX_QUERY_SEGMENTS) {
+            query.to = segment.start - 1;
+            return false;
+        }
+        query.segments.push_back(segment);
+        return true;
+    };
+
+    bool more = true;
+#ifndef EMSESP_STANDALONE
+    // the spilled segments come first, they're older
+    if (spill_ && (t + 1 == NUM_TIERS)) {
+        char path[32];
+        for (const char * suffix : {"old", "bin"}) {
+            snprintf_P(path, sizeof(path), PSTR("/history_%08X.%s"), Helpers::hash(series->name.c_str()), suffix);
+            File file = HISTORY_FS.open(path, "r");
+            if (!file) {
+                continue;
+            }
+            Segment spilled;
+            while (more && (file.read((uint8_t *)&spilled, sizeof(Segment)) == sizeof(Segment))) {
+                more = keep(spilled);
+            }
+            file.close();
+        }
+    }
+#endif
+
+    for (uint8_t i = 0; more && (i < series->tiers[t].used); i++) {
+        more = keep(segment(*series, t, i));
+    }
+    HISTORY_UNLOCK();
+    return true;
+}
+
+// if a segment has samples between from and to
+bool History::in_range(const Query & query, const Segment & segment) {
+    return (segment.start <= query.to) && (segment.start + segment.count * query.interval > query.from);
+}
+
+// decodes a segment and adds the values from query.next on, returns false when there are enough values
+bool History::render_segment(std::string & output, Query & query, const Segment & segment, uint16_t & remaining) {
+    uint32_t interval = query.interval;
+    if ((segment.start > query.to) || (segment.start + segment.count * interval <= query.next)) {
+        return true;
+    }
+
+    int32_t previous = 0;
+    uint8_t pos      = 0;
+    for (uint16_t i = 0; (i < segment.count) && (pos < segment.length); i++) {
+        uint32_t zigzag = 0;
+        uint8_t  shift  = 0;
+        uint8_t  byte;
+        do {
+            byte = segment.data[pos++];
+            zigzag |= (uint32_t)(byte & 0x7F) << shift;
+            shift += 7;
+        } while ((byte & 0x80) && (pos < segment.length));
+
+        int32_t value = MISSING;
+        if (zigzag) {
+            zigzag--;
+            value    = previous + (int32_t)((zigzag >> 1) ^ -(int32_t)(zigzag & 1));
+            previous = value;
+        }
+
+        uint32_t time = segment.start + i * interval;
+        if (time < query.next) {
+            continue;
+        }
+        if (time > query.to) {
+            break;
+        }
+
+        char text[30];
+        char number[FixedPoint::MAX_LENGTH + 1];
+        snprintf_P(text,
+                   sizeof(text),
+                   PSTR("%s[%lu,%s]"),
+                   (query.state == FIRST_VALUE) ? "" : ",",
+                   (unsigned long)time,
+                   (value == MISSING) ? "null" : FixedPoint(value, 10).render(number, sizeof(number), true));
+        output += text;
+        query.state = VALUES;
+        query.next  = time + 1;
+        if (--remaining == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// adds the next part of the json to output, up to max_values values, returns what was added
+// only uses the query, not the history itself
+size_t History::render(std::string & output, Query & query, const uint16_t max_values) {
+    size_t start = output.size();
+
+    if (query.state == HEADER) {
+        char header[80];
+        snprintf_P(header, sizeof(header), PSTR("{\"name\":\"%s\",\"resolution\":%u,\"values\":["), query.name.c_str(), query.interval);
+        output += header;
+        query.state = FIRST_VALUE;
+        return output.size() - start;
+    }
+
+    if ((query.state == FIRST_VALUE) || (query.state == VALUES)) {
+        uint16_t remaining = max_values;
+        bool     more      = true;
+        // when there are enough values it carries on in the same segment next time, from query.next
+        while (more && (query.segment < query.segments.size())) {
+            more = render_segment(output, query, query.segments[query.segment], remaining);
+            if (more) {
+                query.segment++;
+            }
+        }
+        if (more) {
+            query.state = FOOTER;
+        }
+        if (output.size() != start) {
+            return output.size() - start;
+        }
+    }
+
+    if (query.state == FOOTER) {
+        output += "]}";
+        query.state = DONE;
+    }
+    return output.size() - start;
+}
+
+void History::show(uuid::console::Shell & shell) const {
+    if (series_.empty()) {
+        shell.printfln(F("No values are kept in the history"));
+        return;
+    }
+
+    shell.printfln(F("History of %d values in %lu bytes, spilling to a file is %s"),
+                   series_.size(),
+                   (unsigned long)(series_.size() * TOTAL_SEGMENTS * sizeof(Segment)),
+                   spill_ ? "on" : "off");
+    for (const auto & series : series_) {
+        shell.printfln(F(" %s:"), series.name.c_str());
+        for (uint8_t t = 0; t < NUM_TIERS; t++) {
+            const Tier & tier    = series.tiers[t];
+            uint32_t     samples = 0;
+            uint32_t     bytes   = 0;
+            for (uint8_t i = 0; i < tier.used; i++) {
+                samples += segment(series, t, i).count;
+                bytes += segment(series, t, i).length;
+            }
+            shell.printfln(F("  every %4u s: %5lu samples in %5lu bytes, %u of %u segments"),
+                           INTERVAL[t],
+                           (unsigned long)samples,
+                           (unsigned long)bytes,
+                           tier.used,
+                           SEGMENTS[t]);
+        }
+    }
+}
+
+} // namespace emsesp
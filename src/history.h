@@ -0,0 +1,122 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_HISTORY_H
+#define EMSESP_HISTORY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <uuid/console.h>
+#include <uuid/log.h>
+
+namespace emsesp {
+
+// a history of selected values, kept on the device so it's there when the broker or the database were down.
+// A value is sampled every 10 seconds and averaged into 1 and 15 minute tiers. Each tier is a ring of segments
+// of a fixed size, the oldest segment goes when a new one is needed. A segment has the time of its first sample,
+// the samples follow as the difference from the one before, zigzag and varint encoded, so a slowly changing
+// value takes a byte a sample. The segments dropped from the 15 minute tier can be kept in a file.
+// Values are in 0.1 units, the times are unix time once the clock is set and the uptime in seconds before that.
+// The values are set by name in the settings: "boiler/curFlowTemp", "thermostat/hc1/currtemp" or "dallassensor/28-233D-9497-0C03"
+class History {
+  public:
+    static constexpr uint32_t SAMPLE_INTERVAL = 10000; // ms
+    static constexpr uint8_t  NUM_TIERS       = 3;
+    static constexpr uint8_t  SEGMENT_SIZE    = 64;
+    static constexpr int32_t  MISSING         = INT32_MIN; // no value at that time
+
+    void configure(const std::vector<std::string> & names, const bool spill);
+    void loop();
+    void sample(const uint32_t time);
+    void show(uuid::console::Shell & shell) const;
+
+    // the samples from a time on, delta encoded
+    struct Segment {
+        uint32_t start;  // time of the first sample
+        uint16_t count;  // samples
+        uint8_t  length; // bytes in data
+        uint8_t  data[SEGMENT_SIZE - 7];
+    };
+
+    // a query, rendered as json a part at a time for a chunked response:
+    // {"name":"boiler/curFlowTemp","resolution":60,"values":[[1610000000,58.2],[1610000060,null],...]}
+    // it has a copy of the segments in its range, taken when it's started, so it can be rendered in the web task
+    // while the history goes on sampling or is configured again. The copy is capped, when the range has more
+    // the values end early and the rest is another query from the last time on
+    struct Query {
+        std::string          name;
+        uint16_t             interval; // seconds
+        uint32_t             from;
+        uint32_t             to;
+        uint32_t             next; // the time to carry on from
+        uint8_t              state;
+        std::vector<Segment> segments;
+        size_t               segment; // the one to carry on from
+    };
+
+    enum QueryState : uint8_t { HEADER, FIRST_VALUE, VALUES, FOOTER, DONE };
+
+    // picks the tier from the resolution in seconds, the finest that covers from if it's 0
+    bool          start_query(Query & query, const char * name, const uint32_t from, const uint32_t to, const uint32_t resolution) const;
+    static size_t render(std::string & output, Query & query, const uint16_t max_values);
+
+    static uint32_t now();
+
+  private:
+    static uuid::log::Logger logger_;
+
+    struct Tier {
+        uint8_t first; // the oldest segment in the ring
+        uint8_t used;
+        int32_t previous; // the last value in the newest segment
+        int32_t sum;      // of the samples to average into the next tier
+        uint8_t samples;
+        uint8_t ticks;
+    };
+
+    struct Series {
+        std::string                name;
+        uint8_t                    device_type;
+        std::string                object; // e.g. hc1, can be empty
+        std::string                key;
+        std::unique_ptr<Segment[]> segments;
+        Tier                       tiers[NUM_TIERS];
+    };
+
+    void      add(Series & series, const uint8_t tier, const uint32_t time, const int32_t value);
+    void      append(Series & series, const uint8_t tier, const uint32_t time, const int32_t value);
+    Segment & segment(const Series & series, const uint8_t tier, const uint8_t index) const;
+    void      spill(const Series & series, const Segment & segment) const;
+
+    static bool in_range(const Query & query, const Segment & segment);
+    static bool render_segment(std::string & output, Query & query, const Segment & segment, uint16_t & remaining);
+
+    static int32_t tenths(JsonVariantConst value);
+
+    std::vector<Series> series_;
+    bool                spill_ = false;
+};
+
+} // namespace emsesp
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonpool.h"
+
+#include <new>
+
+namespace emsesp {
+
+// the sizes are the EMSESP_MAX_JSON_SIZE_ ones: HA config, large, large dyn and max dyn
+static constexpr size_t CAPACITY[JsonPool::NUM_SIZES] = {384, 1024, 2048, 4096};
+
+// slots of each size, a publish can have a HA config and a device document at the same time
+// and the web server runs in between. On the ESP8266 the biggest documents come from the heap
+#if defined(ESP8266)
+static constexpr uint8_t SLOTS[JsonPool::NUM_SIZES] = {3, 2, 1, 0};
+#else
+static constexpr uint8_t SLOTS[JsonPool::NUM_SIZES] = {4, 4, 2, 1};
+#endif
+
+static constexpr size_t ARENA_SIZE = CAPACITY[0] * SLOTS[0] + CAPACITY[1] * SLOTS[1] + CAPACITY[2] * SLOTS[2] + CAPACITY[3] * SLOTS[3];
+
+alignas(8) static char arena_[ARENA_SIZE];
+
+// the web server has its own task on the ESP32
+#if defined(ESP32)
+static portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+#define POOL_LOCK() portENTER_CRITICAL(&mux_)
+#define POOL_UNLOCK() portEXIT_CRITICAL(&mux_)
+#else
+#define POOL_LOCK()
+#define POOL_UNLOCK()
+#endif
+
+JsonPool::Stats JsonPool::stats_[JsonPool::NUM_SIZES];
+uint32_t        JsonPool::busy_      = 0;
+uint32_t        JsonPool::fallbacks_ = 0;
+
+// the smallest free slot that fits, which can be of a bigger size if the right ones are all in use
+char * JsonPool::acquire(const size_t capacity, size_t & slot_capacity, uint8_t & slot) {
+    uint8_t wanted = XLARGE;
+    size_t  offset = 0;
+    uint8_t i      = 0;
+
+    POOL_LOCK();
+    for (uint8_t size = 0; size < NUM_SIZES; size++) {
+        for (uint8_t n = 0; n < SLOTS[size]; n++, i++, offset += CAPACITY[size]) {
+            if ((CAPACITY[size] < capacity) || (busy_ & (1UL << i))) {
+                continue;
+            }
+            busy_ |= (1UL << i);
+            Stats & stats = stats_[size];
+            stats.leases_++;
+            stats.in_use_++;
+            if (stats.in_use_ > stats.peak_) {
+                stats.peak_ = stats.in_use_;
+            }
+            slot          = i;
+            slot_capacity = CAPACITY[size];
+            POOL_UNLOCK();
+            return &arena_[offset];
+        }
+        if ((CAPACITY[size] >= capacity) && (wanted == XLARGE)) {
+            wanted = size;
+        }
+    }
+    stats_[wanted].fallbacks_++;
+    fallbacks_++;
+    POOL_UNLOCK();
+
+    // if even this fails the document has no room, and every add to it fails
+    slot          = NO_SLOT;
+    char * buffer = new (std::nothrow) char[capacity];
+    slot_capacity = buffer ? capacity : 0;
+    return buffer;
+}
+
+void JsonPool::release(const uint8_t slot) {
+    POOL_LOCK();
+    busy_ &= ~(1UL << slot);
+    uint8_t first = 0;
+    for (uint8_t size = 0; size < NUM_SIZES; first += SLOTS[size], size++) {
+        if (slot < first + SLOTS[size]) {
+            stats_[size].in_use_--;
+            break;
+        }
+    }
+    POOL_UNLOCK();
+}
+
+void JsonPool::show(uuid::console::Shell & shell) {
+    shell.printfln(F("JSON document pool (%lu bytes, %lu from the heap):"), (unsigned long)ARENA_SIZE, (unsigned long)fallbacks_);
+    shell.printfln(F(" %6s %6s %7s %5s %8s %10s"), "size", "slots", "in use", "peak", "leases", "from heap");
+    for (uint8_t size = 0; size < NUM_SIZES; size++) {
+        const Stats & stats = stats_[size];
+        shell.printfln(F(" %6lu %6u %7u %5u %8lu %10lu"),
+                       (unsigned long)CAPACITY[size],
+                       SLOTS[size],
+                       stats.in_use_,
+                       stats.peak_,
+                       (unsigned long)stats.leases_,
+                       (unsigned long)stats.fallbacks_);
+    }
+}
+
+PooledJsonDocument::PooledJsonDocument(const size_t capacity)
+    : PooledJsonDocument(take(capacity)) {
+}
+
+PooledJsonDocument::PooledJsonDocument(const Lease & lease)
+    : JsonDocument(lease.buffer_, lease.capacity_)
+    , lease_(lease) {
+}
+
+PooledJsonDocument::~PooledJsonDocument() {
+    if (lease_.slot_ == JsonPool::NO_SLOT) {
+        delete[] lease_.buffer_;
+    } else {
+        JsonPool::release(lease_.slot_);
+    }
+}
+
+PooledJsonDocument::Lease PooledJsonDocument::take(const size_t capacity) {
+    Lease lease;
+    lease.buffer_ = JsonPool::acquire(capacity, lease.capacity_, lease.slot_);
+    return lease;
+}
+
+} // namespace emsesp
@@ -0,0 +1,90 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_JSONPOOL_H
+#define EMSESP_JSONPOOL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <uuid/console.h>
+
+namespace emsesp {
+
+// a fixed set of preallocated buffers for json documents, in four sizes, shared by MQTT, the web and the API
+// so the documents are neither on the (4 KB on the ESP8266) stack nor fragmenting the heap.
+// A document gets the smallest free buffer that is big enough. When they're all in use it falls back
+// to the heap, which is counted so the slot numbers can be tuned
+class JsonPool {
+  public:
+    enum Size : uint8_t { SMALL, MEDIUM, LARGE, XLARGE, NUM_SIZES };
+
+    static constexpr uint8_t NO_SLOT = 0xFF; // the buffer is on the heap
+
+    static void show(uuid::console::Shell & shell);
+
+    static uint32_t fallbacks() {
+        return fallbacks_;
+    }
+
+  private:
+    friend class PooledJsonDocument;
+
+    struct Stats {
+        uint32_t leases_;
+        uint8_t  in_use_;
+        uint8_t  peak_;
+        uint32_t fallbacks_; // when all slots were in use, or it's bigger than the biggest
+    };
+
+    static char * acquire(const size_t capacity, size_t & slot_capacity, uint8_t & slot);
+    static void   release(const uint8_t slot);
+
+    static Stats    stats_[NUM_SIZES];
+    static uint32_t busy_; // a bit for each slot
+    static uint32_t fallbacks_;
+};
+
+// a json document in a buffer from the pool, which is given back when it goes out of scope
+// it's used like a StaticJsonDocument, e.g. PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE);
+class PooledJsonDocument : public JsonDocument {
+  public:
+    explicit PooledJsonDocument(const size_t capacity);
+    ~PooledJsonDocument();
+
+    PooledJsonDocument(const PooledJsonDocument &) = delete;
+    PooledJsonDocument & operator=(const PooledJsonDocument &) = delete;
+
+  private:
+    struct Lease {
+        char *  buffer_;
+        size_t  capacity_;
+        uint8_t slot_;
+    };
+
+    // the buffer is taken before the JsonDocument is built on it
+    PooledJsonDocument(const Lease & lease);
+
+    static Lease take(const size_t capacity);
+
+    Lease lease_;
+};
+
+} // namespace emsesp
+
+#endif
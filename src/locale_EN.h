@@ -43,7 +43,16 @@ MAKE_PSTR_WORD(raw)
 MAKE_PSTR_WORD(watch)
 MAKE_PSTR_WORD(send)
 MAKE_PSTR_WORD(telegram)
+MAKE_PSTR_WORD(bus)
 MAKE_PSTR_WORD(bus_id)
+MAKE_PSTR_WORD(tasks)
+MAKE_PSTR_WORD(heap)
+MAKE_PSTR_WORD(capture)
+MAKE_PSTR_WORD(stop)
+MAKE_PSTR_WORD(clear)
+MAKE_PSTR_WORD(history)
+MAKE_PSTR_WORD(uart)
+MAKE_PSTR_WORD(stats)
 MAKE_PSTR_WORD(tx_mode)
 MAKE_PSTR_WORD(ems)
 MAKE_PSTR_WORD(devices)
@@ -74,6 +83,7 @@ MAKE_PSTR_WORD(cmd)
 MAKE_PSTR_WORD(id)
 MAKE_PSTR_WORD(device)
 MAKE_PSTR_WORD(data)
+MAKE_PSTR_WORD(since)
 MAKE_PSTR_WORD(command)
 MAKE_PSTR_WORD(commands)
 MAKE_PSTR_WORD(info)
@@ -114,6 +124,8 @@ MAKE_PSTR(bus_id_fmt, "Bus ID = %02X")
 MAKE_PSTR(watchid_optional, "[ID]")
 MAKE_PSTR(watch_format_optional, "[off | on | raw | unknown]")
 MAKE_PSTR(invalid_watch, "Invalid watch type")
+MAKE_PSTR(capture_optional, "[on | off | stop | clear]")
+MAKE_PSTR(frames_optional, "[frames]")
 MAKE_PSTR(data_mandatory, "\"XX XX ...\"")
 MAKE_PSTR(percent, "%")
 MAKE_PSTR(degrees, "°C")
@@ -317,6 +329,11 @@ MAKE_PSTR(dewTemperature, "Dew point temperature")
 MAKE_PSTR(activated, "Switch activated")
 MAKE_PSTR(status, "Switch status")
 
+// value filters, by the json name of the value
+MAKE_PSTR(filter_curFlowTemp, "curFlowTemp")
+MAKE_PSTR(filter_retTemp, "retTemp")
+MAKE_PSTR(filter_flameCurr, "flameCurr")
+MAKE_PSTR(filter_sensorTemp, "sensorTemp")
 
 // Home Assistant icons
 MAKE_PSTR(iconwatertemp, "mdi:coolant-temperature")
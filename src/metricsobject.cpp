@@ -0,0 +1,87 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metricsobject.h"
+
+#include <uuid/common.h>
+
+namespace emsesp {
+
+void MetricsObject::Value::operator=(const float value) {
+    // 2 decimals, values are rounded like that when exported
+    float f        = value * 100;
+    long  hundreds = (long)((f < 0) ? (f - 0.5f) : (f + 0.5f));
+    char  text[20];
+    snprintf_P(text, sizeof(text), PSTR("%s%ld.%02ld"), (hundreds < 0) ? "-" : "", labs(hundreds) / 100, labs(hundreds) % 100);
+    object_.add(name_, text);
+}
+
+void MetricsObject::Value::operator=(const char * value) {
+    if (!strcasecmp(value, "on") || !strcasecmp(value, "true")) {
+        object_.add(name_, "1");
+    } else if (!strcasecmp(value, "off") || !strcasecmp(value, "false")) {
+        object_.add(name_, "0");
+    } else {
+        object_.add(name_, nullptr); // not a number
+    }
+}
+
+void MetricsObject::Value::operator=(const __FlashStringHelper * value) {
+    *this = uuid::read_flash_string(value);
+}
+
+MetricsObject MetricsObject::createNestedObject(const char * name) {
+    count_++;
+    std::string labels = labels_;
+    labels += ",hc=\"";
+    labels += name;
+    labels += '"';
+    return MetricsObject(output_, labels);
+}
+
+void MetricsObject::add_number(const char * name, const long value) {
+    char text[20];
+    snprintf_P(text, sizeof(text), PSTR("%ld"), value);
+    add(name, text);
+}
+
+void MetricsObject::add_number(const char * name, const unsigned long value) {
+    char text[20];
+    snprintf_P(text, sizeof(text), PSTR("%lu"), value);
+    add(name, text);
+}
+
+// no TYPE line as the same name can show up for several devices
+void MetricsObject::add(const char * name, const char * value) {
+    count_++;
+    if (value == nullptr) {
+        return;
+    }
+
+    output_ += "emsesp_";
+    for (const char * c = name; *c != '\0'; c++) {
+        output_ += isalnum(*c) ? *c : '_';
+    }
+    output_ += '{';
+    output_ += labels_;
+    output_ += "} ";
+    output_ += value;
+    output_ += '\n';
+}
+
+} // namespace emsesp
@@ -0,0 +1,103 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_METRICSOBJECT_H
+#define EMSESP_METRICSOBJECT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <string>
+#include <type_traits>
+
+namespace emsesp {
+
+// takes the place of a JsonObject for the export functions of the devices, but writes each value straight out
+// as a line in the Prometheus text format, so no json document is needed for /metrics:
+//   json["curFlowTemp"] = FixedPoint(curFlowTemp_, 10).json(); gives emsesp_curflowtemp{device="boiler",device_id="0x08"} 58.2
+// Booleans and on/off texts become 1 or 0, other texts (like modes) are skipped.
+// A nested object, a heating circuit, adds its name as the hc label
+class MetricsObject {
+  public:
+    MetricsObject(std::string & output, const std::string & labels)
+        : output_(output)
+        , labels_(labels) {
+    }
+
+    class Value {
+      public:
+        Value(MetricsObject & object, const char * name)
+            : object_(object)
+            , name_(name) {
+        }
+
+        void operator=(const bool value) {
+            object_.add(name_, value ? "1" : "0");
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type operator=(const T value) {
+            object_.add_number(name_, (long)value);
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type operator=(const T value) {
+            object_.add_number(name_, (unsigned long)value);
+        }
+
+        void operator=(const float value);
+        void operator=(const char * value);
+        void operator=(const __FlashStringHelper * value);
+        void operator=(const std::string & value) {
+            *this = value.c_str();
+        }
+
+        // a FixedPoint, already rendered as a number
+        void operator=(const ARDUINOJSON_NAMESPACE::SerializedValue<char *> & value) {
+            object_.add(name_, value.data());
+        }
+
+      private:
+        MetricsObject & object_;
+        const char *    name_;
+    };
+
+    Value operator[](const char * name) {
+        return Value(*this, name);
+    }
+
+    MetricsObject createNestedObject(const char * name);
+
+    // values written, like the size of a JsonObject
+    size_t size() const {
+        return count_;
+    }
+
+  private:
+    void add(const char * name, const char * value);
+    void add_number(const char * name, const long value);
+    void add_number(const char * name, const unsigned long value);
+
+    std::string & output_;
+    std::string   labels_;
+    size_t        count_ = 0;
+};
+
+} // namespace emsesp
+
+#endif
@@ -36,6 +36,7 @@ uint32_t    Mqtt::publish_time_other_;
 uint32_t    Mqtt::publish_time_sensor_;
 uint8_t     Mqtt::mqtt_format_;
 bool        Mqtt::mqtt_enabled_;
+uint8_t     Mqtt::mqtt_encoding_ = PAYLOAD_JSON;
 
 std::vector<Mqtt::MQTTSubFunction> Mqtt::mqtt_subfunctions_;
 
@@ -131,11 +132,6 @@ void Mqtt::loop() {
         process_queue();
     }
 
-    // dallas publish on change
-    if (!publish_time_sensor_) {
-        EMSESP::publish_sensor_values(false);
-    }
-
     // scheduled messages only if queue empty
     if (!mqtt_messages_.empty()) {
         return;
@@ -199,22 +195,24 @@ void Mqtt::show_mqtt(uuid::console::Shell & shell) {
     for (const auto & message : mqtt_messages_) {
         auto content = message.content_;
         if (content->operation == Operation::PUBLISH) {
-            // Publish messages
+            // Publish messages, of a MessagePack payload only its size
+            char         size[30];
+            const char * payload = content->payload.c_str();
+            if (content->binary) {
+                snprintf_P(size, sizeof(size), PSTR("<MessagePack, %u bytes>"), (unsigned int)content->payload.size());
+                payload = size;
+            }
             if (message.retry_count_ == 0) {
                 if (message.packet_id_ == 0) {
-                    shell.printfln(F(" [%02d] (Pub) topic=%s payload=%s"), message.id_, content->topic.c_str(), content->payload.c_str());
+                    shell.printfln(F(" [%02d] (Pub) topic=%s payload=%s"), message.id_, content->topic.c_str(), payload);
                 } else {
-                    shell.printfln(F(" [%02d] (Pub) topic=%s payload=%s (pid %d)"),
-                                   message.id_,
-                                   content->topic.c_str(),
-                                   content->payload.c_str(),
-                                   message.packet_id_);
+                    shell.printfln(F(" [%02d] (Pub) topic=%s payload=%s (pid %d)"), message.id_, content->topic.c_str(), payload, message.packet_id_);
                 }
             } else {
                 shell.printfln(F(" [%02d] (Pub) topic=%s payload=%s (pid %d, retry #%d)"),
                                message.id_,
                                content->topic.c_str(),
-                               content->payload.c_str(),
+                               payload,
                                message.packet_id_,
                                message.retry_count_);
             }
@@ -262,8 +260,8 @@ void Mqtt::on_message(const char * fulltopic, const char * payload, size_t len)
             }
 
             // empty function. It's a command then. Find the command from the json and call it directly.
-            StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
-            DeserializationError                           error = deserializeJson(doc, message);
+            PooledJsonDocument   doc(EMSESP_MAX_JSON_SIZE_SMALL);
+            DeserializationError error = deserializeJson(doc, message);
             if (error) {
                 LOG_ERROR(F("MQTT error: payload %s, error %s"), message, error.c_str());
                 return;
@@ -377,6 +375,13 @@ void Mqtt::start() {
     }
     initialized_ = true;
 
+    // dallas publish on change
+    Events::subscribe(Events::SENSOR_VALUES, [](const Events::Event & event) {
+        if (connected() && !publish_time_sensor_) {
+            EMSESP::publish_sensor_values(false);
+        }
+    });
+
     mqttClient_->onConnect([this](bool sessionPresent) { on_connect(); });
 
     mqttClient_->onDisconnect([this](AsyncMqttClientDisconnectReason reason) {
@@ -499,7 +504,7 @@ void Mqtt::on_connect() {
     // first time to connect
     if (connectcount_ == 1) {
         // send info topic appended with the version information as JSON
-        StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
+        PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
         doc["event"]   = FJSON("start");
         doc["version"] = EMSESP_APP_VERSION;
 #ifndef EMSESP_STANDALONE
@@ -527,7 +532,7 @@ void Mqtt::on_connect() {
 // homeassistant/sensor/ems-esp/status/config
 // all the values from the heartbeat payload will be added as attributes to the entity state
 void Mqtt::ha_status() {
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_HA_CONFIG> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
 
     doc["name"]    = FJSON("EMS-ESP status");
     doc["uniq_id"] = FJSON("status");
@@ -552,14 +557,14 @@ void Mqtt::ha_status() {
 // add sub or pub task to the queue.
 // a fully-qualified topic is created by prefixing the base, unless it's HA
 // returns a pointer to the message created
-std::shared_ptr<const MqttMessage> Mqtt::queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, bool retain) {
+std::shared_ptr<const MqttMessage> Mqtt::queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, bool retain, bool binary) {
     if (topic.empty()) {
         return nullptr;
     }
 
     // take the topic and prefix the hostname, unless its for HA
     std::shared_ptr<MqttMessage> message;
-    message = std::make_shared<MqttMessage>(operation, topic, payload, retain);
+    message = std::make_shared<MqttMessage>(operation, topic, payload, retain, binary);
 
     // if the queue is full, make room but removing the last one
     if (mqtt_messages_.size() >= MAX_MQTT_MESSAGES) {
@@ -572,11 +577,11 @@ std::shared_ptr<const MqttMessage> Mqtt::queue_message(const uint8_t operation,
 }
 
 // add MQTT message to queue, payload is a string
-std::shared_ptr<const MqttMessage> Mqtt::queue_publish_message(const std::string & topic, const std::string & payload, bool retain) {
+std::shared_ptr<const MqttMessage> Mqtt::queue_publish_message(const std::string & topic, const std::string & payload, bool retain, bool binary) {
     if (!enabled()) {
         return nullptr;
     };
-    return queue_message(Operation::PUBLISH, topic, payload, retain);
+    return queue_message(Operation::PUBLISH, topic, payload, retain, binary);
 }
 
 // add MQTT subscribe message to queue
@@ -591,16 +596,28 @@ void Mqtt::publish(const std::string & topic, const std::string & payload) {
 
 // MQTT Publish, using a user's retain flag - except for char * strings
 void Mqtt::publish(const __FlashStringHelper * topic, const char * payload) {
-    queue_publish_message(uuid::read_flash_string(topic), payload, mqtt_retain_);
+    if (!enabled()) {
+        return;
+    }
+    char topic_s[MQTT_TOPIC_MAX_SIZE];
+    queue_publish_message(FlashStringView(topic).c_str(topic_s), payload, mqtt_retain_);
 }
 
 // MQTT Publish, using a specific retain flag, topic is a flash string
 void Mqtt::publish(const __FlashStringHelper * topic, const std::string & payload) {
-    queue_publish_message(uuid::read_flash_string(topic), payload, mqtt_retain_);
+    if (!enabled()) {
+        return;
+    }
+    char topic_s[MQTT_TOPIC_MAX_SIZE];
+    queue_publish_message(FlashStringView(topic).c_str(topic_s), payload, mqtt_retain_);
 }
 
 void Mqtt::publish(const __FlashStringHelper * topic, const JsonObject & payload) {
-    publish(uuid::read_flash_string(topic), payload);
+    if (!enabled()) {
+        return;
+    }
+    char topic_s[MQTT_TOPIC_MAX_SIZE];
+    publish(FlashStringView(topic).c_str(topic_s), payload);
 }
 
 // publish json doc, only if its not empty
@@ -615,24 +632,38 @@ void Mqtt::publish(const std::string & topic) {
 
 // MQTT Publish, using a specific retain flag, topic is a flash string, forcing retain flag
 void Mqtt::publish_retain(const __FlashStringHelper * topic, const std::string & payload, bool retain) {
-    queue_publish_message(uuid::read_flash_string(topic), payload, retain);
+    if (!enabled()) {
+        return;
+    }
+    char topic_s[MQTT_TOPIC_MAX_SIZE];
+    queue_publish_message(FlashStringView(topic).c_str(topic_s), payload, retain);
 }
 
 // publish json doc, only if its not empty, using the retain flag
+// with the HA format it's always json, the value templates in the HA config read the values from json
 void Mqtt::publish_retain(const std::string & topic, const JsonObject & payload, bool retain) {
     if (enabled() && payload.size()) {
         std::string payload_text;
-        serializeJson(payload, payload_text); // convert json to string
-        queue_publish_message(topic, payload_text, retain);
+        uint8_t     encoding = (mqtt_format() == Format::HA) ? PAYLOAD_JSON : mqtt_encoding_;
+        Helpers::serialize_payload(payload, payload_text, encoding); // convert json to string, or MessagePack
+        queue_publish_message(topic, payload_text, retain, encoding == PAYLOAD_MSGPACK);
     }
 }
 
 void Mqtt::publish_retain(const __FlashStringHelper * topic, const JsonObject & payload, bool retain) {
-    publish_retain(uuid::read_flash_string(topic), payload, retain);
+    if (!enabled()) {
+        return;
+    }
+    char topic_s[MQTT_TOPIC_MAX_SIZE];
+    publish_retain(FlashStringView(topic).c_str(topic_s), payload, retain);
 }
 
 void Mqtt::publish_ha(const __FlashStringHelper * topic, const JsonObject & payload) {
-    publish_ha(uuid::read_flash_string(topic), payload);
+    if (!enabled()) {
+        return;
+    }
+    char topic_s[MQTT_TOPIC_MAX_SIZE];
+    publish_ha(FlashStringView(topic).c_str(topic_s), payload);
 }
 
 // publish a Home Assistant config topic and payload, with retain flag off.
@@ -758,9 +789,7 @@ void Mqtt::register_mqtt_ha_binary_sensor(const __FlashStringHelper * name, cons
     if (mqtt_format() != Format::HA) {
         return;
     }
-
-    // StaticJsonDocument<EMSESP_MAX_JSON_SIZE_HA_CONFIG> doc;
-    DynamicJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
 
     doc["name"]    = name;
     doc["uniq_id"] = entity;
@@ -785,7 +814,8 @@ void Mqtt::register_mqtt_ha_binary_sensor(const __FlashStringHelper * name, cons
     JsonObject dev = doc.createNestedObject("dev");
     JsonArray  ids = dev.createNestedArray("ids");
     char       ha_device[40];
-    snprintf_P(ha_device, sizeof(ha_device), PSTR("ems-esp-%s"), EMSdevice::device_type_2_device_name(device_type).c_str());
+    char       device_name[20];
+    snprintf_P(ha_device, sizeof(ha_device), PSTR("ems-esp-%s"), EMSdevice::device_type_2_device_name_P(device_type).c_str(device_name));
     ids.add(ha_device);
 
     char topic[MQTT_TOPIC_MAX_SIZE];
@@ -807,9 +837,7 @@ void Mqtt::register_mqtt_ha_sensor(const char *                prefix,
     if (mqtt_format() != Format::HA) {
         return;
     }
-
-    // StaticJsonDocument<EMSESP_MAX_JSON_SIZE_HA_CONFIG> doc;
-    DynamicJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
 
     // create entity by prefixing any given prefix
     char new_entity[50];
@@ -820,7 +848,7 @@ void Mqtt::register_mqtt_ha_sensor(const char *                prefix,
     }
 
     char device_name[50];
-    strncpy(device_name, EMSdevice::device_type_2_device_name(device_type).c_str(), sizeof(device_name));
+    EMSdevice::device_type_2_device_name_P(device_type).copy(device_name, sizeof(device_name));
 
     // build unique identifier, replacing all . with _ as not to break HA
     std::string uniq(50, '\0');
@@ -834,7 +862,8 @@ void Mqtt::register_mqtt_ha_sensor(const char *                prefix,
     // state topic
     char stat_t[MQTT_TOPIC_MAX_SIZE];
     if (suffix != nullptr) {
-        snprintf_P(stat_t, sizeof(stat_t), PSTR("%s/%s_data%s"), mqtt_base_.c_str(), device_name, uuid::read_flash_string(suffix).c_str());
+        char suffix_s[20];
+        snprintf_P(stat_t, sizeof(stat_t), PSTR("%s/%s_data%s"), mqtt_base_.c_str(), device_name, FlashStringView(suffix).c_str(suffix_s));
     } else {
         snprintf_P(stat_t, sizeof(stat_t), PSTR("%s/%s_data"), mqtt_base_.c_str(), device_name);
     }
@@ -849,10 +878,11 @@ void Mqtt::register_mqtt_ha_sensor(const char *                prefix,
 
     // name
     char new_name[50];
+    char name_s[40];
     if (prefix != nullptr) {
-        snprintf_P(new_name, sizeof(new_name), PSTR("%s %s %s"), device_name, prefix, uuid::read_flash_string(name).c_str());
+        snprintf_P(new_name, sizeof(new_name), PSTR("%s %s %s"), device_name, prefix, FlashStringView(name).c_str(name_s));
     } else {
-        snprintf_P(new_name, sizeof(new_name), PSTR("%s %s"), device_name, uuid::read_flash_string(name).c_str());
+        snprintf_P(new_name, sizeof(new_name), PSTR("%s %s"), device_name, FlashStringView(name).c_str(name_s));
     }
     new_name[0] = toupper(new_name[0]); // capitalize first letter
 
@@ -50,12 +50,14 @@ struct MqttMessage {
     const std::string topic;
     const std::string payload;
     const bool        retain;
+    const bool        binary; // MessagePack, it isn't text
 
-    MqttMessage(const uint8_t operation, const std::string & topic, const std::string & payload, bool retain)
+    MqttMessage(const uint8_t operation, const std::string & topic, const std::string & payload, bool retain, bool binary = false)
         : operation(operation)
         , topic(topic)
         , payload(payload)
-        , retain(retain) {
+        , retain(retain)
+        , binary(binary) {
     }
     ~MqttMessage() = default;
 };
@@ -141,10 +143,18 @@ class Mqtt {
         mqtt_publish_fails_ = 0;
     }
 
+    static size_t queue_size() {
+        return mqtt_messages_.size();
+    }
+
     static uint8_t mqtt_format() {
         return mqtt_format_;
     }
 
+    static void encoding(uint8_t encoding) {
+        mqtt_encoding_ = encoding;
+    }
+
     static AsyncMqttClient * client() {
         return mqttClient_;
     }
@@ -187,8 +197,9 @@ class Mqtt {
     static constexpr uint32_t MQTT_PUBLISH_WAIT      = 100; // delay between sending publishes, to account for large payloads
     static constexpr uint8_t  MQTT_PUBLISH_MAX_RETRY = 3;   // max retries for giving up on publishing
 
-    static std::shared_ptr<const MqttMessage> queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, bool retain);
-    static std::shared_ptr<const MqttMessage> queue_publish_message(const std::string & topic, const std::string & payload, bool retain);
+    static std::shared_ptr<const MqttMessage>
+    queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, bool retain, bool binary = false);
+    static std::shared_ptr<const MqttMessage> queue_publish_message(const std::string & topic, const std::string & payload, bool retain, bool binary = false);
     static std::shared_ptr<const MqttMessage> queue_subscribe_message(const std::string & topic);
 
     void on_publish(uint16_t packetId);
@@ -236,6 +247,7 @@ class Mqtt {
     static uint32_t    publish_time_sensor_;
     static uint8_t     mqtt_format_;
     static bool        mqtt_enabled_;
+    static uint8_t     mqtt_encoding_; // from the EMS-ESP settings
 };
 
 } // namespace emsesp
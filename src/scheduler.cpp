@@ -0,0 +1,148 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scheduler.h"
+#include "emsesp.h"
+
+namespace emsesp {
+
+uuid::log::Logger Scheduler::logger_{F_(emsesp), uuid::log::Facility::KERN};
+
+// a periodic task, first run after one interval
+bool Scheduler::add(const __FlashStringHelper * name, const uint8_t priority, const uint32_t interval, TaskFunction function) {
+    return add_task(name, priority, interval, interval, false, function);
+}
+
+// a task that runs once, after delay ms
+bool Scheduler::once(const __FlashStringHelper * name, const uint8_t priority, const uint32_t delay, TaskFunction function) {
+    return add_task(name, priority, 0, delay, true, function);
+}
+
+bool Scheduler::add_task(const __FlashStringHelper * name,
+                         const uint8_t               priority,
+                         const uint32_t              interval,
+                         const uint32_t              delay,
+                         const bool                  once,
+                         TaskFunction                function) {
+    for (auto & task : tasks_) {
+        if (task.function_ == nullptr) {
+            task           = {};
+            task.name_     = name;
+            task.function_ = function;
+            task.priority_ = priority;
+            task.once_     = once;
+            task.interval_ = interval;
+            task.deadline_ = uuid::get_uptime() + delay;
+            task.pass_     = pass_;
+            return true;
+        }
+    }
+
+    LOG_ERROR(F("No room for task %s"), uuid::read_flash_string(name).c_str());
+    return false;
+}
+
+// one pass: every due task runs once, the most urgent first
+void Scheduler::loop() {
+    uint32_t now = uuid::get_uptime();
+    pass_++;
+
+    while (true) {
+        Task * next = nullptr;
+        for (auto & task : tasks_) {
+            if ((task.function_ == nullptr) || (task.pass_ == pass_)) {
+                continue;
+            }
+            if ((task.interval_ || task.once_) && ((int32_t)(now - task.deadline_) < 0)) {
+                continue; // not due
+            }
+            if ((next == nullptr) || (task.priority_ < next->priority_)
+                || ((task.priority_ == next->priority_) && ((int32_t)(task.deadline_ - next->deadline_) < 0))) {
+                next = &task;
+            }
+        }
+
+        if (next == nullptr) {
+            return;
+        }
+
+        run(*next, now);
+
+        // catch up on anything urgent that came in while it was running
+        if (next->priority_ != PRIORITY_HIGH) {
+            for (auto & task : tasks_) {
+                if (task.function_ && (task.priority_ == PRIORITY_HIGH) && (task.interval_ == 0) && !task.once_) {
+                    run(task, now);
+                }
+            }
+        }
+    }
+}
+
+void Scheduler::run(Task & task, const uint32_t now) {
+    if (task.interval_ || task.once_) {
+        uint32_t late = now - task.deadline_;
+        if (late > task.max_late_) {
+            task.max_late_ = late;
+        }
+    }
+
+    TaskFunction function = task.function_;
+    task.pass_            = pass_;
+
+    if (task.once_) {
+        task.function_ = nullptr; // free the slot, the task may add another one
+    } else if (task.interval_) {
+        task.deadline_ += task.interval_;
+        if ((int32_t)(now - task.deadline_) >= 0) {
+            task.deadline_ = now + task.interval_; // too far behind, don't try to catch up
+        }
+    }
+
+    HEAP_SCOPE(task.name_); // allocations are counted by the task that made them
+    uint32_t start = micros();
+    function();
+    uint32_t took = micros() - start;
+
+    task.runs_++;
+    task.total_us_ += took;
+    if (took > task.max_us_) {
+        task.max_us_ = took;
+    }
+}
+
+void Scheduler::show(uuid::console::Shell & shell) const {
+    shell.printfln(F("Tasks:"));
+    shell.printfln(F(" %-10s %4s %8s %10s %8s %8s %8s"), "name", "prio", "interval", "runs", "avg us", "max us", "late ms");
+    for (const auto & task : tasks_) {
+        if (task.function_ == nullptr) {
+            continue;
+        }
+        shell.printfln(F(" %-10s %4d %8lu %10lu %8lu %8lu %8lu"),
+                       uuid::read_flash_string(task.name_).c_str(),
+                       task.priority_,
+                       task.interval_,
+                       task.runs_,
+                       task.runs_ ? task.total_us_ / task.runs_ : 0,
+                       task.max_us_,
+                       task.max_late_);
+    }
+    shell.println();
+}
+
+} // namespace emsesp
@@ -0,0 +1,72 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_SCHEDULER_H
+#define EMSESP_SCHEDULER_H
+
+#include <Arduino.h>
+
+#include <uuid/console.h>
+#include <uuid/log.h>
+
+namespace emsesp {
+
+// runs the services from the main loop, by deadline and priority
+// a task with an interval of 0 runs on every pass. After every task that isn't high priority, those
+// run again, so Rx processing never waits behind a slow MQTT publish or Dallas scan
+class Scheduler {
+  public:
+    enum Priority : uint8_t { PRIORITY_HIGH = 0, PRIORITY_NORMAL, PRIORITY_LOW };
+
+    typedef void (*TaskFunction)();
+
+    bool add(const __FlashStringHelper * name, const uint8_t priority, const uint32_t interval, TaskFunction function);
+    bool once(const __FlashStringHelper * name, const uint8_t priority, const uint32_t delay, TaskFunction function);
+
+    void loop();
+    void show(uuid::console::Shell & shell) const;
+
+  private:
+    static uuid::log::Logger logger_;
+
+    static constexpr uint8_t MAX_TASKS = 16;
+
+    struct Task {
+        const __FlashStringHelper * name_;
+        TaskFunction                function_; // nullptr if the slot is free
+        uint8_t                     priority_;
+        bool                        once_;
+        uint32_t                    interval_; // ms, 0 is every pass
+        uint32_t                    deadline_; // uptime in ms
+        uint32_t                    pass_;     // last pass it ran in
+        uint32_t                    runs_;
+        uint32_t                    total_us_; // time spent running it
+        uint32_t                    max_us_;
+        uint32_t                    max_late_; // ms, longest it ran after its deadline
+    };
+
+    bool add_task(const __FlashStringHelper * name, const uint8_t priority, const uint32_t interval, const uint32_t delay, const bool once, TaskFunction function);
+    void run(Task & task, const uint32_t now);
+
+    Task     tasks_[MAX_TASKS] = {};
+    uint32_t pass_             = 0;
+};
+
+} // namespace emsesp
+
+#endif
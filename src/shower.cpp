@@ -33,8 +33,15 @@ void Shower::start() {
     }
 }
 
+// hot water started or stopped, handle it straight away
+void Shower::tap_water_active(const bool tap_water_active) {
+    tap_water_active_ = tap_water_active;
+    loop();
+}
+
 void Shower::loop() {
-    if (!shower_timer_) {
+    // nothing to time if the hot water is off and no shower was running
+    if (!shower_timer_ || (!tap_water_active_ && !timer_start_)) {
         return;
     }
 
@@ -43,7 +50,7 @@ void Shower::loop() {
     // if already in cold mode, ignore all this logic until we're out of the cold blast
     if (!doing_cold_shot_) {
         // is the hot water running?
-        if (EMSESP::tap_water_active()) {
+        if (tap_water_active_) {
             // if heater was previously off, start the timer
             if (timer_start_ == 0) {
                 // hot water just started...
@@ -131,8 +138,8 @@ void Shower::shower_alert_start() {
 // Publish shower data
 // returns true if added to MQTT queue went ok
 void Shower::publish_values() {
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
-    char                                           s[40];
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
+    char               s[40];
 
     //first sent out the HA MQTT Discovery config topic
     send_MQTT_discovery_config();
@@ -157,7 +164,7 @@ void Shower::send_MQTT_discovery_config() {
 
     //send the config depending on the MQTT format used
     if (Mqtt::mqtt_format() == Mqtt::Format::HA) {
-        StaticJsonDocument<EMSESP_MAX_JSON_SIZE_HA_CONFIG> doc;
+        PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_HA_CONFIG);
         doc["name"]        = FJSON("Shower Data");
         doc["uniq_id"]     = FJSON("shower_data");
         doc["~"]           = Mqtt::base();
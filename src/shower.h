@@ -36,6 +36,7 @@ class Shower {
   public:
     void start();
     void loop();
+    void tap_water_active(const bool tap_water_active);
 
     bool shower_alert() const {
         return shower_alert_;
@@ -72,10 +73,11 @@ class Shower {
     bool     shower_alert_;                       // true if we want the alert of cold water
     bool     mqtt_discovery_config_send_ = false; // for HA MQTT Discovery
     bool     shower_on_;
-    uint32_t timer_start_;     // ms
-    uint32_t timer_pause_;     // ms
-    uint32_t duration_;        // ms
-    bool     doing_cold_shot_; // true if we've just sent a jolt of cold water
+    uint32_t timer_start_;              // ms
+    uint32_t timer_pause_;              // ms
+    uint32_t duration_;                 // ms
+    bool     doing_cold_shot_;          // true if we've just sent a jolt of cold water
+    bool     tap_water_active_ = false; // hot water running, from the boiler
 };
 
 } // namespace emsesp
@@ -0,0 +1,124 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "statistics.h"
+
+namespace emsesp {
+
+// rounded, half away from zero
+static int32_t divide(const int64_t dividend, const int64_t divisor) {
+    return (dividend + ((dividend < 0) ? -divisor / 2 : divisor / 2)) / divisor;
+}
+
+Statistic::Statistic(const char * name, const Kind kind, const uint16_t divider)
+    : name_(name)
+    , kind_(kind)
+    , divider_(divider ? divider : 1) {
+    reset(current_, 0);
+    reset(previous_, 0);
+}
+
+void Statistic::reset(Totals & totals, const uint32_t start) {
+    totals = {start, 0, 0, 0, INT32_MAX, INT32_MIN};
+}
+
+// the last value holds up to now, into the next hour if this one has ended
+void Statistic::advance(const uint32_t now) {
+    if (!started_) {
+        reset(current_, now);
+        last_time_ = now;
+        started_   = true;
+        return;
+    }
+
+    while (true) {
+        uint32_t end   = current_.start + WINDOW;
+        bool     ended = ((int32_t)(now - end) >= 0);
+        uint32_t until = ended ? end : now;
+        if (valid_) {
+            current_.covered += until - last_time_;
+            current_.area += (int64_t)last_ * (until - last_time_);
+        }
+        last_time_ = until;
+        if (!ended) {
+            return;
+        }
+
+        previous_ = current_;
+        reset(current_, end);
+        if (valid_) {
+            current_.min = last_;
+            current_.max = last_;
+        }
+    }
+}
+
+void Statistic::update(const int32_t value, const bool has_value, const uint32_t now) {
+    advance(now);
+    if (!has_value) {
+        valid_ = false;
+        return;
+    }
+
+    int32_t reading = (kind_ == Kind::ON_TIME) ? (value != 0) : value;
+    if ((kind_ == Kind::STARTS) && valid_ && (reading > last_)) {
+        current_.count += reading - last_; // a counter that goes back was reset, that's not counted
+    }
+    current_.min = std::min(current_.min, reading);
+    current_.max = std::max(current_.max, reading);
+    last_        = reading;
+    valid_       = true;
+}
+
+void Statistic::add_json(JsonObject & json, const uint32_t now) {
+    advance(now);
+
+    // the part of the hour before that's still in the last hour
+    uint32_t weight  = WINDOW - (now - current_.start);
+    int64_t  covered = current_.covered + (int64_t)previous_.covered * weight / WINDOW;
+    int64_t  area    = current_.area + previous_.area * weight / WINDOW;
+    if (covered == 0) {
+        return; // no value yet
+    }
+
+    JsonObject figures = json.createNestedObject(name_);
+    switch (kind_) {
+    case Kind::ON_TIME:
+        figures["onTime"] = FixedPoint(divide(area * 1000, covered), 10).json();
+        break;
+    case Kind::STARTS:
+        figures["perHour"] = FixedPoint(divide((int64_t)current_.count * 10 * WINDOW + (int64_t)previous_.count * 10 * weight, WINDOW), 10).json();
+        break;
+    case Kind::VOLUME:
+        figures["liters"] = FixedPoint(divide(area, 60000), 10).json();
+        break;
+    case Kind::LEVEL:
+    default:
+        int32_t min = current_.min;
+        int32_t max = current_.max;
+        if (weight && previous_.covered) {
+            min = std::min(min, previous_.min);
+            max = std::max(max, previous_.max);
+        }
+        figures["mean"] = FixedPoint(divide(area * 10, covered), divider_ * 10).json();
+        figures["min"]  = FixedPoint(min, divider_).json();
+        figures["max"]  = FixedPoint(max, divider_).json();
+        break;
+    }
+}
+
+} // namespace emsesp
@@ -0,0 +1,83 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef EMSESP_STATISTICS_H
+#define EMSESP_STATISTICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "helpers.h"
+
+namespace emsesp {
+
+// a figure derived from a device value as it's decoded, over the last hour, so it doesn't have to be worked out
+// afterwards from a high rate of publishes: the share of the time the burner is on, the starts per hour,
+// the liters of warm water, the mean, min and max of the modulation. A value holds until the next one comes in.
+// It's kept as the running totals of the current hour and the one before, the same few bytes however often it comes.
+// The last hour is the current one plus the part of the one before that's still in it, as if that was spread evenly
+class Statistic {
+  public:
+    static constexpr uint32_t WINDOW = 3600000; // ms
+
+    enum Kind : uint8_t {
+        ON_TIME, // on/off, the share of the time it's on in %
+        STARTS,  // a counter, its increase
+        VOLUME,  // a flow in 0.1 l/min, the liters
+        LEVEL    // the mean, min and max, weighted by time
+    };
+
+    Statistic(const char * name, const Kind kind, const uint16_t divider = 1);
+
+    template <typename Value>
+    void update(const Value & value) {
+        bool has_value = (kind_ == Kind::ON_TIME) ? Helpers::hasValue((uint8_t)value, EMS_VALUE_BOOL) : Helpers::hasValue(value);
+        update(has_value ? (int32_t)value : 0, has_value, uuid::get_uptime());
+    }
+
+    void update(const int32_t value, const bool has_value, const uint32_t now);
+
+    // adds an object with the figures under the name, if there are any yet
+    void add_json(JsonObject & json, const uint32_t now);
+
+  private:
+    struct Totals {
+        uint32_t start;   // uptime in ms
+        uint32_t covered; // ms with a value
+        int64_t  area;    // value times ms
+        uint32_t count;   // increase of a counter
+        int32_t  min;
+        int32_t  max;
+    };
+
+    void advance(const uint32_t now);
+    void reset(Totals & totals, const uint32_t start);
+
+    const char * name_;
+    Kind         kind_;
+    uint16_t     divider_;
+    Totals       current_;
+    Totals       previous_;
+    int32_t      last_      = 0;
+    uint32_t     last_time_ = 0;
+    bool         valid_     = false; // there's a last value
+    bool         started_   = false;
+};
+
+} // namespace emsesp
+
+#endif
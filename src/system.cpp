@@ -98,6 +98,7 @@ bool System::command_publish(const char * value, const int8_t id) {
 // restart EMS-ESP
 void System::restart() {
     LOG_INFO(F("Restarting system..."));
+    FSPersistenceBase::flushAll(); // write any pending settings
     Shell::loop_all();
     delay(1000); // wait a second
 #if defined(ESP8266)
@@ -222,6 +223,10 @@ void System::other_init() {
     EMSESP::webSettingsService.read([&](WebSettings & settings) {
         Helpers::bool_format(settings.bool_format);
         analog_enabled_ = settings.analog_enabled;
+        Mqtt::encoding(settings.mqtt_encoding);
+        ValueFilter::configure(settings.value_filters);
+        EMSESP::history_.configure(settings.history_values, settings.history_spill);
+        EMSESP::stats_publish(settings.stats_publish);
     });
 #ifdef ESP32
     // Wifi power settings 2 - 19.5dBm, raw values 4/dBm (8-78)
@@ -361,7 +366,7 @@ void System::send_heartbeat() {
         return;
     }
 
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_SMALL> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
 
     uint8_t ems_status = EMSESP::bus_status();
     if (ems_status == EMSESP::BUS_STATUS_TX_ERRORS) {
@@ -607,6 +612,10 @@ void System::show_system(uuid::console::Shell & shell) {
     });
 
 #endif
+
+    shell.println();
+    JsonPool::show(shell);
+    ValueFilter::show(shell);
 }
 
 // console commands to add
@@ -799,7 +808,7 @@ bool System::check_upgrade() {
     bool                                           failed = false;
     File                                           file;
     JsonObject                                     network, general, mqtt, custom_settings;
-    StaticJsonDocument<EMSESP_MAX_JSON_SIZE_LARGE> doc;
+    PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE);
 
     // open the system settings:
     // {
@@ -1137,9 +1146,10 @@ bool System::command_info(const char * value, const int8_t id, JsonObject & json
     for (const auto & device_class : EMSFactory::device_handlers()) {
         for (const auto & emsdevice : EMSESP::emsdevices) {
             if ((emsdevice) && (emsdevice->device_type() == device_class.first)) {
-                JsonObject obj = devices2.createNestedObject();
-                obj["type"]    = emsdevice->device_type_name();
-                obj["name"]    = emsdevice->to_string();
+                JsonObject obj    = devices2.createNestedObject();
+                obj["type"]       = emsdevice->device_type_name();
+                obj["name"]       = emsdevice->to_string();
+                obj["tx quality"] = EMSESP::txservice_.quality(emsdevice->device_id());
                 char result[200];
                 obj["handlers"] = emsdevice->show_telegram_handlers(result);
             }
@@ -234,9 +234,35 @@ void RxService::add(uint8_t * data, uint8_t length) {
 // empty queue, don't process
 void TxService::flush_tx_queue() {
     tx_telegrams_.clear();
+    if (slot_.withdraw()) {
+        tx_sending_.clear();
+    }
     tx_telegram_id_ = 0;
 }
 
+// from now on collect the Tx writes, instead of queuing them one by one
+void TxService::start_group() {
+    grouping_ = true;
+}
+
+// put the collected writes at the front of the queue, in the order they were made
+// the group goes on the queue whole or not at all, when there's no room for it its writes are dropped and it's false
+bool TxService::end_group() {
+    grouping_ = false;
+    if (tx_group_.empty()) {
+        return true;
+    }
+
+    withdraw(); // they go before what's waiting in the slot too
+    if (tx_telegrams_.size() + tx_group_.size() > MAX_TX_TELEGRAMS) {
+        LOG_ERROR(F("Tx queue is full, %ld writes dropped"), tx_group_.size());
+        tx_group_.clear();
+        return false;
+    }
+    tx_telegrams_.splice(tx_telegrams_.begin(), tx_group_);
+    return true;
+}
+
 // start and initialize Tx
 // send out request to EMS bus for all devices
 void TxService::start() {
@@ -257,38 +283,145 @@ void TxService::start() {
 }
 
 // sends a 1 byte poll which is our own device ID
-void TxService::send_poll() {
+// sent is set when the receive context has already put it on the bus, then it's only captured
+void TxService::send_poll(const bool sent) {
     //LOG_DEBUG(F("Ack %02X"),ems_bus_id() ^ ems_mask());
     if (tx_mode()) {
-        EMSuart::send_poll(ems_bus_id() ^ ems_mask());
+        uint8_t poll = ems_bus_id() ^ ems_mask();
+        EMSESP::buscapture_.outgoing(&poll, 1);
+        if (!sent) {
+            EMSuart::send_poll(poll);
+        }
     }
 }
 
-// Process the next telegram on the Tx queue
-// This is sent when we receieve a poll request
+// a poll for us that's come to the loop instead of the receive task, e.g. before the slot knew our poll byte
+// it's answered straight away, the same as the receive task would
 void TxService::send() {
+    prepare();
+    answer_poll(0);
+    sent();
+    slot_.expect_nothing(); // the answer comes here too, the loop closes the bus
+}
+
+// in the loop, get what goes out on the next poll for us ready in the slot: the top of the Tx queue, or a poll ack
+// when there's nothing to send or sending is held back. The receive task sends it as soon as we're polled
+void TxService::prepare() {
+    slot_.poll(ems_bus_id() ^ 0x80 ^ ems_mask(), ems_bus_id() ^ ems_mask());
+
     // don't process if we don't have a connection to the EMS bus
     if (!bus_connected()) {
+        withdraw();
         return;
     }
 
-    // if there's nothing in the queue to transmit or sending should be delayed, send back a poll and quit
-    if (tx_telegrams_.empty() || (delayed_send_ && uuid::get_uptime() < delayed_send_)) {
-        send_poll();
+    // reads to a device in backoff wait in the queue until it's over, whatever else is queued goes first
+    auto next = std::find_if(tx_telegrams_.begin(), tx_telegrams_.end(), [&](const QueuedTxTelegram & tx_telegram) {
+        return (tx_telegram.telegram_->operation != Telegram::Operation::TX_READ) || !suspended(tx_telegram.telegram_->dest);
+    });
+    if ((next != tx_telegrams_.begin()) && (next != tx_telegrams_.end())) {
+        tx_telegrams_.splice(tx_telegrams_.begin(), tx_telegrams_, next);
+    }
+    bool waiting = (next != tx_telegrams_.end()); // something that can go now
+
+    // a poll ack makes way for a telegram to send, a telegram that's now held back goes back on the queue
+    bool held = (delayed_send_ && uuid::get_uptime() < delayed_send_);
+    if (slot_.ready() && (tx_sending_.empty() ? (!held && waiting) : held)) {
+        withdraw();
+        waiting = true;
+    }
+    if (!slot_.free()) {
+        return;
+    }
+
+    // if there's nothing in the queue to transmit or sending should be delayed, send back a poll
+    if (!waiting || held) {
+        if (tx_mode()) {
+            uint8_t poll = slot_.ack();
+            slot_.fill(&poll, 1);
+        }
         return;
     }
     delayed_send_ = 0;
 
     // if we're in read-only mode (tx_mode 0) forget the Tx call
-    if (tx_mode()) {
-        send_telegram(tx_telegrams_.front());
+    if (tx_mode() && send_telegram(tx_telegrams_.front())) {
+        tx_sending_.splice(tx_sending_.begin(), tx_telegrams_, tx_telegrams_.begin()); // it's in the slot
+    } else {
+        tx_telegrams_.pop_front(); // remove the telegram from the queue
+    }
+}
+
+// takes back what's ready in the slot, a telegram goes back to the top of the queue
+void TxService::withdraw() {
+    if (slot_.withdraw() && !tx_sending_.empty()) {
+        tx_telegrams_.splice(tx_telegrams_.begin(), tx_sending_);
+    }
+}
+
+// in the UART's receive task, a poll for us. What's ready in the slot goes out now, when there's nothing
+// the poll is missed and we're polled again. Only the slot is touched here, the rest is for the loop
+void TxService::answer_poll(const uint8_t position) {
+    uint8_t   length;
+    uint8_t * data = slot_.take(length);
+    if (data == nullptr) {
+        return;
+    }
+
+    uint16_t status = EMS_TX_STATUS_OK;
+    if (length == 1) {
+        EMSuart::send_poll(data[0]);
+    } else {
+        status = EMSuart::transmit(data, length);
+    }
+    slot_.sent(status, position, ::micros());
+}
+
+// in the UART's receive task, a frame that may be the answer to the telegram we sent from the slot.
+// Then the bus is handed back with our poll ack straight away, the loop only records it
+bool TxService::close_bus(const uint8_t * data, const uint8_t length) {
+    if (!slot_.answered(data, length, ems_bus_id())) {
+        return false;
+    }
+    EMSuart::send_poll(slot_.ack());
+    return true;
+}
+
+// in the loop, after the receive task has sent what was in the slot. A telegram now waits for its reply
+void TxService::sent() {
+    if (!slot_.sent()) {
+        return;
+    }
+
+    EMSESP::buscapture_.outgoing(slot_.data(), slot_.length(), slot_.time_us());
+
+    if (!tx_sending_.empty()) {
+        const QueuedTxTelegram & tx_telegram = tx_sending_.front();
+        auto                     telegram    = tx_telegram.telegram_;
+
+        telegram_last_ = std::make_shared<Telegram>(*telegram); // make a copy of the telegram
+        set_post_send_query(tx_telegram.validateid_);
+
+        LOG_DEBUG(F("Sending %s Tx [#%d], telegram: %s"),
+                  (telegram->operation == Telegram::Operation::TX_WRITE) ? F("write") : F("read"),
+                  tx_telegram.id_,
+                  Helpers::data_to_hex(slot_.data(), slot_.length()).c_str());
+
+        if (slot_.status() == EMS_TX_STATUS_ERR) {
+            LOG_ERROR(F("Failed to transmit Tx via UART."));
+            increment_telegram_fail_count();     // another Tx fail
+            tx_state(Telegram::Operation::NONE); // nothing send, tx not in wait state
+        } else {
+            tx_state(telegram->operation); // tx now in a wait state
+        }
+        tx_sending_.clear();
     }
 
-    tx_telegrams_.pop_front(); // remove the telegram from the queue
+    slot_.release();
 }
 
-// process a Tx telegram
-void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
+// build the raw Tx telegram and put it in the slot for the next poll for us, false if it can't be sent
+bool TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
     static uint8_t telegram_raw[EMS_MAX_TELEGRAM_LENGTH];
 
     // build the header
@@ -344,7 +477,7 @@ void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
 
     if (copy_data) {
         if (telegram->message_length > EMS_MAX_TELEGRAM_MESSAGE_LENGTH) {
-            return; // too big
+            return false; // too big
         }
 
         // add the data to send to to the end of the header
@@ -355,29 +488,13 @@ void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
 
     uint8_t length = message_p;
 
-    telegram_last_ = std::make_shared<Telegram>(*telegram); // make a copy of the telegram
-
     telegram_raw[length] = calculate_crc(telegram_raw, length); // generate and append CRC to the end
 
     length++; // add one since we want to now include the CRC
 
-    LOG_DEBUG(F("Sending %s Tx [#%d], telegram: %s"),
-              (telegram->operation == Telegram::Operation::TX_WRITE) ? F("write") : F("read"),
-              tx_telegram.id_,
-              Helpers::data_to_hex(telegram_raw, length).c_str());
-
-    set_post_send_query(tx_telegram.validateid_);
-    // send the telegram to the UART Tx
-    uint16_t status = EMSuart::transmit(telegram_raw, length);
-
-    if (status == EMS_TX_STATUS_ERR) {
-        LOG_ERROR(F("Failed to transmit Tx via UART."));
-        increment_telegram_fail_count();     // another Tx fail
-        tx_state(Telegram::Operation::NONE); // nothing send, tx not in wait state
-        return;
-    }
-
-    tx_state(telegram->operation); // tx now in a wait state
+    // a read is answered by the device we asked, a write with a single byte
+    slot_.fill(telegram_raw, length, (telegram->operation == Telegram::Operation::TX_READ) ? (telegram->dest & 0x7F) : 0);
+    return true;
 }
 
 /*
@@ -414,18 +531,30 @@ void TxService::add(const uint8_t  operation,
                     const uint8_t  message_length,
                     const uint16_t validateid,
                     const bool     front) {
+    HEAP_SCOPE(F("tx"));
     auto telegram = std::make_shared<Telegram>(operation, ems_bus_id(), dest, type_id, offset, message_data, message_length);
 
 #ifdef EMSESP_DEBUG
     LOG_DEBUG(F("[DEBUG] New Tx [#%d] telegram, length %d"), tx_telegram_id_, message_length);
 #endif
 
+    // hold back writes in a group, a later write to the same place replaces the earlier one
+    if (grouping_ && (operation == Telegram::Operation::TX_WRITE)) {
+        tx_group_.remove_if([&](const QueuedTxTelegram & tx_telegram) {
+            return (tx_telegram.telegram_->dest == dest) && (tx_telegram.telegram_->type_id == type_id) && (tx_telegram.telegram_->offset == offset)
+                   && (tx_telegram.telegram_->message_length == message_length);
+        });
+        tx_group_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validateid);
+        return;
+    }
+
     // if the queue is full, make room but removing the oldest one
     if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
         tx_telegrams_.pop_front();
     }
 
     if (front) {
+        withdraw(); // it goes before what's waiting in the slot too
         tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validateid); // add to front of queue
     } else {
         tx_telegrams_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validateid); // add to back of queue
@@ -488,6 +617,7 @@ void TxService::add(uint8_t operation, const uint8_t * data, const uint8_t lengt
         EMSESP::set_read_id(type_id);
     }
 
+    HEAP_SCOPE(F("tx"));
     auto telegram = std::make_shared<Telegram>(operation, src, dest, type_id, offset, message_data, message_length); // operation is TX_WRITE or TX_READ
 
     // if the queue is full, make room but removing the last one
@@ -500,6 +630,7 @@ void TxService::add(uint8_t operation, const uint8_t * data, const uint8_t lengt
 #endif
 
     if (front) {
+        withdraw(); // it goes before what's waiting in the slot too
         tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validate_id); // add to front of queue
     } else {
         tx_telegrams_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validate_id); // add to back of queue
@@ -510,6 +641,13 @@ void TxService::add(uint8_t operation, const uint8_t * data, const uint8_t lengt
 void TxService::read_request(const uint16_t type_id, const uint8_t dest, const uint8_t offset) {
     LOG_DEBUG(F("Tx read request to device 0x%02X for type ID 0x%02X"), dest, type_id);
 
+    // a device in backoff keeps one of each read waiting, its regular fetches don't pile up in the queue
+    if (suspended(dest) && std::any_of(tx_telegrams_.begin(), tx_telegrams_.end(), [&](const QueuedTxTelegram & tx_telegram) {
+            return ((tx_telegram.telegram_->dest & 0x7F) == (dest & 0x7F)) && (tx_telegram.telegram_->type_id == type_id) && (tx_telegram.telegram_->offset == offset);
+        })) {
+        return;
+    }
+
     uint8_t message_data[1] = {EMS_MAX_TELEGRAM_LENGTH}; // request all data, 32 bytes
     add(Telegram::Operation::TX_READ, dest, type_id, offset, message_data, 1, 0);
 }
@@ -560,13 +698,14 @@ void TxService::send_raw(const char * telegram_data) {
 void TxService::retry_tx(const uint8_t operation, const uint8_t * data, const uint8_t length) {
     // have we reached the limit? if so, reset count and give up
     if (++retry_count_ > MAXIMUM_TX_RETRIES) {
-        reset_retry_count();             // give up
-        increment_telegram_fail_count(); // another Tx fail
-
         LOG_ERROR(F("Last Tx %s operation failed after %d retries. Ignoring request: %s"),
                   (operation == Telegram::Operation::TX_WRITE) ? F("Write") : F("Read"),
-                  MAXIMUM_TX_RETRIES,
+                  retry_count_ - 1,
                   telegram_last_->to_string().c_str());
+
+        reset_retry_count();             // give up
+        increment_telegram_fail_count(); // another Tx fail
+        tx_fail();
         return;
     }
 
@@ -583,9 +722,69 @@ void TxService::retry_tx(const uint8_t operation, const uint8_t * data, const ui
         tx_telegrams_.pop_back();
     }
 
+    withdraw(); // the retry goes before what's waiting in the slot
     tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram_last_), true, get_post_send_query());
 }
 
+// the destination of the last Tx answered
+void TxService::tx_success() {
+    auto & h = health(telegram_last_->dest);
+    h.successes_++;
+    if (h.consecutive_fails_) {
+        LOG_INFO(F("Device 0x%02X is answering again"), h.dest_);
+        h.consecutive_fails_ = 0;
+        h.suspended_until_   = 0;
+    }
+}
+
+// the destination of the last Tx didn't answer, even after retries
+// it's only suspended when that happens a few times in a row, the bus master never is
+void TxService::tx_fail() {
+    auto & h = health(telegram_last_->dest);
+    h.failures_++;
+    if (h.consecutive_fails_ < 0xFF) {
+        h.consecutive_fails_++;
+    }
+    if ((h.consecutive_fails_ < TX_FAILS_BEFORE_BACKOFF) || (h.dest_ == EMSdevice::EMS_DEVICE_ID_BOILER)) {
+        return;
+    }
+
+    uint32_t backoff   = TX_BACKOFF_MIN << std::min(h.consecutive_fails_ - TX_FAILS_BEFORE_BACKOFF, 6);
+    backoff            = std::min(backoff, TX_BACKOFF_MAX);
+    h.suspended_until_ = uuid::get_uptime() + backoff;
+    LOG_WARNING(F("Device 0x%02X is not answering, reads to it wait for %d seconds"), h.dest_, backoff / 1000);
+}
+
+// find or add the Tx state of a destination
+TxService::TxHealth & TxService::health(const uint8_t dest) {
+    for (auto & h : tx_health_) {
+        if (h.dest_ == (dest & 0x7F)) {
+            return h;
+        }
+    }
+    tx_health_.push_back({(uint8_t)(dest & 0x7F), 0, 0, 0, 0});
+    return tx_health_.back();
+}
+
+// Tx quality of a single destination, 100% if we never sent to it
+uint8_t TxService::quality(const uint8_t dest) const {
+    for (const auto & h : tx_health_) {
+        if (h.dest_ == (dest & 0x7F)) {
+            return h.quality();
+        }
+    }
+    return 100;
+}
+
+bool TxService::suspended(const uint8_t dest) const {
+    for (const auto & h : tx_health_) {
+        if (h.dest_ == (dest & 0x7F)) {
+            return (h.consecutive_fails_ >= TX_FAILS_BEFORE_BACKOFF) && (uuid::get_uptime() < h.suspended_until_);
+        }
+    }
+    return false;
+}
+
 uint16_t TxService::read_next_tx() {
     // add to the top of the queue
     uint8_t message_data[1] = {EMS_MAX_TELEGRAM_LENGTH}; // request all data, 32 bytes
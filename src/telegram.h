@@ -34,6 +34,7 @@
 #include <uuid/log.h>
 
 #include "helpers.h"
+#include "txslot.h"
 
 // default values for null values
 static constexpr uint8_t EMS_VALUE_BOOL     = 0xFF; // used to mark that something is a boolean
@@ -127,6 +128,165 @@ class Telegram {
     int8_t _getDataPosition(const uint8_t index, const uint8_t size) const;
 };
 
+// Telegram layouts declared at compile time, as an alternative to a series of read_value() calls
+// a layout is a TelegramSchema of TelegramFields, each a member with its byte index, width and optional bit:
+//   using UBAMonitorFast = TelegramSchema<EMS_FIELD(Boiler, selFlowTemp_, 0), EMS_FIELD_BIT(Boiler, burnGas_, 7, 0)>;
+//   changed_ |= UBAMonitorFast::decode(*this, *telegram) != 0;
+// the telegram's offset window is checked once, and fields that overlap are a compile error
+// a field declared with EMS_FIELD_FILTERED has a ValueFilter that decides if it changed, so the schema's filtered mask
+// can take it out of what decode() returns
+
+// big-endian load of 1 to 4 bytes
+template <uint8_t Width>
+struct TelegramLoad;
+
+template <>
+struct TelegramLoad<1> {
+    static uint32_t load(const uint8_t * p) {
+        return p[0];
+    }
+};
+
+template <>
+struct TelegramLoad<2> {
+    static uint32_t load(const uint8_t * p) {
+        return ((uint32_t)p[0] << 8) | p[1];
+    }
+};
+
+template <>
+struct TelegramLoad<3> {
+    static uint32_t load(const uint8_t * p) {
+        return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    }
+};
+
+template <>
+struct TelegramLoad<4> {
+    static uint32_t load(const uint8_t * p) {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+};
+
+// a value at a byte index, Width bytes wide, or a single bit of the byte if Bit is 0-7
+template <typename Device, typename Value, Value Device::*Member, uint8_t Index, uint8_t Width = sizeof(Value), int8_t Bit = -1, bool Filtered = false>
+struct TelegramField {
+    static_assert((Width >= 1) && (Width <= 4), "a telegram field is 1 to 4 bytes");
+    static_assert(Width <= sizeof(Value), "a telegram field is wider than its member");
+    static_assert(Bit < 8, "a telegram bit is 0 to 7");
+    static_assert((Bit < 0) || (Width == 1), "a telegram bit is in a single byte");
+
+    static constexpr uint16_t first    = Index;
+    static constexpr uint16_t end      = Index + Width; // one past the last byte
+    static constexpr int8_t   bit      = Bit;
+    static constexpr bool     filtered = Filtered;
+
+    // data points at the field's first byte. We always store the value, like read_value()
+    static bool decode(Device & device, const uint8_t * data) {
+        Value value = (Bit < 0) ? (Value)TelegramLoad<Width>::load(data) : (Value)((data[0] >> (Bit & 0x07)) & 0x01);
+        if (device.*Member == value) {
+            return false;
+        }
+        device.*Member = value;
+        return true;
+    }
+};
+
+#define EMS_FIELD(device, member, index) TelegramField<device, decltype(device::member), &device::member, index>
+#define EMS_FIELD_WIDTH(device, member, index, width) TelegramField<device, decltype(device::member), &device::member, index, width>
+#define EMS_FIELD_BIT(device, member, index, bit) TelegramField<device, decltype(device::member), &device::member, index, 1, bit>
+#define EMS_FIELD_FILTERED(device, member, index) TelegramField<device, decltype(device::member), &device::member, index, sizeof(device::member), -1, true>
+
+// compile time checks on a layout
+template <typename A, typename B>
+struct TelegramFieldsOverlap {
+    static constexpr bool value = (A::first < B::end) && (B::first < A::end) && ((A::bit < 0) || (B::bit < 0) || (A::bit == B::bit));
+};
+
+template <typename Field, typename... Others>
+struct TelegramFieldOverlapsAny {
+    static constexpr bool value = false;
+};
+
+template <typename Field, typename Other, typename... Rest>
+struct TelegramFieldOverlapsAny<Field, Other, Rest...> {
+    static constexpr bool value = TelegramFieldsOverlap<Field, Other>::value || TelegramFieldOverlapsAny<Field, Rest...>::value;
+};
+
+// N is the bit of the first field in the change mask
+template <uint8_t N, typename... Fields>
+struct TelegramSchemaLayout {
+    static constexpr bool     valid    = true;
+    static constexpr uint16_t first    = 0xFFFF;
+    static constexpr uint16_t end      = 0;
+    static constexpr uint32_t filtered = 0;
+};
+
+template <uint8_t N, typename Field, typename... Rest>
+struct TelegramSchemaLayout<N, Field, Rest...> {
+    using Next = TelegramSchemaLayout<N + 1, Rest...>;
+
+    static constexpr bool     valid    = !TelegramFieldOverlapsAny<Field, Rest...>::value && Next::valid;
+    static constexpr uint16_t first    = (Field::first < Next::first) ? Field::first : Next::first;
+    static constexpr uint16_t end      = (Field::end > Next::end) ? Field::end : Next::end;
+    static constexpr uint32_t filtered = (Field::filtered ? (1UL << N) : 0) | Next::filtered;
+};
+
+// decodes the fields in order, N is the bit in the change mask
+template <uint8_t N, typename... Fields>
+struct TelegramSchemaDecoder {
+    template <typename Device>
+    static uint32_t all(Device &, const uint8_t *, const uint8_t) {
+        return 0;
+    }
+
+    template <typename Device>
+    static uint32_t window(Device &, const uint8_t *, const uint8_t, const uint16_t) {
+        return 0;
+    }
+};
+
+template <uint8_t N, typename Field, typename... Rest>
+struct TelegramSchemaDecoder<N, Field, Rest...> {
+    // the telegram covers the whole layout, no checks needed
+    template <typename Device>
+    static uint32_t all(Device & device, const uint8_t * data, const uint8_t offset) {
+        uint32_t changed = Field::decode(device, data + (Field::first - offset)) ? (1UL << N) : 0;
+        return changed | TelegramSchemaDecoder<N + 1, Rest...>::all(device, data, offset);
+    }
+
+    // only the fields inside the telegram's window of offset to end
+    template <typename Device>
+    static uint32_t window(Device & device, const uint8_t * data, const uint8_t offset, const uint16_t end) {
+        uint32_t changed = 0;
+        if ((Field::first >= offset) && (Field::end <= end) && Field::decode(device, data + (Field::first - offset))) {
+            changed = (1UL << N);
+        }
+        return changed | TelegramSchemaDecoder<N + 1, Rest...>::window(device, data, offset, end);
+    }
+};
+
+template <typename... Fields>
+class TelegramSchema {
+  public:
+    static_assert(sizeof...(Fields) <= 32, "a telegram schema has at most 32 fields");
+    static_assert(TelegramSchemaLayout<0, Fields...>::valid, "fields in a telegram schema overlap");
+
+    static constexpr uint16_t first    = TelegramSchemaLayout<0, Fields...>::first;
+    static constexpr uint16_t end      = TelegramSchemaLayout<0, Fields...>::end;
+    static constexpr uint32_t filtered = TelegramSchemaLayout<0, Fields...>::filtered; // the EMS_FIELD_FILTERED fields in the change mask
+
+    // returns a mask of the fields that changed, bit 0 is the first field
+    template <typename Device>
+    static uint32_t decode(Device & device, const Telegram & telegram) {
+        uint16_t telegram_end = telegram.offset + telegram.message_length;
+        if ((telegram.offset <= first) && (end <= telegram_end)) {
+            return TelegramSchemaDecoder<0, Fields...>::all(device, telegram.message_data, telegram.offset);
+        }
+        return TelegramSchemaDecoder<0, Fields...>::window(device, telegram.message_data, telegram.offset, telegram_end);
+    }
+};
+
 class EMSbus {
   public:
     static uuid::log::Logger logger_;
@@ -268,6 +428,10 @@ class TxService : public EMSbus {
 
     void     start();
     void     send();
+    void     prepare();
+    void     answer_poll(const uint8_t position);
+    void     sent();
+    bool     close_bus(const uint8_t * data, const uint8_t length);
     void     add(const uint8_t  operation,
                  const uint8_t  dest,
                  const uint16_t type_id,
@@ -279,9 +443,12 @@ class TxService : public EMSbus {
     void     add(const uint8_t operation, const uint8_t * data, const uint8_t length, const uint16_t validateid, const bool front = false);
     void     read_request(const uint16_t type_id, const uint8_t dest, const uint8_t offset = 0);
     void     send_raw(const char * telegram_data);
-    void     send_poll();
+    void     send_poll(const bool sent = false);
     void     flush_tx_queue();
+    void     start_group();
+    bool     end_group();
     void     retry_tx(const uint8_t operation, const uint8_t * data, const uint8_t length);
+    void     tx_success();
     bool     is_last_tx(const uint8_t src, const uint8_t dest) const;
     uint16_t post_send_query();
     uint16_t read_next_tx();
@@ -333,6 +500,31 @@ class TxService : public EMSbus {
         telegram_fail_count_++;
     }
 
+    // Tx state per destination, so a device that doesn't answer stops taking up poll slots
+    // after failing a few times in a row, reads to it wait for a backoff time which doubles with every further failure
+    class TxHealth {
+      public:
+        uint8_t  dest_;
+        uint32_t successes_;
+        uint32_t failures_;
+        uint8_t  consecutive_fails_;
+        uint32_t suspended_until_; // uptime in ms
+
+        uint8_t quality() const {
+            if (failures_ == 0) {
+                return 100;
+            }
+            return (successes_ * 100) / (successes_ + failures_);
+        }
+    };
+
+    const std::vector<TxHealth> & tx_health() const {
+        return tx_health_;
+    }
+
+    uint8_t quality(const uint8_t dest) const;
+    bool    suspended(const uint8_t dest) const;
+
     uint32_t telegram_write_count() const {
         return telegram_write_count_;
     }
@@ -365,15 +557,30 @@ class TxService : public EMSbus {
         return tx_telegrams_;
     }
 
+    size_t queue_size() const {
+        return tx_telegrams_.size();
+    }
+
+    TxSlot<EMS_MAX_TELEGRAM_LENGTH> & slot() {
+        return slot_;
+    }
+
 #if defined(EMSESP_DEBUG)
     static constexpr uint8_t MAXIMUM_TX_RETRIES = 0; // when compiled with EMSESP_DEBUG don't retry
 #else
     static constexpr uint8_t MAXIMUM_TX_RETRIES = 3;
 #endif
-    static constexpr uint32_t POST_SEND_DELAY = 2000;
+    static constexpr uint32_t POST_SEND_DELAY         = 2000;
+    static constexpr uint8_t  TX_FAILS_BEFORE_BACKOFF = 3;      // Tx that gave up in a row before a device is suspended
+    static constexpr uint32_t TX_BACKOFF_MIN          = 10000;  // ms, first suspension after a device stops answering
+    static constexpr uint32_t TX_BACKOFF_MAX          = 600000; // ms, the longest we wait before probing it again
 
   private:
     std::list<QueuedTxTelegram> tx_telegrams_; // the Tx queue
+    std::list<QueuedTxTelegram> tx_group_;     // writes held back until end_group()
+    std::list<QueuedTxTelegram> tx_sending_;   // the telegram in the slot, if it's one
+    bool                        grouping_ = false;
+    std::vector<TxHealth>       tx_health_; // one per destination we've sent to
 
     uint32_t telegram_read_count_  = 0; // # Tx successful reads
     uint32_t telegram_write_count_ = 0; // # Tx successful writes
@@ -386,7 +593,12 @@ class TxService : public EMSbus {
 
     uint8_t tx_telegram_id_ = 0; // queue counter
 
-    void send_telegram(const QueuedTxTelegram & tx_telegram);
+    TxSlot<EMS_MAX_TELEGRAM_LENGTH> slot_; // the reply to the next poll for us
+
+    bool       send_telegram(const QueuedTxTelegram & tx_telegram);
+    void       withdraw();
+    void       tx_fail();
+    TxHealth & health(const uint8_t dest);
     // void send_telegram(const uint8_t * data, const uint8_t length);
 };
 
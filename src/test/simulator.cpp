@@ -0,0 +1,353 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(EMSESP_STANDALONE)
+
+#include "simulator.h"
+#include "emsesp.h"
+#include "emsuart_standalone.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace emsesp {
+
+Simulator * Simulator::active_ = nullptr;
+
+// the register contents are taken from real telegrams, see test.cpp
+Simulator::Simulator()
+    : clock_us_((uint64_t)::millis() * 1000)
+    , next_command_(::millis() + COMMAND_INTERVAL)
+    , queue_busy_since_(0)
+    , queue_busy_(false)
+    , commands_sent_(0)
+    , stats_() {
+    uint32_t start = ::millis();
+
+    // boiler, the bus master. UBADevices has a bit for each device on the bus, including us
+    devices_.push_back({0x08,
+                        {{0x02, {123, 0x06, 0x01}},
+                         {0x07, {0x09, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+                         {0x14, {0x3C, 0x1F, 0xAC}},
+                         {0x18, {0x00, 0x02, 0x5A, 0x73, 0x3D, 0x0A, 0x10, 0x65, 0x40, 0x02, 0x1A, 0x80, 0x00,
+                                 0x01, 0xE1, 0x01, 0x76, 0x0E, 0x3D, 0x48, 0x00, 0xC9, 0x44, 0x02, 0x00}},
+                         {0x33, {0x08, 0xFF, 0x34, 0xFB, 0x00, 0x28, 0x00, 0x00, 0x46, 0x00, 0xFF, 0xFF, 0x00}},
+                         {0x34, {0x36, 0x01, 0xA5, 0x80, 0x00, 0x21, 0x00, 0x00, 0x01, 0x00, 0x01, 0x3E, 0x8D, 0x03, 0x77, 0x91, 0x00, 0x80, 0x00}}},
+                        {{0x18, BROADCAST_FAST, start}, {0x34, BROADCAST_SLOW, start}, {0x07, BROADCAST_SLOW, start}}});
+
+    // RC300 thermostat
+    devices_.push_back({0x10,
+                        {{0x02, {158, 0x17, 0x03}},
+                         {0x02A5, {0x00, 0xD7, 0x21, 0x00, 0x00, 0x00, 0x00, 0x30, 0x01, 0x84, 0x01, 0x01,
+                                   0x03, 0x01, 0x84, 0x01, 0xF1, 0x00, 0x00, 0x11, 0x01, 0x00, 0x08, 0x63, 0x00}}},
+                        {{0x02A5, BROADCAST_SLOW, start}}});
+
+    // MM100 mixer on HC1
+    devices_.push_back({0x20, {{0x02, {160, 0x10, 0x01}}, {0x02D7, {0x01, 0x00, 0x64, 0x01, 0xC2, 0x2D}}}, {{0x02D7, BROADCAST_SLOW, start}}});
+
+    // SM100 solar module
+    devices_.push_back({0x30,
+                        {{0x02, {163, 0x11, 0x05}},
+                         {0x0364, {0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x1E, 0x0B, 0x09, 0x64, 0x00, 0x00, 0x00, 0x00}},
+                         {0x036A, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04}}},
+                        {{0x0364, BROADCAST_SLOW, start}, {0x036A, BROADCAST_SLOW, start}}});
+}
+
+// runs the bus for a number of simulated minutes and shows the results
+void Simulator::run(uuid::console::Shell & shell, const uint32_t minutes) {
+    Simulator simulator;
+    active_ = &simulator;
+    EMSuart::tx_handler(tx_handler);
+
+    // the log would be most of the run time
+    auto log_level = shell.log_level();
+    shell.log_level(uuid::log::Level::WARNING);
+
+    auto     host_start = std::chrono::steady_clock::now();
+    uint32_t end        = simulator.now() + minutes * 60000;
+    while ((int32_t)(end - simulator.now()) > 0) {
+        simulator.command();
+        simulator.cycle();
+    }
+    auto host_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - host_start).count();
+
+    shell.log_level(log_level);
+    EMSuart::tx_handler(nullptr);
+    active_ = nullptr;
+
+    simulator.report(shell, minutes, host_ms);
+}
+
+// one poll cycle: the boiler sends what is due, then polls us and the other devices
+void Simulator::cycle() {
+    broadcast(devices_.front());
+
+    poll(nullptr, EMSbus::ems_bus_id());
+    for (auto it = devices_.begin() + 1; it != devices_.end(); ++it) {
+        poll(&(*it), it->device_id_);
+    }
+
+    EMSESP::loop();
+    sample_queue();
+}
+
+// a poll to us runs the real Tx code, the telegram we send goes to the simulated device
+// another device sends one of its broadcasts, or just its own id back
+void Simulator::poll(Device * device, const uint8_t device_id) {
+    tx_.clear();
+
+    if (device != nullptr) {
+        deliver({(uint8_t)(device_id | 0x80)}, false);
+        advance(REPLY_TIME_US);
+        if (!broadcast(*device)) {
+            deliver({device_id}, false);
+        }
+        return;
+    }
+
+    stats_.polls_us_++;
+    auto start = std::chrono::steady_clock::now();
+    deliver({(uint8_t)(device_id | 0x80)}, false);
+    uint64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if (tx_.size() > 1) {
+        stats_.transmits_++;
+        stats_.latency_sum_ += latency;
+        stats_.latency_max_ = std::max(stats_.latency_max_, latency);
+
+        std::vector<uint8_t> request = tx_;
+        tx_.clear();
+        advance(REPLY_TIME_US);
+        deliver(request, false); // our own echo
+        answer(request);
+    }
+
+    // the poll reply that hands the bus back
+    if (!tx_.empty()) {
+        advance(tx_.size() * BYTE_TIME_US + BREAK_TIME_US);
+    }
+
+    sample_queue();
+}
+
+// a read is answered from the registers, a write goes into them and is acked
+void Simulator::answer(const std::vector<uint8_t> & request) {
+    Device * device = find(request[1] & 0x7F);
+    if ((device == nullptr) || (request.size() < 6)) {
+        stats_.unanswered_++;
+        return;
+    }
+
+    bool     read   = request[1] & 0x80;
+    bool     plus   = (request[2] == 0xFF);
+    uint8_t  offset = request[3];
+    uint8_t  length = 0;
+    uint8_t  data   = 0; // start of the data in a write
+    uint16_t type_id;
+    if (plus) {
+        uint8_t type_pos = read ? 5 : 4;
+        if (request.size() < (size_t)(type_pos + 3)) {
+            stats_.unanswered_++;
+            return;
+        }
+        type_id = (request[type_pos] << 8) + request[type_pos + 1] + 0x100;
+        length  = read ? request[4] : 0;
+        data    = type_pos + 2;
+    } else {
+        type_id = request[2];
+        length  = read ? request[4] : 0;
+        data    = 4;
+    }
+
+    Register & reg = find(*device, type_id);
+    advance(REPLY_TIME_US);
+
+    if (read) {
+        std::vector<uint8_t> reply = {device->device_id_, EMSbus::ems_bus_id()};
+        if (plus) {
+            reply.insert(reply.end(), {0xFF, offset, (uint8_t)((type_id >> 8) - 1), (uint8_t)(type_id & 0xFF)});
+        } else {
+            reply.insert(reply.end(), {(uint8_t)type_id, offset});
+        }
+        // a telegram is at most 32 bytes with its CRC
+        size_t end = std::min(std::min(reg.data_.size(), (size_t)offset + length), offset + EMS_MAX_TELEGRAM_LENGTH - 1 - reply.size());
+        for (size_t i = offset; i < end; i++) {
+            reply.push_back(reg.data_[i]);
+        }
+        stats_.reads_++;
+        deliver(reply);
+        return;
+    }
+
+    // the data is everything between the header and the CRC
+    size_t count = request.size() - 1 - data;
+    if (reg.data_.size() < offset + count) {
+        reg.data_.resize(offset + count);
+    }
+    std::copy(request.begin() + data, request.end() - 1, reg.data_.begin() + offset);
+    stats_.writes_++;
+    deliver({TxService::TX_WRITE_SUCCESS}, false);
+
+    if (!pending_commands_.empty()) {
+        uint32_t rtt = now() - pending_commands_.front();
+        pending_commands_.pop_front();
+        stats_.rtt_sum_ += rtt;
+        stats_.rtt_min_ = stats_.acked_ ? std::min(stats_.rtt_min_, rtt) : rtt;
+        stats_.rtt_max_ = std::max(stats_.rtt_max_, rtt);
+        stats_.acked_++;
+    }
+}
+
+// sends the first broadcast that is due, returns false if there was none
+bool Simulator::broadcast(Device & device) {
+    for (auto & broadcast : device.broadcasts_) {
+        if ((int32_t)(now() - broadcast.next_) < 0) {
+            continue;
+        }
+        broadcast.next_ += broadcast.interval_;
+
+        Register &           reg   = find(device, broadcast.type_id_);
+        std::vector<uint8_t> frame = {device.device_id_, 0x00};
+        if (broadcast.type_id_ > 0xFF) {
+            frame.insert(frame.end(), {0xFF, 0x00, (uint8_t)((broadcast.type_id_ >> 8) - 1), (uint8_t)(broadcast.type_id_ & 0xFF)});
+        } else {
+            frame.insert(frame.end(), {(uint8_t)broadcast.type_id_, 0x00});
+        }
+        for (size_t i = 0; (i < reg.data_.size()) && (frame.size() < EMS_MAX_TELEGRAM_LENGTH - 1); i++) {
+            frame.push_back(reg.data_[i]);
+        }
+        deliver(frame);
+        return true;
+    }
+    return false;
+}
+
+// every so often a command, alternating between the boiler (EMS 1.0) and the thermostat (EMS+)
+void Simulator::command() {
+    if ((int32_t)(now() - next_command_) < 0) {
+        return;
+    }
+    next_command_ += COMMAND_INTERVAL;
+
+    char value[8];
+    bool ok;
+    if (commands_sent_ & 1) {
+        snprintf_P(value, sizeof(value), PSTR("%d.5"), 18 + (commands_sent_ % 4));
+        ok = Command::call(EMSdevice::DeviceType::THERMOSTAT, "temp", value, -1);
+    } else {
+        snprintf_P(value, sizeof(value), PSTR("%d"), 40 + (commands_sent_ % 20));
+        ok = Command::call(EMSdevice::DeviceType::BOILER, "flowtemp", value, -1);
+    }
+    commands_sent_++;
+
+    if (ok) {
+        stats_.commands_++;
+        pending_commands_.push_back(now());
+    }
+}
+
+// how long the Tx queue takes to empty once something is in it
+void Simulator::sample_queue() {
+    uint32_t size     = EMSESP::txservice_.queue_size();
+    stats_.queue_max_ = std::max(stats_.queue_max_, size);
+
+    if (size && !queue_busy_) {
+        queue_busy_       = true;
+        queue_busy_since_ = now();
+    } else if (!size && queue_busy_) {
+        queue_busy_      = false;
+        uint32_t drained = now() - queue_busy_since_;
+        stats_.drains_++;
+        stats_.drain_sum_ += drained;
+        stats_.drain_max_ = std::max(stats_.drain_max_, drained);
+    }
+}
+
+// puts a frame on the bus, the same way the UART would hand it over
+void Simulator::deliver(const std::vector<uint8_t> & frame, const bool add_crc) {
+    uint8_t data[EMS_MAX_TELEGRAM_LENGTH + 1];
+    uint8_t length = std::min(frame.size(), sizeof(data) - 1);
+    std::copy(frame.begin(), frame.begin() + length, data);
+    if (add_crc && (length > 1)) {
+        data[length] = EMSbus::calculate_crc(data, length);
+        length++;
+    }
+
+    advance(length * BYTE_TIME_US + BREAK_TIME_US);
+    stats_.frames_++;
+    EMSESP::incoming_telegram(data, length);
+}
+
+void Simulator::advance(const uint32_t us) {
+    clock_us_ += us;
+    set_millis(clock_us_ / 1000);
+    uuid::loop(); // so the uptime follows
+}
+
+Simulator::Device * Simulator::find(const uint8_t device_id) {
+    for (auto & device : devices_) {
+        if (device.device_id_ == device_id) {
+            return &device;
+        }
+    }
+    return nullptr;
+}
+
+// a type the device doesn't know reads back empty
+Simulator::Register & Simulator::find(Device & device, const uint16_t type_id) {
+    for (auto & reg : device.registers_) {
+        if (reg.type_id_ == type_id) {
+            return reg;
+        }
+    }
+    device.registers_.push_back({type_id, {}});
+    return device.registers_.back();
+}
+
+void Simulator::tx_handler(const uint8_t * data, const uint8_t length) {
+    if (active_) {
+        active_->tx_.assign(data, data + length);
+    }
+}
+
+void Simulator::report(uuid::console::Shell & shell, const uint32_t minutes, const uint64_t host_ms) const {
+    shell.printfln(F("Simulated %lu minutes on the bus in %lu ms"), minutes, (uint32_t)host_ms);
+    shell.printfln(F("  Frames: %lu, polls to us: %lu, our transmits: %lu"), stats_.frames_, stats_.polls_us_, stats_.transmits_);
+    shell.printfln(F("  Reads answered: %lu, writes acked: %lu, unanswered: %lu"), stats_.reads_, stats_.writes_, stats_.unanswered_);
+    shell.printfln(F("  Tx telegrams per minute: %lu"), minutes ? stats_.transmits_ / minutes : 0);
+    if (stats_.transmits_) {
+        shell.printfln(F("  Poll to transmit, host time: %lu ns (max %lu ns)"),
+                       (uint32_t)(stats_.latency_sum_ / stats_.transmits_),
+                       (uint32_t)stats_.latency_max_);
+    }
+    shell.printfln(F("  Tx queue: max %lu telegrams"), stats_.queue_max_);
+    if (stats_.drains_) {
+        shell.printfln(F("  Tx queue drained %lu times in %lu ms (max %lu ms)"), stats_.drains_, (uint32_t)(stats_.drain_sum_ / stats_.drains_), stats_.drain_max_);
+    }
+    if (stats_.commands_) {
+        shell.printfln(F("  Commands: %lu, acked: %lu"), stats_.commands_, stats_.acked_);
+        if (stats_.acked_) {
+            shell.printfln(F("  Command round trip: %lu ms (min %lu, max %lu)"), (uint32_t)(stats_.rtt_sum_ / stats_.acked_), stats_.rtt_min_, stats_.rtt_max_);
+        }
+    }
+    shell.println();
+}
+
+} // namespace emsesp
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(EMSESP_STANDALONE)
+
+#ifndef EMSESP_SIMULATOR_H
+#define EMSESP_SIMULATOR_H
+
+#include <Arduino.h>
+
+#include <vector>
+#include <deque>
+
+#include <uuid/console.h>
+
+namespace emsesp {
+
+// a simulated EMS bus: a boiler as bus master running the poll cycle, and an RC300, MM100 and SM100
+// that answer reads from their registers and ack writes. Everything goes through the real
+// EMSESP::incoming_telegram() and TxService, only the UART is replaced.
+// The clock is virtual and moves on with the bytes on the bus, so the results are the same on every run
+// and an hour on the bus takes a few seconds
+class Simulator {
+  public:
+    static void run(uuid::console::Shell & shell, const uint32_t minutes);
+
+  private:
+    static constexpr uint32_t BYTE_TIME_US     = 1042;  // 10 bits at 9600 baud
+    static constexpr uint32_t BREAK_TIME_US    = 1146;  // the 11 bit break ending every frame
+    static constexpr uint32_t REPLY_TIME_US    = 2000;  // before a device starts its answer
+    static constexpr uint32_t BROADCAST_FAST   = 10000; // ms, UBAMonitorFast
+    static constexpr uint32_t BROADCAST_SLOW   = 60000; // ms, everything else
+    static constexpr uint32_t COMMAND_INTERVAL = 30000; // ms, a command from MQTT or the web
+
+    struct Register {
+        uint16_t             type_id_;
+        std::vector<uint8_t> data_;
+    };
+
+    struct Broadcast {
+        uint16_t type_id_;
+        uint32_t interval_; // ms
+        uint32_t next_;     // when it's due, virtual ms
+    };
+
+    struct Device {
+        uint8_t                device_id_;
+        std::vector<Register>  registers_;
+        std::vector<Broadcast> broadcasts_; // sent to all when polled, one at a time
+    };
+
+    struct Stats {
+        uint32_t frames_;
+        uint32_t polls_us_;
+        uint32_t transmits_;
+        uint32_t reads_;
+        uint32_t writes_;
+        uint32_t unanswered_;
+        uint64_t latency_sum_; // host time from a poll to our transmit, ns
+        uint64_t latency_max_;
+        uint32_t queue_max_;
+        uint32_t drains_;      // times the Tx queue was emptied after filling up
+        uint64_t drain_sum_;   // ms
+        uint32_t drain_max_;
+        uint32_t commands_;
+        uint32_t acked_;
+        uint64_t rtt_sum_;     // ms from a command to the ack of its write
+        uint32_t rtt_min_;
+        uint32_t rtt_max_;
+    };
+
+    Simulator();
+
+    void cycle();
+    void poll(Device * device, const uint8_t device_id);
+    void answer(const std::vector<uint8_t> & request);
+    bool broadcast(Device & device);
+    void command();
+    void sample_queue();
+    void deliver(const std::vector<uint8_t> & frame, const bool add_crc = true);
+    void advance(const uint32_t us);
+    void report(uuid::console::Shell & shell, const uint32_t minutes, const uint64_t host_ms) const;
+
+    Device *   find(const uint8_t device_id);
+    Register & find(Device & device, const uint16_t type_id);
+    uint32_t   now() const {
+        return clock_us_ / 1000;
+    }
+
+    static void tx_handler(const uint8_t * data, const uint8_t length);
+
+    static Simulator * active_;
+
+    std::vector<Device>  devices_;
+    std::vector<uint8_t> tx_; // what we put on the bus since the last poll
+    std::deque<uint32_t> pending_commands_;
+    uint64_t             clock_us_;
+    uint32_t             next_command_;
+    uint32_t             queue_busy_since_;
+    bool                 queue_busy_;
+    uint8_t              commands_sent_;
+    Stats                stats_;
+};
+
+} // namespace emsesp
+
+#endif
+
+#endif
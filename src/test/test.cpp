@@ -21,6 +21,15 @@
 
 #include "test.h"
 
+#ifdef EMSESP_STANDALONE
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <thread>
+#endif
+
 // create some fake test data
 
 namespace emsesp {
@@ -370,6 +379,718 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd) {
         // shell.invoke_command("call boiler info");
     }
 
+    if (command == "version") {
+        shell.printfln(F("Testing value versions..."));
+        run_test("boiler");
+        uint32_t version = EMSESP::value_version(EMSdevice::DeviceType::BOILER);
+        shell.printfln(F("Boiler value version is %lu"), (unsigned long)version);
+
+        // the same UBAuptime again doesn't change the version, a new one does
+        uart_telegram({0x08, 0x0B, 0x14, 00, 0x3C, 0x1F, 0xAC, 0x70});
+        shell.printfln(F("Same telegram, version %lu (expected %lu)"), (unsigned long)EMSESP::value_version(EMSdevice::DeviceType::BOILER), (unsigned long)version);
+        uart_telegram({0x08, 0x0B, 0x14, 00, 0x3C, 0x1F, 0xAD, 0x70});
+        shell.printfln(F("New telegram, version %lu (expected %lu)"), (unsigned long)EMSESP::value_version(EMSdevice::DeviceType::BOILER), (unsigned long)version + 1);
+    }
+
+    if (command == "encoding") {
+        shell.printfln(F("Testing payload encodings..."));
+        run_test("boiler");
+
+        DynamicJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+        JsonObject          json = doc.to<JsonObject>();
+        EMSESP::emsdevices.back()->export_values(json);
+
+        std::string payload;
+        uint8_t     encoding = PAYLOAD_JSON_PRETTY;
+        Helpers::serialize_payload(doc, payload, encoding);
+        shell.printfln(F("Pretty json: %d bytes"), payload.size());
+        payload.clear();
+        encoding = PAYLOAD_JSON;
+        Helpers::serialize_payload(doc, payload, encoding);
+        shell.printfln(F("Compact json: %d bytes"), payload.size());
+        payload.clear();
+        encoding = PAYLOAD_MSGPACK;
+        Helpers::serialize_payload(doc, payload, encoding);
+        shell.printfln(F("MessagePack: %d bytes, as %s"), payload.size(), Helpers::payload_mimetype(encoding));
+
+        // nested deeper than the json can be read back (more than 10 on the ESPs, 50 here), it goes out as json
+        DynamicJsonDocument deep(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+        JsonObject          nested = deep.to<JsonObject>();
+        for (uint8_t i = 0; i < 60; i++) {
+            nested = nested.createNestedObject("n");
+        }
+        nested["temp"] = FixedPoint(203, 10).json();
+        payload.clear();
+        encoding = PAYLOAD_MSGPACK;
+        Helpers::serialize_payload(deep, payload, encoding);
+        shell.printfln(F("Too deep for MessagePack: %d bytes, as %s"), payload.size(), Helpers::payload_mimetype(encoding));
+
+        // MQTT in MessagePack shows only the size in the queue, the HA format stays json
+        DynamicJsonDocument small(EMSESP_MAX_JSON_SIZE_SMALL);
+        small["temp"]  = FixedPoint(203, 10).json();
+        uint8_t format = Mqtt::mqtt_format();
+        Mqtt::encoding(PAYLOAD_MSGPACK);
+        EMSESP::mqtt_.set_format(Mqtt::Format::NESTED);
+        Mqtt::publish(F("test_msgpack"), small.as<JsonObject>());
+        EMSESP::mqtt_.set_format(Mqtt::Format::HA);
+        Mqtt::publish(F("test_ha"), small.as<JsonObject>());
+        shell.invoke_command("show mqtt");
+        EMSESP::mqtt_.set_format(format);
+        Mqtt::encoding(PAYLOAD_JSON);
+    }
+
+    if (command == "metrics") {
+        shell.printfln(F("Testing metrics..."));
+        run_test("boiler");
+        run_test("thermostat");
+
+        std::string output;
+        WebMetricsService::system_metrics(output);
+        for (const auto & emsdevice : *EMSESP::emsdevices_snapshot()) { // what a request in the web task gets
+            WebMetricsService::device_metrics(output, emsdevice);
+        }
+        WebMetricsService::sensor_metrics(output);
+        shell.print(output);
+    }
+
+    if (command == "bus") {
+        shell.printfln(F("Testing bus analyser..."));
+        run_test("boiler");
+
+        // a few polls, two of them to us
+        uint8_t poll[] = {0x88};
+        EMSESP::incoming_telegram(poll, 1);
+        poll[0] = 0x80 | EMSbus::ems_bus_id();
+        EMSESP::incoming_telegram(poll, 1);
+        EMSESP::incoming_telegram(poll, 1);
+
+        // EMS+ types 0xFEFF and 0xFF05, with the 256 added they are neither other nor the EMS 1.0 type 0x05
+        uint8_t plus_top[]  = {0x10, 0x00, 0xFF, 0x00, 0xFE, 0xFF, 0x01, 0x00};
+        uint8_t plus_wrap[] = {0x10, 0x00, 0xFF, 0x00, 0xFF, 0x05, 0x01, 0x00};
+        EMSESP::busanalyser_.incoming(plus_top, sizeof(plus_top), ::millis());
+        EMSESP::busanalyser_.incoming(plus_wrap, sizeof(plus_wrap), ::millis());
+
+        shell.invoke_command("show bus");
+        shell.invoke_command("call system bus");
+    }
+
+    if (command == "schema") {
+        shell.printfln(F("Testing telegram schema..."));
+        run_test("boiler");
+
+        // UBAMonitorFast from offset 9, only the warm water storage temps are in it: 30.0 and 40.0
+        uart_telegram({0x08, 0x00, 0x18, 0x09, 0x01, 0x2C, 0x01, 0x90});
+
+        shell.invoke_command("show");
+    }
+
+    if (command == "events") {
+        shell.printfln(F("Testing events..."));
+        run_test("boiler");
+
+        // boiler state from UBAMonitorFast, hot water on and off again
+        uart_telegram({0x08, 0x00, 0x18, 0x05, 0x0A});
+        uart_telegram({0x08, 0x00, 0x18, 0x05, 0x00});
+        uart_telegram({0x08, 0x00, 0x18, 0x05, 0x00}); // same again, no event
+
+        shell.printfln(F("Device value events: %d"), Events::count(Events::DEVICE_VALUES));
+        shell.printfln(F("Tap water events: %d"), Events::count(Events::TAP_WATER_ACTIVE));
+    }
+
+    if (command == "tasks") {
+        shell.printfln(F("Testing scheduler..."));
+        run_test("boiler");
+
+        EMSESP::scheduler_.once(F("test"), Scheduler::PRIORITY_NORMAL, 0, [] { EMSESP::fetch_device_values(); });
+        EMSESP::loop();
+
+        shell.invoke_command("show tasks");
+    }
+
+    if (command == "flashstring") {
+        shell.printfln(F("Testing flash string views..."));
+        FlashStringView view(F_(thermostat));
+        char            buffer[8];
+        shell.printfln(F("length %d, equal %d, not equal %d, same hash %d"),
+                       view.length(),
+                       view == "thermostat",
+                       view == "thermo",
+                       view.hash() == Helpers::hash("thermostat"));
+        size_t length = view.copy(buffer, sizeof(buffer));
+        shell.printfln(F("copy '%s' (truncated %d)"), buffer, length >= sizeof(buffer));
+        char name[30] = "boiler ";
+        FlashStringView(F_(thermostat)).append(name, sizeof(name));
+        shell.printfln(F("append '%s', device name '%s'"), name, EMSdevice::device_type_2_device_name_P(EMSdevice::DeviceType::MIXER).c_str(buffer));
+    }
+
+    if (command == "capture") {
+        shell.printfln(F("Testing bus capture..."));
+        run_test("boiler");
+
+        // starts at the UBAuptime, stops 2 frames after the UBAMonitorWW, the last one isn't recorded
+        shell.invoke_command("capture on 14");
+        shell.invoke_command("capture stop 34 2");
+        uart_telegram({0x08, 0x00, 0x07, 0x00, 0x0B, 0x80, 0x00, 0x00});
+        uart_telegram({0x08, 0x0B, 0x14, 00, 0x3C, 0x1F, 0xAC, 0x70});
+        uint8_t poll = 0x8B;
+        EMSESP::incoming_telegram(&poll, 1);
+        uart_telegram({0x08, 0x00, 0x34, 0x00, 0x3E, 0x02, 0x1D, 0x80, 0x00, 0x31, 0x00, 0x00, 0x01, 0x00, 0x01, 0x0B, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+        poll = 0x88;
+        EMSESP::incoming_telegram(&poll, 1);
+        uart_telegram({0x08, 0x0B, 0x14, 00, 0x3C, 0x1F, 0xAD, 0x70});
+        uart_telegram({0x08, 0x00, 0x07, 0x00, 0x0B, 0x80, 0x00, 0x00});
+        shell.invoke_command("capture");
+
+        // the download starts with the header, the first record follows it
+        auto    ring = EMSESP::buscapture_.download();
+        uint8_t buffer[24];
+        size_t  length = ring->read(buffer, sizeof(buffer), 0);
+        shell.printfln(F("Download: %d bytes, magic %c%c%c%c, %d records, first %s"),
+                       length,
+                       buffer[0],
+                       buffer[1],
+                       buffer[2],
+                       buffer[3],
+                       buffer[8],
+                       Helpers::data_to_hex(buffer + 16, 8).c_str());
+
+        // clearing and starting again while it's downloaded doesn't touch the ring of the download
+        shell.invoke_command("capture clear");
+        shell.invoke_command("capture on");
+        uart_telegram({0x08, 0x00, 0x07, 0x00, 0x0B, 0x80, 0x00, 0x00});
+        length = ring->read(buffer, sizeof(buffer), 0);
+        shell.printfln(F("Download after a restart: %d bytes, %d records, first %s (expected the same)"),
+                       length,
+                       buffer[8],
+                       Helpers::data_to_hex(buffer + 16, 8).c_str());
+        shell.invoke_command("capture clear");
+    }
+
+    if (command == "jsonpool") {
+        shell.printfln(F("Testing json document pool..."));
+        run_test("boiler");
+        run_test("thermostat");
+        EMSESP::publish_all();
+
+        // more large documents at the same time than there are slots, the rest comes from the heap
+        {
+            PooledJsonDocument doc1(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+            PooledJsonDocument doc2(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+            PooledJsonDocument doc3(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+            PooledJsonDocument doc4(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+            doc4["fits"] = true;
+            shell.printfln(F("Capacities %d %d %d %d, fourth %s"), doc1.capacity(), doc2.capacity(), doc3.capacity(), doc4.capacity(), doc4["fits"] ? "ok" : "failed");
+        }
+        JsonPool::show(shell);
+    }
+
+    if (command == "fixedpoint") {
+        shell.printfln(F("Testing fixed point values..."));
+        char s[FixedPoint::MAX_LENGTH + 1];
+        shell.printfln(F("203/10 is %s"), FixedPoint(203, 10).render(s, sizeof(s)));
+        shell.printfln(F("-5/10 is %s"), FixedPoint(-5, 10).render(s, sizeof(s)));
+        shell.printfln(F("41/2 is %s"), FixedPoint(41, 2).render(s, sizeof(s)));
+        shell.printfln(F("1500/100 is %s"), FixedPoint(1500, 100).render(s, sizeof(s)));
+        shell.printfln(F("1500/100 trimmed is %s"), FixedPoint(1500, 100).render(s, sizeof(s), true));
+        shell.printfln(F("7/3 is %s"), FixedPoint(7, 3).render(s, sizeof(s)));
+        shell.printfln(F("20.3 as float with 2 decimals is %s"), Helpers::render_value(s, 20.3f, 2));
+
+        PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_SMALL);
+        doc["temp"]  = FixedPoint(203, 10).json();
+        doc["press"] = FixedPoint(15, 10).json();
+        doc["set"]   = FixedPoint(44, 2).json();
+        std::string payload;
+        uint8_t     encoding = PAYLOAD_JSON;
+        Helpers::serialize_payload(doc, payload, encoding);
+        shell.printfln(F("json %s"), payload.c_str());
+        payload.clear();
+        encoding = PAYLOAD_MSGPACK;
+        Helpers::serialize_payload(doc, payload, encoding);
+        shell.printfln(F("msgpack %s"), Helpers::data_to_hex((const uint8_t *)payload.data(), payload.size()).c_str());
+
+        int32_t value;
+        for (const char * text : {"20.3", "-0.05", "21,25", "7", "x"}) {
+            bool ok = Helpers::value2fixed(text, value, 10);
+            shell.printfln(F("parse '%s' in 0.1: %d %d"), text, ok, value);
+        }
+    }
+
+    if (command == "filter") {
+        shell.printfln(F("Testing value filters..."));
+        run_test("boiler");
+
+        EMSdevice * boiler = nullptr;
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            if (emsdevice && (emsdevice->device_type() == EMSdevice::DeviceType::BOILER)) {
+                boiler = emsdevice.get();
+            }
+        }
+
+        // a deadband of 0.5 degrees on the flow temperature, which is 60.2 now. Set with a partial UBAMonitorFast
+        std::vector<ValueFilter::Setting> settings = {{"curFlowTemp", {5, 0, 0, 1}}};
+        ValueFilter::configure(settings);
+        boiler->updated_values();
+        for (uint16_t t : {603, 605, 607, 608, 602}) {
+            uart_telegram({0x08, 0x00, 0x18, 0x01, (uint8_t)(t >> 8), (uint8_t)t});
+            shell.printfln(F("Deadband: curFlowTemp %d, changed %d"), t, boiler->updated_values());
+        }
+
+        // an average of 4 readings
+        settings = {{"curFlowTemp", {0, 0, 0, 4}}};
+        ValueFilter::configure(settings);
+        for (uint16_t t : {600, 640, 640, 640, 640}) {
+            uart_telegram({0x08, 0x00, 0x18, 0x01, (uint8_t)(t >> 8), (uint8_t)t});
+            PooledJsonDocument doc(EMSESP_MAX_JSON_SIZE_LARGE_DYN);
+            JsonObject         json = doc.to<JsonObject>();
+            boiler->export_values(json);
+            char s[FixedPoint::MAX_LENGTH + 1];
+            serializeJson(json["curFlowTemp"], s, sizeof(s));
+            shell.printfln(F("Average: curFlowTemp %d, exported %s, changed %d"), t, s, boiler->updated_values());
+        }
+
+        ValueFilter::show(shell);
+        settings.clear();
+        ValueFilter::configure(settings);
+    }
+
+    if (command == "history") {
+        shell.printfln(F("Testing value history..."));
+        run_test("boiler");
+
+        std::vector<std::string> names = {"boiler/curFlowTemp", "boiler/burnGas", "boiler/nothere", "nodevice/curFlowTemp"};
+        EMSESP::history_.configure(names, false);
+
+        // an hour and a half, the flow temperature goes up 0.1 degrees a minute
+        for (uint16_t i = 0; i < 540; i++) {
+            if ((i % 6) == 0) {
+                uint16_t t = 600 + i / 6;
+                uart_telegram({0x08, 0x00, 0x18, 0x01, (uint8_t)(t >> 8), (uint8_t)t});
+            }
+            EMSESP::history_.sample(100000 + i * 10);
+        }
+        shell.invoke_command("show history");
+
+        History::Query query;
+        for (const char * name : {"boiler/curFlowTemp", "boiler/burnGas", "boiler/nothere"}) {
+            std::string output;
+            EMSESP::history_.start_query(query, name, 100000, 105400, 900);
+            while (History::render(output, query, 4)) {
+            }
+            shell.printfln(F("%s"), output.c_str());
+        }
+        // the query has its own copy of the values, the history can be configured again while it's rendered
+        EMSESP::history_.start_query(query, "boiler/curFlowTemp", 103000, 103300, 0);
+        names.clear();
+        EMSESP::history_.configure(names, false);
+        std::string output;
+        while (History::render(output, query, 4)) {
+        }
+        shell.printfln(F("%s"), output.c_str());
+
+        // a day at 1 minute is more than a query copies, it ends early
+        names = {"boiler/curFlowTemp"};
+        EMSESP::history_.configure(names, false);
+        for (uint32_t i = 0; i < 8640; i++) {
+            EMSESP::history_.sample(200000 + i * 10);
+        }
+        EMSESP::history_.start_query(query, "boiler/curFlowTemp", 200000, 286400, 60);
+        shell.printfln(F("Copied %d segments, up to %lu"), query.segments.size(), (unsigned long)query.to);
+        names.clear();
+        EMSESP::history_.configure(names, false);
+    }
+
+#ifdef EMSESP_STANDALONE
+#ifdef EMSESP_HEAP_PROFILER
+    if (command == "heap") {
+        shell.printfln(F("Testing heap profiler..."));
+        HeapProfiler::enable(true);
+        run_test("boiler");
+        run_test("thermostat");
+        EMSESP::fetch_device_values();
+        EMSESP::loop();
+        shell.invoke_command("show heap");
+    }
+#endif
+
+    if (command == "simulator") {
+        shell.printfln(F("Testing an hour on a simulated bus..."));
+        Simulator::run(shell, 60);
+        shell.invoke_command("show devices");
+    }
+
+    if (command == "frames") {
+        shell.printfln(F("Testing frames from the UART's receive context..."));
+        run_test("boiler");
+        shell.invoke_command("capture on");
+
+        // what goes on the bus from the receive context, before the loop has seen any of it
+        static std::vector<uint8_t> sent;
+        EMSuart::tx_handler([](const uint8_t * data, const uint8_t length) { sent.insert(sent.end(), data, data + length); });
+
+        EMSESP::send_read_request(0x19, 0x08);
+        EMSESP::loop(); // it's put in the Tx slot
+        uint8_t poll = 0x80 | EMSbus::ems_bus_id();
+        EMSESP::incoming_frame(&poll, 1);
+        shell.printfln(F("Answer to the poll: %s"), sent.empty() ? "nothing" : Helpers::data_to_hex(sent.data(), sent.size()).c_str());
+
+        // our echo and then the boiler's answer, which has the bus handed back straight away
+        std::vector<uint8_t> echo = sent;
+        sent.clear();
+        EMSESP::incoming_frame(echo.data(), echo.size());
+        std::vector<uint8_t> reply = {0x08, EMSbus::ems_bus_id(), 0x19, 0x00, 0x80, 0x00, 0x80, 0x00};
+        reply.push_back(EMSESP::rxservice_.calculate_crc(reply.data(), reply.size()));
+        EMSESP::incoming_frame(reply.data(), reply.size());
+        shell.printfln(F("After the answer: %s"), sent.empty() ? "nothing" : Helpers::data_to_hex(sent.data(), sent.size()).c_str());
+        sent.clear();
+
+        // the loop takes them in the order they were on the bus
+        EMSESP::loop();
+        EMSuart::tx_handler(nullptr);
+        shell.printfln(F("Sent by the loop: %s"), sent.empty() ? "nothing" : Helpers::data_to_hex(sent.data(), sent.size()).c_str());
+        shell.invoke_command("show bus");
+        shell.invoke_command("capture");
+        shell.invoke_command("capture clear");
+    }
+
+    if (command == "backoff") {
+        shell.printfln(F("Testing Tx backoff from devices that don't answer..."));
+        run_test("boiler");
+        EMSESP::txservice_.flush_tx_queue();
+
+        static std::vector<uint8_t> sent;
+        EMSuart::tx_handler([](const uint8_t * data, const uint8_t length) { sent.insert(sent.end(), data, data + length); });
+
+        // we're polled and send what's in the slot, then the master polls someone else instead of an answer coming
+        auto unanswered = [&]() {
+            EMSESP::loop();
+            sent.clear();
+            uint8_t poll = 0x80 | EMSbus::ems_bus_id();
+            EMSESP::incoming_frame(&poll, 1);
+            std::vector<uint8_t> echo = sent;
+            EMSESP::incoming_frame(echo.data(), echo.size());
+            uint8_t other = 0x89;
+            EMSESP::incoming_frame(&other, 1);
+            EMSESP::loop();
+        };
+
+        for (uint8_t i = 0; i < TxService::TX_FAILS_BEFORE_BACKOFF; i++) {
+            EMSESP::send_read_request(0xA2, 0x18); // a thermostat that isn't there
+            unanswered();
+        }
+        EMSESP::send_read_request(0x19, 0x08);
+        unanswered(); // the boiler is never suspended
+
+        // another read to the thermostat waits, the one after it goes first
+        EMSESP::send_read_request(0xA2, 0x18);
+        EMSESP::send_read_request(0xA2, 0x18); // not queued twice
+        EMSESP::send_read_request(0x14, 0x08);
+        unanswered();
+        EMSuart::tx_handler(nullptr);
+
+        shell.invoke_command("show ems");
+    }
+
+    if (command == "websocket") {
+        shell.printfln(F("Testing the device values web socket..."));
+        run_test("boiler");
+
+        uint8_t boiler = 0;
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            if (emsdevice && (emsdevice->device_type() == EMSdevice::DeviceType::BOILER)) {
+                boiler = emsdevice->unique_id();
+            }
+        }
+        char subscribe[16];
+        snprintf(subscribe, sizeof(subscribe), "{\"id\":%d}", boiler);
+
+        AsyncWebSocket *            socket = AsyncWebSocket::find(DEVICE_DATA_SOCKET_PATH);
+        static AsyncWebSocketClient watcher(1);
+        static AsyncWebSocketClient other(2);
+        socket->connect(&watcher);
+        socket->connect(&other);
+
+        // the web server's task only queues the subscription, the loop makes it and sends the snapshot
+        socket->message(&watcher, subscribe);
+        shell.printfln(F("Sent before the loop: %d"), watcher.sent.size());
+        EMSESP::loop();
+        shell.printfln(F("Sent after the loop: %d, %s"), watcher.sent.size(), watcher.sent.empty() ? "" : watcher.sent.back().substr(0, 40).c_str());
+
+        // another client comes and goes over and over in the web server's task, while the loop pushes changes
+        std::thread web([&]() {
+            for (uint16_t i = 0; i < 200; i++) {
+                socket->message(&other, subscribe);
+                socket->disconnect(&other);
+                std::this_thread::yield();
+            }
+        });
+        uint32_t now = ::millis();
+        for (uint16_t i = 0; i < 200; i++) {
+            set_millis(now += 1000); // a push a second at most
+            uuid::loop();
+            uart_telegram({0x08, 0x00, 0x18, 0x00, (uint8_t)(i & 0x7F)}); // the flow temperature
+        }
+        web.join();
+        socket->disconnect(&other);
+        EMSESP::loop();
+
+        // one more change goes to the watcher and not to the client that's gone
+        size_t watcher_sent = watcher.sent.size();
+        size_t other_sent   = other.sent.size();
+        set_millis(now += 1000); // a push a second at most
+        uuid::loop();
+        uart_telegram({0x08, 0x00, 0x18, 0x00, 0x50});
+        shell.printfln(F("Last change, to the watcher: %d, to the client that's gone: %d"), watcher.sent.size() - watcher_sent, other.sent.size() - other_sent);
+        shell.printfln(F("%s"), watcher.sent.back().substr(0, 40).c_str());
+    }
+
+    if (command == "uart") {
+        shell.printfln(F("Testing the bus over a pty..."));
+        run_test("boiler");
+        setenv("EMSESP_UART", "pty", 1);
+        EMSuart::start(0, 0, 0);
+        int peer = open(EMSuart::device(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+        // what the other end sends is taken as a telegram once it goes quiet
+        auto bus = [peer](const std::vector<uint8_t> & data) {
+            write(peer, data.data(), data.size());
+            for (uint8_t i = 0; i < 3; i++) {
+                usleep((EMSuart::RX_GAP + 1) * 1000);
+                EMSuart::receive();
+            }
+            EMSESP::loop();
+        };
+
+        // a new UBAuptime, then a poll for us with a read waiting to go out
+        uint32_t             version = EMSESP::value_version(EMSdevice::DeviceType::BOILER);
+        std::vector<uint8_t> uptime  = {0x08, 0x0B, 0x14, 00, 0x3C, 0x1F, 0xAD, 0x70};
+        uptime.push_back(EMSESP::rxservice_.calculate_crc(uptime.data(), uptime.size()));
+        bus(uptime);
+        shell.printfln(F("Boiler value version %lu (expected %lu)"), (unsigned long)EMSESP::value_version(EMSdevice::DeviceType::BOILER), (unsigned long)version + 1);
+
+        EMSESP::send_read_request(0x18, 0x08);
+        EMSESP::loop(); // it's put in the Tx slot, the poll is answered from there
+        bus({0x8B});
+        uint8_t sent[EMS_MAXBUFFERSIZE];
+        ssize_t length = read(peer, sent, sizeof(sent));
+        shell.printfln(F("Sent over the pty: %s"), (length > 0) ? Helpers::data_to_hex(sent, length).c_str() : "nothing");
+
+        // the same with the bus on its own thread, the loop only takes the frames from the queue
+        EMSuart::pipeline(true);
+        version = EMSESP::value_version(EMSdevice::DeviceType::BOILER);
+        uptime  = {0x08, 0x0B, 0x14, 00, 0x3C, 0x1F, 0xAE, 0x70};
+        uptime.push_back(EMSESP::rxservice_.calculate_crc(uptime.data(), uptime.size()));
+        write(peer, uptime.data(), uptime.size());
+        for (uint8_t i = 0; (i < 50) && (EMSESP::value_version(EMSdevice::DeviceType::BOILER) == version); i++) {
+            usleep(2000);
+            EMSESP::loop();
+        }
+        shell.printfln(F("Boiler value version %lu from the bus thread (expected %lu)"),
+                       (unsigned long)EMSESP::value_version(EMSdevice::DeviceType::BOILER),
+                       (unsigned long)version + 1);
+
+        // the loop gets the top of the Tx queue ready in the slot and then doesn't come round, the bus thread still answers the poll
+        EMSESP::send_read_request(0x02, 0x10);
+        EMSESP::loop();
+        while (read(peer, sent, sizeof(sent)) > 0) {
+            // the poll that closed the bus after the UBAuptime, it was taken as the answer to our read
+        }
+        uint8_t poll_us = 0x8B;
+        write(peer, &poll_us, 1);
+        struct pollfd reply = {peer, POLLIN, 0};
+        length              = 0;
+        if (poll(&reply, 1, 200) > 0) {
+            usleep((EMSuart::RX_GAP + 1) * 1000); // all of it
+            length = read(peer, sent, sizeof(sent));
+        }
+        shell.printfln(F("Sent over the pty while the loop was busy: %s"), (length > 0) ? Helpers::data_to_hex(sent, length).c_str() : "nothing");
+
+        // the device answers the read and the bus thread hands the bus back, the loop still hasn't come round
+        std::vector<uint8_t> answer = {(uint8_t)(sent[1] & 0x7F), sent[0], sent[2], 0x00, 0x00};
+        answer.push_back(EMSESP::rxservice_.calculate_crc(answer.data(), answer.size()));
+        write(peer, answer.data(), answer.size());
+        length = 0;
+        if (poll(&reply, 1, 200) > 0) {
+            length = read(peer, sent, sizeof(sent));
+        }
+        shell.printfln(F("Bus handed back while the loop was busy: %s"), (length > 0) ? Helpers::data_to_hex(sent, length).c_str() : "nothing");
+        EMSESP::loop(); // and now it sees what went out
+        EMSuart::pipeline(false);
+
+        close(peer);
+        unsetenv("EMSESP_UART");
+    }
+
+    if (command == "bridge") {
+        shell.printfln(F("Testing the bus over a TCP bridge..."));
+        run_test("boiler");
+
+        // the bridge is on this side, it's connected to as tcp:host:port
+        int                listener = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in address  = {};
+        socklen_t          size     = sizeof(address);
+        address.sin_family          = AF_INET;
+        address.sin_addr.s_addr     = htonl(INADDR_LOOPBACK);
+        bind(listener, (struct sockaddr *)&address, sizeof(address));
+        listen(listener, 1);
+        getsockname(listener, (struct sockaddr *)&address, &size);
+        char device[30];
+        snprintf(device, sizeof(device), "tcp:127.0.0.1:%u", ntohs(address.sin_port));
+        setenv("EMSESP_UART", device, 1);
+        EMSuart::start(0, 0, 0);
+        int peer = accept(listener, nullptr, nullptr);
+
+        auto bus = [peer](const std::vector<uint8_t> & data) {
+            write(peer, data.data(), data.size());
+            for (uint8_t i = 0; i < 3; i++) {
+                usleep((EMSuart::RX_GAP + 1) * 1000);
+                EMSuart::receive();
+            }
+            EMSESP::loop();
+        };
+
+        // a UBAuptime that ends with a CRC of 0 is taken whole
+        std::vector<uint8_t> uptime = {0x08, 0x0B, 0x14, 00, 0x3C, 0x1F, 0x00, 0x70};
+        for (uint16_t i = 0; (i < 256) && (EMSESP::rxservice_.calculate_crc(uptime.data(), uptime.size()) != 0); i++) {
+            uptime[6]++;
+        }
+        uptime.push_back(0);
+        uint32_t version = EMSESP::value_version(EMSdevice::DeviceType::BOILER);
+        bus(uptime);
+        shell.printfln(F("CRC of 0: boiler value version %lu (expected %lu)"),
+                       (unsigned long)EMSESP::value_version(EMSdevice::DeviceType::BOILER),
+                       (unsigned long)version + 1);
+
+        // and the same telegram with another CRC, followed by a 0 for the <BRK>
+        uptime[6]++;
+        uptime[8] = EMSESP::rxservice_.calculate_crc(uptime.data(), 8);
+        uptime.push_back(0);
+        version = EMSESP::value_version(EMSdevice::DeviceType::BOILER);
+        bus(uptime);
+        shell.printfln(F("A 0 for the <BRK>: boiler value version %lu (expected %lu)"),
+                       (unsigned long)EMSESP::value_version(EMSdevice::DeviceType::BOILER),
+                       (unsigned long)version + 1);
+
+        close(peer);
+        close(listener);
+        unsetenv("EMSESP_UART");
+    }
+
+    if (command == "stats") {
+        shell.printfln(F("Testing statistics..."));
+        run_test("boiler");
+
+        // an hour and a half, the burner is on for the first 20 minutes of every 30, modulating up from 40%.
+        // It starts once each time and there's a minute of warm water at 10 l/min in each of them
+        for (uint32_t minute = 0; minute <= 90; minute++) {
+            set_millis(minute * 60000);
+            uuid::loop();
+            bool    on    = (minute % 30) < 20;
+            uint8_t power = on ? 40 + (minute % 30) * 2 : 0;
+            uart_telegram({0x08, 0x00, 0x18, 0x04, power, 0x00, 0x00, (uint8_t)(on ? 0x01 : 0x00)});
+            uart_telegram({0x08, 0x00, 0x34, 0x09, (uint8_t)(((minute % 30) == 10) ? 100 : 0)});
+            uint8_t starts = 100 + (minute + 29) / 30;
+            uart_telegram({0x08, 0x00, 0x19, 0x0A, 0x00, 0x00, starts});
+            if (minute == 45) {
+                shell.invoke_command("show stats");
+            }
+        }
+        shell.invoke_command("show stats");
+    }
+
+    if (command == "framequeue") {
+        shell.printfln(F("Testing the Rx frame queue..."));
+        static FrameQueue<4, EMS_MAXBUFFERSIZE> queue; // small, so it's full a lot of the time
+
+        uint8_t data[EMS_MAXBUFFERSIZE] = {0x8B};
+        uint8_t pushed                  = 0;
+        while (queue.push(data, 1)) {
+            pushed++;
+        }
+        while (queue.front()) {
+            queue.pop();
+        }
+        shell.printfln(F("Holds %d frames, %lu dropped"), pushed, (unsigned long)queue.dropped());
+
+        // the UART's task on one side and the loop on the other, each frame has its number in it
+        const uint32_t frames   = 100000;
+        std::thread    producer = std::thread([&] {
+            uint8_t frame[EMS_MAXBUFFERSIZE];
+            for (uint32_t i = 0; i < frames;) {
+                for (uint8_t j = 0; j < EMS_MAXBUFFERSIZE; j++) {
+                    frame[j] = i + j;
+                }
+                if (queue.push(frame, 1 + i % EMS_MAXBUFFERSIZE)) {
+                    i++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint32_t received = 0;
+        uint32_t errors   = 0;
+        while (received < frames) {
+            auto frame = queue.front();
+            if (frame == nullptr) {
+                std::this_thread::yield();
+                continue;
+            }
+            bool ok = (frame->length == 1 + received % EMS_MAXBUFFERSIZE);
+            for (uint8_t j = 0; ok && (j < frame->length); j++) {
+                ok = (frame->data[j] == (uint8_t)(received + j));
+            }
+            errors += ok ? 0 : 1;
+            queue.pop();
+            received++;
+        }
+        producer.join();
+        shell.printfln(F("Passed %lu frames between two threads, %lu out of order or corrupted"), (unsigned long)received, (unsigned long)errors);
+    }
+
+    if (command == "dallas") {
+        shell.printfln(F("Testing Dallas sensors on a simulated 1-Wire bus..."));
+        OneWire::add(0x28, 0x03C9743D, 373); // 23.3 degrees
+        OneWire::add(0x28, 0x03C97423, 384);
+        OneWire::add(0x28, 0x0E9741EA, 200);
+
+        // the dallas task runs every 100 ms, there's a reading every 5 seconds
+        uint32_t now    = millis();
+        auto     passes = [&](const uint32_t seconds) {
+            for (uint32_t i = 0; i < seconds * 10; i++) {
+                set_millis(now += 100);
+                uuid::loop();
+                EMSESP::dallassensor_.loop();
+            }
+            shell.printfln(F("After %lu s: %lu searches and %lu sensors selected"),
+                           (unsigned long)(now / 1000),
+                           (unsigned long)OneWire::searches(),
+                           (unsigned long)OneWire::selects());
+            EMSESP::show_sensor_values(shell);
+        };
+
+        // searches at the start, then each known sensor is read by its address and there's a search a minute
+        passes(120);
+
+        // one goes, it's looked for once and missing after 6 readings
+        OneWire::devices()[1].present = false;
+        OneWire::devices()[0].raw     = 400;
+        passes(60);
+
+        // a new one is found with the next search
+        OneWire::add(0x28, 0x0C97233D, 500);
+        passes(60);
+
+        // every change is an event, also when the one before hasn't been taken
+        static uint16_t events = 0;
+        Events::subscribe(Events::SENSOR_VALUES, [](const Events::Event & event) { events++; });
+        OneWire::devices()[0].raw = 420;
+        passes(10);
+        OneWire::devices()[0].raw = 440;
+        passes(10);
+        shell.printfln(F("Sensor change events: %d, values waiting to be published: %s"), events, EMSESP::dallassensor_.updated_values() ? "yes" : "no");
+    }
+#endif
+
     if (command == "fr120") {
         shell.printfln(F("Testing adding a thermostat FR120..."));
 
@@ -646,6 +1367,60 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd) {
         EMSESP::txservice_.flush_tx_queue();
     }
 
+    if (command == "txgroup") {
+        shell.printfln(F("Testing Tx group..."));
+
+        EMSESP::txservice_.flush_tx_queue();
+
+        // writes in a group keep their order, the second write to 0x91 offset 0 replaces the first
+        EMSESP::txservice_.start_group();
+        EMSESP::send_write_request(0x91, 0x17, 0x00, 0x21);
+        EMSESP::send_write_request(0x91, 0x17, 0x01, 0x22);
+        EMSESP::send_write_request(0x91, 0x17, 0x00, 0x23);
+        EMSESP::send_read_request(0x18, 0x08); // reads are not held back
+        EMSESP::txservice_.end_group();
+
+        EMSESP::show_ems(shell);
+
+        // a group that doesn't fit on the queue isn't queued at all, what's queued already stays
+        while (EMSESP::txservice_.queue_size() < TxService::MAX_TX_TELEGRAMS - 1) {
+            EMSESP::send_read_request(0x19, 0x08);
+        }
+        EMSESP::txservice_.start_group();
+        EMSESP::send_write_request(0x91, 0x17, 0x00, 0x21);
+        EMSESP::send_write_request(0x91, 0x17, 0x01, 0x22);
+        bool queued = EMSESP::txservice_.end_group();
+        shell.printfln(F("Group queued: %s, Tx queue %ld of %ld"), queued ? "yes" : "no", EMSESP::txservice_.queue_size(), TxService::MAX_TX_TELEGRAMS);
+
+        EMSESP::txservice_.flush_tx_queue();
+    }
+
+    if (command == "txhealth") {
+        shell.printfln(F("Testing Tx health..."));
+
+        EMSESP::txservice_.flush_tx_queue();
+        uint8_t poll[1] = {0x8B};
+        uart_telegram({0x08, 0x00, 0x18, 0x00, 0x00, 0x00}); // bus is active
+
+        // a read to a mixer that never answers, a few times in a row
+        uint8_t other[1] = {0x89};
+        for (uint8_t i = 0; i < TxService::TX_FAILS_BEFORE_BACKOFF; i++) {
+            EMSESP::send_read_request(0x02D7, 0x20);
+            EMSESP::incoming_telegram(poll, 1);
+            uart_telegram({0x08, 0x00, 0x18, 0x00, 0x00, 0x00}); // someone else's telegram doesn't end the wait
+            EMSESP::incoming_telegram(other, 1);                 // the master polls the next one, so the read failed
+        }
+
+        // the next read to it waits, the one to the boiler is sent
+        EMSESP::send_read_request(0x02D7, 0x20);
+        EMSESP::send_read_request(0x18, 0x08);
+        EMSESP::incoming_telegram(poll, 1);
+
+        EMSESP::show_ems(shell);
+
+        EMSESP::txservice_.flush_tx_queue();
+    }
+
     if (command == "poll") {
         shell.printfln(F("Testing Poll..."));
 
@@ -35,6 +35,7 @@
 #include "telegram.h"
 #include "mqtt.h"
 #include "emsesp.h"
+#include "simulator.h"
 
 namespace emsesp {
 
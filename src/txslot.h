@@ -0,0 +1,169 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef EMSESP_TXSLOT_H
+#define EMSESP_TXSLOT_H
+
+#include <Arduino.h>
+
+#include <atomic>
+
+namespace emsesp {
+
+// what we send on the next poll for us, handed from the loop to the UART's receive task, so the reply goes out
+// when we're polled and doesn't wait for a pass of the loop. It's one slot, without locks or allocation.
+// The state says whose it is: the loop fills a FREE slot and makes it READY, the receive task takes a READY one
+// to SENDING and marks it SENT, then the loop looks at what went out and frees it. The loop can take a READY one
+// back, that and the receive task taking it are a compare and swap so only one of them gets it
+template <uint8_t SIZE>
+class TxSlot {
+  public:
+    // loop, the poll byte that's for us and our poll ack
+    void poll(const uint8_t poll, const uint8_t ack) {
+        poll_.store(poll, std::memory_order_relaxed);
+        ack_.store(ack, std::memory_order_relaxed);
+    }
+
+    uint8_t ack() const {
+        return ack_.load(std::memory_order_relaxed);
+    }
+
+    // receive task, is it a poll for us
+    bool polled(const uint8_t data) const {
+        return (data != 0) && (data == poll_.load(std::memory_order_relaxed));
+    }
+
+    // loop, only when it's free. A telegram says who answers it, 0 for a write which is acked with a single byte
+    void fill(const uint8_t * data, const uint8_t length, const uint8_t answer_from = 0) {
+        length_      = (length < SIZE) ? length : SIZE;
+        answer_from_ = answer_from;
+        memcpy(data_, data, length_);
+        state_.store(State::READY, std::memory_order_release);
+    }
+
+    // loop, takes back what's ready. False when it's free or the receive task has already got it
+    bool withdraw() {
+        uint8_t ready = State::READY;
+        return state_.compare_exchange_strong(ready, State::FREE, std::memory_order_acquire);
+    }
+
+    // receive task, what to send or nullptr if the loop hasn't got anything ready. It's ours until sent()
+    uint8_t * take(uint8_t & length) {
+        uint8_t ready = State::READY;
+        if (!state_.compare_exchange_strong(ready, State::SENDING, std::memory_order_acquire)) {
+            return nullptr;
+        }
+        length = length_;
+        return data_;
+    }
+
+    // receive task, position is where the next frame goes in the Rx queue, the loop handles the send before it.
+    // After a telegram the next frame that isn't our echo is looked at, when it's the answer we hand the bus back
+    void sent(const uint16_t status, const uint8_t position, const uint32_t time_us) {
+        status_   = status;
+        position_ = position;
+        time_us_  = time_us;
+        if ((length_ > 1) && (status == EMS_TX_STATUS_OK)) {
+            expect_ = answer_from_ ? EXPECT_READ : EXPECT_WRITE;
+        }
+        state_.store(State::SENT, std::memory_order_release);
+    }
+
+    // receive task, the frame after one of our telegrams. True when it's the answer and the bus is to be handed back
+    bool answered(const uint8_t * data, const uint8_t length, const uint8_t bus_id) {
+        if ((expect_ == EXPECT_NONE) || ((length > 1) && ((data[0] & 0x7F) == bus_id))) {
+            return false; // nothing sent, or our own echo
+        }
+        if ((expect_ == EXPECT_READ) && (length > 1) && ((data[1] & 0x7F) != bus_id)) {
+            return false; // someone else's telegram, the answer to a read is still to come
+        }
+        bool answer;
+        if (expect_ == EXPECT_WRITE) {
+            answer = (length == 1) && ((data[0] == WRITE_SUCCESS) || (data[0] == WRITE_FAIL));
+        } else {
+            answer = (length > 1) && ((data[0] & 0x7F) == answer_from_);
+        }
+        expect_ = EXPECT_NONE; // whatever it was, the loop doesn't wait any longer either
+        return answer;
+    }
+
+    // when the loop answered a poll itself, there's no receive task to see the answer
+    void expect_nothing() {
+        expect_ = EXPECT_NONE;
+    }
+
+    // loop
+    bool free() const {
+        return state_.load(std::memory_order_acquire) == State::FREE;
+    }
+
+    bool ready() const {
+        return state_.load(std::memory_order_acquire) == State::READY;
+    }
+
+    bool sent() const {
+        return state_.load(std::memory_order_acquire) == State::SENT;
+    }
+
+    // sent, and it's the turn of the frame at position in the Rx queue
+    bool sent(const uint8_t position) const {
+        return sent() && (position_ == position);
+    }
+
+    // once it's sent, until release()
+    const uint8_t * data() const {
+        return data_;
+    }
+
+    uint8_t length() const {
+        return length_;
+    }
+
+    uint16_t status() const {
+        return status_;
+    }
+
+    uint32_t time_us() const {
+        return time_us_;
+    }
+
+    void release() {
+        state_.store(State::FREE, std::memory_order_release);
+    }
+
+  private:
+    enum State : uint8_t { FREE, READY, SENDING, SENT };
+    enum Expect : uint8_t { EXPECT_NONE, EXPECT_READ, EXPECT_WRITE };
+
+    static constexpr uint8_t WRITE_SUCCESS = 1; // the single byte acks of a write, see TxService
+    static constexpr uint8_t WRITE_FAIL    = 4;
+
+    std::atomic<uint8_t> state_{State::FREE};
+    std::atomic<uint8_t> poll_{0}; // 0 until the loop knows it, a poll is never 0
+    std::atomic<uint8_t> ack_{0};
+    uint8_t              data_[SIZE];
+    uint8_t              length_      = 0;
+    uint8_t              answer_from_ = 0;
+    uint16_t             status_      = 0; // from the UART's transmit
+    uint8_t              position_    = 0;
+    uint32_t             time_us_     = 0;
+    uint8_t              expect_      = EXPECT_NONE; // only the receive task uses it
+};
+
+} // namespace emsesp
+
+#endif
@@ -34,7 +34,8 @@ bool            drop_next_rx_ = true;
 uint8_t         tx_mode_      = 0xFF;
 
 /*
-* Task to handle the incoming data
+* Task to hand the incoming data to the loop
+* a poll for us is answered from here, with what the loop has put in the Tx slot, see EMSESP::incoming_frame()
 */
 void EMSuart::emsuart_recvTask(void * para) {
     while (1) {
@@ -42,7 +43,7 @@ void EMSuart::emsuart_recvTask(void * para) {
         uint8_t * telegram     = (uint8_t *)xRingbufferReceive(buf_handle_, &item_size, portMAX_DELAY);
         uint8_t   telegramSize = item_size;
         if (telegram) {
-            EMSESP::incoming_telegram(telegram, telegramSize);
+            EMSESP::incoming_frame(telegram, telegramSize);
             vRingbufferReturnItem(buf_handle_, (void *)telegram);
         }
     }
@@ -73,11 +73,12 @@ void ICACHE_RAM_ATTR EMSuart::emsuart_rx_intr_handler(void * para) {
 /*
  * system task triggered on BRK interrupt
  * incoming received messages are always asynchronous
- * The full buffer is sent to EMSESP::incoming_telegram()
+ * The full buffer is queued for the loop with EMSESP::incoming_frame()
+ * except a poll for us, that's answered here with what the loop has put in the Tx slot
  */
 void ICACHE_FLASH_ATTR EMSuart::emsuart_recvTask(os_event_t * events) {
 
-    EMSESP::incoming_telegram((uint8_t *)pCurrent->buffer, pCurrent->length - 1);
+    EMSESP::incoming_frame(pCurrent->buffer, pCurrent->length - 1);
 }
 
 /*
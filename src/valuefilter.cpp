@@ -0,0 +1,116 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "valuefilter.h"
+
+namespace emsesp {
+
+std::vector<ValueFilter::Setting> ValueFilter::settings_;
+uint8_t                           ValueFilter::settings_generation_ = 0;
+
+ValueFilter::ValueFilter(const __FlashStringHelper * name)
+    : name_(name) {
+}
+
+// from the settings, the filters pick it up with their next reading
+void ValueFilter::configure(const std::vector<Setting> & settings) {
+    settings_ = settings;
+    settings_generation_++;
+}
+
+void ValueFilter::reload() {
+    config_ = {0, 0, 0, 1};
+    for (const auto & setting : settings_) {
+        if (FlashStringView(name_) == setting.name.c_str()) {
+            config_ = setting.config;
+            if (config_.window == 0) {
+                config_.window = 1;
+            } else if (config_.window > MAX_WINDOW) {
+                config_.window = MAX_WINDOW;
+            }
+            break;
+        }
+    }
+    generation_ = settings_generation_;
+    count_      = 0;
+    next_       = 0;
+}
+
+bool ValueFilter::filter(int32_t & value, const bool has_value) {
+    if (generation_ != settings_generation_) {
+        reload();
+    }
+
+    uint32_t now = uuid::get_uptime();
+
+    // a value that goes missing is always a change, and the average starts again when it's back
+    if (!has_value) {
+        count_           = 0;
+        next_            = 0;
+        bool was_present = valid_;
+        valid_           = false;
+        last_time_       = now;
+        return was_present;
+    }
+
+    if (config_.window > 1) {
+        readings_[next_] = value;
+        next_            = (next_ + 1) % config_.window;
+        if (count_ < config_.window) {
+            count_++;
+        }
+        int32_t sum = 0;
+        for (uint8_t i = 0; i < count_; i++) {
+            sum += readings_[i];
+        }
+        value = (sum + ((sum < 0) ? -(count_ / 2) : (count_ / 2))) / count_;
+    }
+
+    if (valid_) {
+        uint32_t difference = abs(value - last_);
+        uint32_t band       = std::max((uint32_t)config_.deadband, (uint32_t)abs(last_) * config_.relative / 100);
+        if ((difference == 0) || (difference < band)) {
+            return false;
+        }
+        if (now - last_time_ < (uint32_t)config_.interval * 1000) {
+            return false;
+        }
+    }
+
+    last_      = value;
+    valid_     = true;
+    last_time_ = now;
+    return true;
+}
+
+void ValueFilter::show(uuid::console::Shell & shell) {
+    if (settings_.empty()) {
+        return;
+    }
+    shell.printfln(F("Value filters:"));
+    for (const auto & setting : settings_) {
+        shell.printfln(F(" %s: deadband %u, %u%%, interval %u s, average of %u"),
+                       setting.name.c_str(),
+                       setting.config.deadband,
+                       setting.config.relative,
+                       setting.config.interval,
+                       setting.config.window);
+    }
+}
+
+} // namespace emsesp
@@ -0,0 +1,95 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_VALUEFILTER_H
+#define EMSESP_VALUEFILTER_H
+
+#include <Arduino.h>
+
+#include <string>
+#include <vector>
+
+#include <uuid/console.h>
+
+#include "helpers.h"
+
+namespace emsesp {
+
+// filters a noisy value, like a flow temperature or the flame current, where it's decoded so that
+// jitter doesn't flag the device as changed and a publish on change isn't sent for every 0.1 degree.
+// The readings can be smoothed with a moving average. A change is registered when it's at least the deadband
+// away from the last registered value, in raw units or in percent of it, and not sooner than the interval
+// after the last one. A change that's held back by the interval is registered with the next reading after it.
+// The filters are set by value name in the settings, without a setting every change is registered
+class ValueFilter {
+  public:
+    static constexpr uint8_t MAX_WINDOW = 8;
+
+    struct Config {
+        uint16_t deadband; // in raw units, 5 is 0.5 degrees for a value in 0.1 degrees
+        uint8_t  relative; // in percent of the last registered value
+        uint16_t interval; // minimum seconds between registered changes
+        uint8_t  window;   // readings in the moving average, 1 is no smoothing
+    };
+
+    struct Setting {
+        std::string name;
+        Config      config;
+
+        bool operator==(const Setting & other) const {
+            return (name == other.name) && (config.deadband == other.config.deadband) && (config.relative == other.config.relative)
+                   && (config.interval == other.config.interval) && (config.window == other.config.window);
+        }
+    };
+
+    ValueFilter(const __FlashStringHelper * name);
+
+    // value is the reading as it was decoded, it's replaced by the smoothed value
+    // returns true if the change is to be registered
+    template <typename Value>
+    bool update(Value & value) {
+        int32_t reading    = value;
+        bool    registered = filter(reading, Helpers::hasValue(value));
+        value              = (Value)reading;
+        return registered;
+    }
+
+    static void configure(const std::vector<Setting> & settings);
+    static void show(uuid::console::Shell & shell);
+
+  private:
+    bool filter(int32_t & value, const bool has_value);
+    void reload();
+
+    const __FlashStringHelper * name_;
+    Config                      config_;
+    uint8_t                     generation_ = 0xFF; // of the settings, it's reloaded when they change
+    int32_t                     readings_[MAX_WINDOW];
+    uint8_t                     count_     = 0;
+    uint8_t                     next_      = 0;
+    int32_t                     last_      = 0; // the last registered value
+    bool                        valid_     = false;
+    uint32_t                    last_time_ = 0;
+
+    static std::vector<Setting> settings_;
+    static uint8_t              settings_generation_;
+};
+
+} // namespace emsesp
+
+#endif